@@ -21,7 +21,16 @@
 #include "anvil/byte-pipe/BytePipeWriter.hpp"
 #include "anvil/byte-pipe/BytePipeSTL.hpp"
 #include "anvil/byte-pipe/BytePipeRLE.hpp"
+#include "anvil/byte-pipe/BytePipeLZ.hpp"
+#include "anvil/byte-pipe/BytePipeHuffman.hpp"
 #include "anvil/byte-pipe/BytePipePacket.hpp"
 #include "anvil/byte-pipe/BytePipeBits.hpp"
+#include "anvil/byte-pipe/BytePipeBase64.hpp"
+#include "anvil/byte-pipe/BytePipeConvert.hpp"
+#include "anvil/byte-pipe/BytePipeUserPOD.hpp"
+#include "anvil/byte-pipe/BytePipeMemory.hpp"
+#include "anvil/byte-pipe/BytePipeSparse.hpp"
+#include "anvil/byte-pipe/BytePipeBitPack.hpp"
+#include "anvil/byte-pipe/BytePipeXOR.hpp"
 
 #endif
@@ -0,0 +1,145 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_BASE64_HPP
+#define ANVIL_LUTILS_BYTEPIPE_BASE64_HPP
+
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page Hexidecimal and Base64
+		\details
+		Binary data can be converted to text using either hexidecimal (two upper case characters per byte, high
+		nybble first) or base64 (RFC 4648 alphabet with '=' padding). The functions process 16 or 32 bytes at a
+		time using SSSE3 or AVX2 when they are enabled (see BytePipeCore.hpp) and fall back to scalar code for
+		other CPUs and for the last few bytes.
+	*/
+
+	/*!
+		\brief Convert binary data to hexidecimal characters.
+		\param src The data to convert.
+		\param bytes The number of bytes in src.
+		\param dst Where the characters are written, this must have space for bytes * 2 characters.
+		\return The number of characters written.
+	*/
+	size_t EncodeHex(const void* src, const size_t bytes, char* dst);
+
+	/*!
+		\brief Convert hexidecimal characters back into binary data.
+		\details Both upper and lower case characters are accepted.
+		An exception is thrown if the number of characters is odd or a character is not hexidecimal.
+		\param src The characters to convert.
+		\param chars The number of characters in src.
+		\param dst Where the data is written, this must have space for chars / 2 bytes.
+		\return The number of bytes written.
+	*/
+	size_t DecodeHex(const char* src, const size_t chars, void* dst);
+
+	/*!
+		\brief Return the number of characters that EncodeBase64 will output.
+	*/
+	static inline size_t GetBase64EncodedLength(const size_t bytes) {
+		return ((bytes + 2u) / 3u) * 4u;
+	}
+
+	/*!
+		\brief Return the maximum number of bytes that DecodeBase64 can output.
+		\details Fewer bytes will be output if the characters contain padding.
+	*/
+	static inline size_t GetBase64DecodedLength(const size_t chars) {
+		return (chars / 4u) * 3u;
+	}
+
+	/*!
+		\brief Convert binary data to base64 characters.
+		\details If the number of bytes is not divisible by 3 then the last group of characters is padded with '='.
+		\param src The data to convert.
+		\param bytes The number of bytes in src.
+		\param dst Where the characters are written, this must have space for GetBase64EncodedLength(bytes) characters.
+		\return The number of characters written.
+	*/
+	size_t EncodeBase64(const void* src, const size_t bytes, char* dst);
+
+	/*!
+		\brief Convert base64 characters back into binary data.
+		\details The number of characters must be divisible by 4. Padded groups are allowed anywhere in the input,
+		so the output of several EncodeBase64 calls can be joined together and decoded in one call.
+		An exception is thrown if the characters are not valid base64.
+		\param src The characters to convert.
+		\param chars The number of characters in src.
+		\param dst Where the data is written, this must have space for GetBase64DecodedLength(chars) bytes.
+		\return The number of bytes written.
+	*/
+	size_t DecodeBase64(const char* src, const size_t chars, void* dst);
+
+	/*!
+		\brief Encodes bytes as base64 text before writing them to a downstream pipe.
+		\details Bytes are encoded in groups of 3, bytes that do not fill a group are held until more data is
+		written. Flush() pads the last group with '=' so that all of the data reaches the downstream pipe,
+		Base64DecoderPipe accepts padding in the middle of a stream so flushing does not break decoding.
+		\see Base64DecoderPipe
+	*/
+	class Base64EncoderPipe final : public OutputPipe {
+	private:
+		enum : uint32_t {
+			BUFFER_SIZE = 4096u	//!< The number of characters that are buffered before they are written
+		};
+
+		OutputPipe& _downstream_pipe;
+		uint32_t _buffer_size;
+		uint32_t _remainder_size;
+		uint8_t _remainder[3u];
+		char _buffer[BUFFER_SIZE];
+
+		void FlushBuffer();
+		void _Flush();
+	public:
+		Base64EncoderPipe(OutputPipe& downstream_pipe);
+		virtual ~Base64EncoderPipe();
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+		void Flush() final;
+	};
+
+	/*!
+		\brief Decodes base64 text read from a downstream pipe.
+		\details Text is read in large blocks, when the caller requests enough bytes it is decoded directly into
+		their memory. An exception is thrown if the text is not valid base64.
+		\see Base64EncoderPipe
+	*/
+	class Base64DecoderPipe final : public InputPipe {
+	private:
+		enum : uint32_t {
+			ENCODED_BUFFER_SIZE = 4096u,							//!< The number of characters read from the downstream pipe at a time
+			DECODED_BUFFER_SIZE = (ENCODED_BUFFER_SIZE / 4u) * 3u	//!< The maximum number of bytes decoded from one block of characters
+		};
+
+		InputPipe& _downstream_pipe;
+		uint32_t _encoded_size;
+		uint32_t _decoded_size;
+		uint32_t _decoded_offset;
+		bool _end_of_stream;
+		char _encoded[ENCODED_BUFFER_SIZE];
+		uint8_t _decoded[DECODED_BUFFER_SIZE];
+	public:
+		Base64DecoderPipe(InputPipe& downstream_pipe);
+		virtual ~Base64DecoderPipe();
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+	};
+
+}}
+
+#endif
@@ -0,0 +1,86 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_BITPACK_HPP
+#define ANVIL_LUTILS_BYTEPIPE_BITPACK_HPP
+
+#include "anvil/byte-pipe/BytePipeObjects.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page Bit Packed Arrays
+		\details
+		A bit packed array stores integers in blocks of 128 values, each block only uses as many bits per value
+		as its largest value needs. Before packing, a block is either reduced to its distance from the smallest value
+		in the block (frame of reference) or to the difference between neighbouring values (delta), whichever is smaller.
+		Delta blocks make monotonic timestamps and counters very small.
+		Writer::SetBitPackedArrays enables the encoding, Reader unpacks the arrays before they are output so parsers
+		receive them through the normal array callbacks.
+
+		Each block is written as :
+		- 1 byte : The bits per value (0 to 64), the top bit is set for delta blocks.
+		- 1 value : The frame of reference. For delta blocks this is the value before the first value of the block.
+		- 1 value : The smallest difference between neighbouring values, only written for delta blocks.
+		- The packed values, as 4 or 8 byte words.
+
+		A full block of 128 values is split into lanes, with 4 lanes for 4 byte values and 2 lanes for 8 byte values.
+		Value i is in lane i % lanes and word w of a lane is stored at word (w * lanes) + lane, so 16 bytes of
+		packed words hold one word of every lane. This allows several values to be packed and unpacked at once with
+		SSE2 when it is enabled (see BytePipeCore.hpp). The last block of an array may contain fewer than 128 values,
+		these are packed one after another without lanes. Bits are packed from the least significant bit of each word.
+	*/
+
+	/*!
+		\brief Return the largest number of bytes that BitPackIntegers can write.
+		\param type The type of the values, this must be TYPE_U32, TYPE_S32, TYPE_U64 or TYPE_S64.
+		\param size The number of values.
+		\return The number of bytes.
+	*/
+	uint64_t GetMaxBitPackedBytes(const Type type, const uint32_t size);
+
+	/*!
+		\brief Bit pack an array of integers.
+		\param src The values.
+		\param type The type of the values, this must be TYPE_U32, TYPE_S32, TYPE_U64 or TYPE_S64.
+		\param size The number of values in src.
+		\param dst Where the packed array is written, this must have space for GetMaxBitPackedBytes bytes.
+		\return The number of bytes written to dst.
+	*/
+	uint64_t BitPackIntegers(const void* src, const Type type, const uint32_t size, void* dst);
+
+	/*!
+		\brief Unpack an array that was written by BitPackIntegers.
+		\details An exception is thrown if the packed array is not valid.
+		\param src The packed array.
+		\param bytes The size of the packed array in bytes.
+		\param type The type of the values, this must be the type that the array was packed with.
+		\param size The number of values in the array.
+		\param dst Where the values are written, this must not overlap src.
+	*/
+	void BitUnpackIntegers(const void* src, const uint32_t bytes, const Type type, const uint32_t size, void* dst);
+
+	/*!
+		\brief Swap the byte order of the values and words in a packed array.
+		\details An exception is thrown if the packed array is not valid.
+		\param data The packed array, it is modified in place.
+		\param bytes The size of the packed array in bytes.
+		\param type The type of the values.
+		\param size The number of values in the array.
+	*/
+	void SwapBitPackedByteOrder(void* data, const uint32_t bytes, const Type type, const uint32_t size);
+
+}}
+
+#endif
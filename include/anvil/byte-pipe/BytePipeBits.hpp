@@ -27,6 +27,13 @@ namespace anvil { namespace BytePipe {
 	public:
 		BitOutputStream(uint8_t* o);
 		void WriteBits(uint32_t bits, uint32_t bit_count);
+
+		/*!
+			\brief Write the bits that are left over from the last write.
+			\details The last byte is padded with zeros after the left over bits.
+			\return The address after the last byte that was written.
+		*/
+		uint8_t* Flush();
 	};
 
 	struct BitInputStream {
@@ -0,0 +1,130 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_CONVERT_HPP
+#define ANVIL_LUTILS_BYTEPIPE_CONVERT_HPP
+
+#include <vector>
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\brief Convert an array of numbers from one primative type to another.
+		\details The conversion rules are :
+		- Integers that do not fit in the destination type are saturated to its minimum or maximum value.
+		- Floating point values converted to integers are rounded to the nearest integer (ties to even) and
+		saturated, NaN becomes 0.
+		- Conversions to floating point round to the nearest representable value, 16-bit floating point
+		uses FloatToHalf and DoubleToHalf.
+		Common conversions (integers and floats to F32 / F64, F64 / F32 to S32 and narrowing S32 / S16) process
+		several values at once with AVX2 when it is enabled.
+		\param src The values to convert.
+		\param src_type The type of the values in src, this must be a numeric type.
+		\param dst Where the converted values are written, this must not overlap src.
+		\param dst_type The type to convert to, this must be a numeric type.
+		\param count The number of values to convert.
+	*/
+	void ConvertPrimativeArray(const void* src, const Type src_type, void* dst, const Type dst_type, const size_t count);
+
+	template<class SRC, class DST>
+	static inline void ConvertPrimativeArray(const SRC* src, DST* dst, const size_t count) {
+		ConvertPrimativeArray(src, GetTypeID<SRC>(), dst, GetTypeID<DST>(), count);
+	}
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Forwards values to another Parser, converting numeric primative arrays to a single type.
+		\details Each array is converted in one pass into a scratch buffer that is reused between arrays,
+		the downstream parser then receives one array call instead of one virtual call per element.
+		This allows a parser that only implements OnPrimativeArrayF64 (for example) to handle every kind of
+		numeric array efficiently. Tensors, sparse arrays and the numeric columns of columnar arrays are converted in the same way. Arrays of bool and char are forwarded without conversion.
+		Arrays that are not converted can be read directly into the downstream parser's memory (see Parser::AcquireArrayBuffer).
+		\see ConvertPrimativeArray
+	*/
+	class PrimativeArrayConverter final : public Parser {
+	private:
+		PrimativeArrayConverter(PrimativeArrayConverter&&) = delete;
+		PrimativeArrayConverter(const PrimativeArrayConverter&) = delete;
+		PrimativeArrayConverter& operator=(PrimativeArrayConverter&&) = delete;
+		PrimativeArrayConverter& operator=(const PrimativeArrayConverter&) = delete;
+
+		Parser& _downstream;
+		std::vector<uint64_t> _buffer;
+		std::vector<Type> _column_types;
+		std::vector<const void*> _columns;
+		const Type _type;
+
+		template<class T>
+		void ConvertArray(const T* src, const uint32_t size);
+	public:
+		/*!
+			\param downstream The parser that will recieve the values.
+			\param type The type that numeric arrays are converted to.
+		*/
+		PrimativeArrayConverter(Parser& downstream, const Type type);
+		virtual ~PrimativeArrayConverter();
+
+		// Inherited from Parser
+
+		void OnPipeOpen() final;
+		void OnPipeClose() final;
+		void OnArrayBegin(const uint32_t size) final;
+		void OnArrayEnd() final;
+		void OnObjectBegin(const uint32_t component_count) final;
+		void OnObjectEnd() final;
+		void OnComponentID(const ComponentID id) final;
+		void OnObjectShape(const uint32_t shape, const ComponentID* component_ids, const uint32_t component_count) final;
+		void OnShapedObjectBegin(const uint32_t shape, const uint32_t component_count) final;
+		void OnUserPOD(const uint32_t type, const uint32_t bytes, const void* data) final;
+		void OnUserPODArray(const uint32_t type, const uint32_t bytes, const void* src, const uint32_t size) final;
+		void OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src) final;
+		void OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count) final;
+		void OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns) final;
+		void OnNull() final;
+		void OnPrimativeF64(const double value) final;
+		void OnPrimativeString(const char* value, const uint32_t length) final;
+		void OnPrimativeBool(const bool value) final;
+		void OnPrimativeC8(const char value) final;
+		void OnPrimativeU64(const uint64_t value) final;
+		void OnPrimativeS64(const int64_t value) final;
+		void OnPrimativeF32(const float value) final;
+		void OnPrimativeU8(const uint8_t value) final;
+		void OnPrimativeU16(const uint16_t value) final;
+		void OnPrimativeU32(const uint32_t value) final;
+		void OnPrimativeS8(const int8_t value) final;
+		void OnPrimativeS16(const int16_t value) final;
+		void OnPrimativeS32(const int32_t value) final;
+		void OnPrimativeF16(const half value) final;
+
+		void* AcquireArrayBuffer(const Type type, const uint32_t count) final;
+		void OnPrimativeArrayU8(const uint8_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU16(const uint16_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU32(const uint32_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU64(const uint64_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS8(const int8_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS16(const int16_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS32(const int32_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS64(const int64_t* src, const uint32_t size) final;
+		void OnPrimativeArrayF16(const half* src, const uint32_t size) final;
+		void OnPrimativeArrayF32(const float* src, const uint32_t size) final;
+		void OnPrimativeArrayF64(const double* src, const uint32_t size) final;
+		void OnPrimativeArrayC8(const char* src, const uint32_t size) final;
+		void OnPrimativeArrayBool(const bool* src, const uint32_t size) final;
+	};
+
+}}
+
+#endif
@@ -28,6 +28,48 @@ namespace anvil { namespace BytePipe {
 #else
 	#define ANVIL_CONSTEXPR constexpr
 #endif
+
+	// Instruction sets that pipes are allowed to use, these are detected from the compiler settings but can be defined as 0 to disable them
+
+#ifndef ANVIL_BYTEPIPE_SSE2
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define ANVIL_BYTEPIPE_SSE2 1
+	#else
+		#define ANVIL_BYTEPIPE_SSE2 0
+	#endif
+#endif
+
+#ifndef ANVIL_BYTEPIPE_SSSE3
+	#if defined(__SSSE3__) || defined(__AVX__)
+		#define ANVIL_BYTEPIPE_SSSE3 1
+	#else
+		#define ANVIL_BYTEPIPE_SSSE3 0
+	#endif
+#endif
+
+#ifndef ANVIL_BYTEPIPE_SSE41
+	#if defined(__SSE4_1__) || defined(__AVX__)
+		#define ANVIL_BYTEPIPE_SSE41 1
+	#else
+		#define ANVIL_BYTEPIPE_SSE41 0
+	#endif
+#endif
+
+#ifndef ANVIL_BYTEPIPE_AVX2
+	#if defined(__AVX2__)
+		#define ANVIL_BYTEPIPE_AVX2 1
+	#else
+		#define ANVIL_BYTEPIPE_AVX2 0
+	#endif
+#endif
+
+#ifndef ANVIL_BYTEPIPE_F16C
+	#if defined(__F16C__) || defined(__AVX2__)
+		#define ANVIL_BYTEPIPE_F16C 1
+	#else
+		#define ANVIL_BYTEPIPE_F16C 0
+	#endif
+#endif
 }}
 
 #endif
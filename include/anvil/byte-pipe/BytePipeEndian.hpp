@@ -69,8 +69,8 @@ namespace anvil { namespace BytePipe {
 		const uint64_t e = (word >> 32ull) & 255ull;
 		const uint64_t f = (word >> 40ull) & 255ull;
 		const uint64_t g = (word >> 48ull) & 255ull;
-		const uint64_t h = word >> 54ull;
-		return (a << 54u) | (b << 48u) | (c << 40u) | (d << 32u) | (e << 24u) | (f << 16u) | (g << 8u) | h;
+		const uint64_t h = word >> 56ull;
+		return (a << 56u) | (b << 48u) | (c << 40u) | (d << 32u) | (e << 24u) | (f << 16u) | (g << 8u) | h;
 #endif
 	}
 
@@ -0,0 +1,129 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_HUFFMAN_HPP
+#define ANVIL_LUTILS_BYTEPIPE_HUFFMAN_HPP
+
+#include <vector>
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page Huffman Coding
+		\details
+		The Huffman encoder / decoder pipes give frequent bytes shorter codes than rare ones. The encoder collects
+		the data into blocks and builds a canonical Huffman code for each block from a histogram of its bytes.
+		Codes are limited to MAX_CODE_LENGTH bits. The pipes only look at single bytes, so they work best after
+		the RLE or LZ pipes, which remove repeated strings (for example data -> LZEncoderPipe -> HuffmanEncoderPipe -> file).
+
+		Each block starts with two 32-bit little endian words :
+		- The number of bytes stored in the block, the most significant bit is set if the block was not compressed.
+		- The number of bytes in the block after it has been decompressed.
+
+		A compressed block contains the code length of each byte value as 4 bits (256 values, 128 bytes) followed
+		by the code of each byte. Both are written with BitOutputStream, so bits are packed from the most
+		significant bit of each byte. Canonical codes are assigned in order of code length and then byte value,
+		so the lengths are enough to rebuild the codes.
+
+		The decoder uses a table that is indexed by the next MAX_CODE_LENGTH bits and contains up to 3 bytes that
+		are decoded by those bits, so short codes are decoded several at a time.
+	*/
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Huffman codes the bytes written to it and writes them to another pipe.
+		\details Blocks that do not get smaller are stored without compression.
+		\see HuffmanDecoderPipe
+	*/
+	class HuffmanEncoderPipe final : public OutputPipe {
+	private:
+		HuffmanEncoderPipe(HuffmanEncoderPipe&&) = delete;
+		HuffmanEncoderPipe(const HuffmanEncoderPipe&) = delete;
+		HuffmanEncoderPipe& operator=(HuffmanEncoderPipe&&) = delete;
+		HuffmanEncoderPipe& operator=(const HuffmanEncoderPipe&) = delete;
+
+		OutputPipe& _output;
+		std::vector<uint8_t> _block;
+		std::vector<uint8_t> _compressed;
+		uint32_t _block_size;
+		uint32_t _used_bytes;
+
+		bool _Flush();
+		uint32_t CompressBlock();
+	public:
+		enum : uint32_t {
+			DEFAULT_BLOCK_SIZE = 65536u,
+			MAX_BLOCK_SIZE = 4194304u,
+			MAX_CODE_LENGTH = 12u
+		};
+
+		/*!
+			\param output The pipe that the compressed blocks are written to.
+			\param block_size The number of bytes that share a code, between 1 and MAX_BLOCK_SIZE.
+			Each block stores 128 bytes of code lengths, so small blocks do not compress well.
+		*/
+		HuffmanEncoderPipe(OutputPipe& output, const uint32_t block_size = DEFAULT_BLOCK_SIZE);
+		virtual ~HuffmanEncoderPipe();
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+
+		/*!
+			\brief Compress the bytes that have been written so far as a block and flush the output pipe.
+		*/
+		void Flush() final;
+	};
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Decodes bytes that were written by HuffmanEncoderPipe.
+		\details A block is decoded when the previous one has been read. ReadBytesZeroCopy returns addresses
+		inside the decoded block when the bytes do not cross into the next block.
+		An exception is thrown if a block is not valid.
+		\see HuffmanEncoderPipe
+	*/
+	class HuffmanDecoderPipe final : public InputPipe {
+	private:
+		HuffmanDecoderPipe(HuffmanDecoderPipe&&) = delete;
+		HuffmanDecoderPipe(const HuffmanDecoderPipe&) = delete;
+		HuffmanDecoderPipe& operator=(HuffmanDecoderPipe&&) = delete;
+		HuffmanDecoderPipe& operator=(const HuffmanDecoderPipe&) = delete;
+
+		InputPipe& _input;
+		std::vector<uint8_t> _block;
+		std::vector<uint8_t> _compressed;
+		std::vector<uint16_t> _symbol_table;	//!< The byte and code length of the first code in each index
+		std::vector<uint32_t> _multi_symbol_table;	//!< Up to 3 bytes, their count and the total code length for each index
+		uint32_t _block_bytes;
+		uint32_t _read_bytes;
+
+		bool ReadNextBlock();
+		void DecompressBlock(const uint32_t compressed_bytes);
+	public:
+		/*!
+			\param input The pipe that the compressed blocks are read from.
+		*/
+		HuffmanDecoderPipe(InputPipe& input);
+		virtual ~HuffmanDecoderPipe();
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+		const void* ReadBytesZeroCopy(const uint32_t bytes) final;
+	};
+
+}}
+
+#endif
@@ -18,6 +18,7 @@
 #include <vector>
 #include <string>
 #include "anvil/byte-pipe/BytePipeReader.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
 
 namespace anvil { namespace BytePipe {
 
@@ -25,18 +26,69 @@ namespace anvil { namespace BytePipe {
 		\author Adam Smith
 		\date March 2021
 		\brief Converts a BytePipe serialisation into a JSON string
+		\details The JSON can either be stored in a string (see GetJSON) or streamed into an OutputPipe.
+		When streaming the memory usage is fixed by the size of the internal buffer. The string keeps its
+		capacity between pipes, so writing messages of a similar size does not allocate memory.
 	*/
 	class JsonWriter final : public Parser {
+	public:
+		/*!
+			\brief Controls how arrays of uint8_t are formatted.
+		*/
+		enum ByteArrayFormat : uint8_t {
+			BYTE_ARRAY_NUMBERS,	//!< A JSON array of numbers
+			BYTE_ARRAY_BASE64	//!< An object containing the member __ANVIL_BYTES and the bytes as a base64 string
+		};
 	private:
-		mutable std::string _out;
+		enum : uint32_t {
+			BUFFER_SIZE = 4096u,	//!< The number of characters that are buffered before they are written
+			MAX_NUMBER_LENGTH = 32u	//!< The maximum number of characters used to format a number
+		};
+
+		mutable std::pmr::string _out;
+		OutputPipe* const _pipe;
+		mutable uint32_t _buffer_size;
+		bool _separator_required;
+		ByteArrayFormat _byte_array_format;
+		mutable char _buffer[BUFFER_SIZE];
 	private:
-		void AddValue(const std::string& val);
-		void AddValueC(const char* val);
+		void FlushBuffer() const;
+		void Write(const char* src, size_t bytes);
+		char* Reserve(const uint32_t bytes);
+		void BeginValue();
+		void WriteHex(const void* src, size_t bytes);
+		void WriteBase64(const void* src, size_t bytes);
+
+		template<class T>
+		void WriteNumber(const T value);
+
+		template<class T>
+		void WriteNumberArray(const T* src, const uint32_t size);
 	public:
 		JsonWriter();
+
+		/*!
+			\brief Create a JsonWriter that stores the JSON in a string.
+			\param resource Where the string is allocated, this must outlive the JsonWriter.
+		*/
+		JsonWriter(std::pmr::memory_resource* resource);
+
+		/*!
+			\brief Create a JsonWriter that streams the JSON into a pipe.
+			\details GetJSON will always return an empty string.
+			\param pipe The pipe that will recieve the JSON text.
+		*/
+		JsonWriter(OutputPipe& pipe);
+
 		virtual ~JsonWriter();
 
-		const std::string& GetJSON() const;
+		const std::pmr::string& GetJSON() const;
+
+		/*!
+			\brief Set how arrays of uint8_t are formatted, the default is BYTE_ARRAY_NUMBERS.
+			\details Base64 is much smaller and faster for large binary data, JsonReader can read either format.
+		*/
+		void SetByteArrayFormat(const ByteArrayFormat format);
 
 		// Inherited from Parser
 
@@ -62,6 +114,43 @@ namespace anvil { namespace BytePipe {
 		void OnPrimativeS8(const int8_t value) final;
 		void OnPrimativeS16(const int16_t value) final;
 		void OnPrimativeS32(const int32_t value) final;
+
+		void OnPrimativeArrayU8(const uint8_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU16(const uint16_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU32(const uint32_t* src, const uint32_t size) final;
+		void OnPrimativeArrayU64(const uint64_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS8(const int8_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS16(const int16_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS32(const int32_t* src, const uint32_t size) final;
+		void OnPrimativeArrayS64(const int64_t* src, const uint32_t size) final;
+		void OnPrimativeArrayF32(const float* src, const uint32_t size) final;
+		void OnPrimativeArrayF64(const double* src, const uint32_t size) final;
+		void OnPrimativeArrayBool(const bool* src, const uint32_t size) final;
+	};
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Reads JSON text from an InputPipe and outputs it into a Parser
+		\details The JSON is parsed in two stages, first the structural characters are located with SIMD
+		instructions, then the values are parsed. Object keys must be component IDs and user PODs use the
+		same format as JsonWriter, as are byte arrays written with JsonWriter::BYTE_ARRAY_BASE64. Arrays that only contain numbers are output as a primative array of the
+		smallest type that can represent all of the values.
+		\see JsonWriter
+	*/
+	class JsonReader {
+	private:
+		JsonReader(JsonReader&&) = delete;
+		JsonReader(const JsonReader&) = delete;
+		JsonReader& operator=(JsonReader&&) = delete;
+		JsonReader& operator=(const JsonReader&) = delete;
+
+		InputPipe& _pipe;
+	public:
+		JsonReader(InputPipe& pipe);
+		~JsonReader();
+
+		void Read(Parser& dst);
 	};
 
 }}
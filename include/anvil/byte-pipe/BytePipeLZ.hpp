@@ -0,0 +1,136 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_LZ_HPP
+#define ANVIL_LUTILS_BYTEPIPE_LZ_HPP
+
+#include <vector>
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+#include "anvil/byte-pipe/BytePipeWriter.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page LZ (Lempel-Ziv compression)
+		\details
+		The LZ encoder / decoder pipes compress data that contains repeated strings of bytes, using a block format
+		that is similar to LZ4. The encoder collects the data into blocks, and each block is compressed on its own.
+		Each block starts with two 32-bit little endian words :
+		- The number of bytes stored in the block, the most significant bit is set if the block was not compressed.
+		- The number of bytes in the block after it has been decompressed.
+
+		A compressed block is a series of sequences, each sequence contains :
+		- A token byte, the high 4 bits are the number of literal bytes and the low 4 bits are the match length minus 4.
+		A value of 15 means that the length continues in the following bytes, each byte is added to the length
+		and a byte of 255 means that another byte follows.
+		- The literal bytes, which are copied to the output.
+		- A 16-bit little endian offset to the start of the match, counting back from the end of the output.
+		- The rest of the match length, if it was 15 or more.
+
+		The last sequence of a block only contains literals and ends at the last 5 bytes of the block, matches
+		never start in the last 12 bytes. The decoder keeps some spare memory after its buffers, so literals and
+		matches are copied 8 or 16 bytes at a time without checking for the end of the block after every byte.
+	*/
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Compresses the bytes written to it and writes them to another pipe.
+		\details Matches are found with a hash table of chains that link every position in the block with the
+		positions before it that start with the same 4 bytes. Matches can be up to 65535 bytes back, but never
+		cross into a previous block. Blocks that do not get smaller are stored without compression.
+		\see LZDecoderPipe
+	*/
+	class LZEncoderPipe final : public OutputPipe {
+	private:
+		LZEncoderPipe(LZEncoderPipe&&) = delete;
+		LZEncoderPipe(const LZEncoderPipe&) = delete;
+		LZEncoderPipe& operator=(LZEncoderPipe&&) = delete;
+		LZEncoderPipe& operator=(const LZEncoderPipe&) = delete;
+
+		OutputPipe& _output;
+		std::vector<uint8_t> _block;
+		std::vector<uint8_t> _compressed;
+		std::vector<uint32_t> _hash_table;	//!< The last position + 1 that had each hash, 0 if there is none
+		std::vector<uint16_t> _chain_table;	//!< The distance back to the previous position with the same hash
+		uint32_t _block_size;
+		uint32_t _used_bytes;
+		uint32_t _max_chain_length;
+
+		bool _Flush();
+		uint32_t CompressBlock();
+	public:
+		enum : uint32_t {
+			DEFAULT_BLOCK_SIZE = 65536u,
+			MAX_BLOCK_SIZE = 4194304u,
+			DEFAULT_CHAIN_LENGTH = 16u
+		};
+
+		/*!
+			\param output The pipe that the compressed blocks are written to.
+			\param block_size The number of bytes that are compressed at once, between 1 and MAX_BLOCK_SIZE.
+			Larger blocks compress better but use more memory in the encoder and decoder.
+			\param max_chain_length The number of earlier positions that are checked for each match, higher values
+			find longer matches but compress more slowly.
+		*/
+		LZEncoderPipe(OutputPipe& output, const uint32_t block_size = DEFAULT_BLOCK_SIZE, const uint32_t max_chain_length = DEFAULT_CHAIN_LENGTH);
+		virtual ~LZEncoderPipe();
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+
+		/*!
+			\brief Compress the bytes that have been written so far as a block and flush the output pipe.
+			\details Flushing often produces smaller blocks, which do not compress as well.
+		*/
+		void Flush() final;
+	};
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Decompresses bytes that were written by LZEncoderPipe.
+		\details A block is decompressed when the previous one has been read. ReadBytesZeroCopy returns addresses
+		inside the decompressed block when the bytes do not cross into the next block.
+		An exception is thrown if a block is not valid.
+		\see LZEncoderPipe
+	*/
+	class LZDecoderPipe final : public InputPipe {
+	private:
+		LZDecoderPipe(LZDecoderPipe&&) = delete;
+		LZDecoderPipe(const LZDecoderPipe&) = delete;
+		LZDecoderPipe& operator=(LZDecoderPipe&&) = delete;
+		LZDecoderPipe& operator=(const LZDecoderPipe&) = delete;
+
+		InputPipe& _input;
+		std::vector<uint8_t> _block;
+		std::vector<uint8_t> _compressed;
+		uint32_t _block_bytes;
+		uint32_t _read_bytes;
+
+		bool ReadNextBlock();
+		void DecompressBlock(const uint32_t compressed_bytes);
+	public:
+		/*!
+			\param input The pipe that the compressed blocks are read from.
+		*/
+		LZDecoderPipe(InputPipe& input);
+		virtual ~LZDecoderPipe();
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+		const void* ReadBytesZeroCopy(const uint32_t bytes) final;
+	};
+
+}}
+
+#endif
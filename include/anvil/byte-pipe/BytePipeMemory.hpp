@@ -0,0 +1,58 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_MEMORY_HPP
+#define ANVIL_LUTILS_BYTEPIPE_MEMORY_HPP
+
+#include "anvil/byte-pipe/BytePipeReader.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Reads bytes from a block of memory, such as a memory mapped file.
+		\details ReadBytesZeroCopy returns addresses inside the block, so values that are aligned in the pipe
+		(see Writer::OnPrimativeTensor) are aligned in memory when the block itself is 64 byte aligned.
+		The memory is not copied and must remain valid while the pipe is being read.
+	*/
+	class MemoryInputPipe final : public InputPipe {
+	private:
+		MemoryInputPipe(MemoryInputPipe&&) = delete;
+		MemoryInputPipe(const MemoryInputPipe&) = delete;
+		MemoryInputPipe& operator=(MemoryInputPipe&&) = delete;
+		MemoryInputPipe& operator=(const MemoryInputPipe&) = delete;
+
+		const uint8_t* _src;
+		size_t _bytes_remaining;
+	public:
+		/*!
+			\param src The address of the first byte.
+			\param bytes The number of bytes that can be read.
+		*/
+		MemoryInputPipe(const void* src, const size_t bytes);
+		virtual ~MemoryInputPipe();
+
+		/*!
+			\return The number of bytes that have not been read yet.
+		*/
+		size_t GetBytesRemaining() const;
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+		const void* ReadBytesZeroCopy(const uint32_t bytes) final;
+	};
+
+}}
+
+#endif
@@ -18,6 +18,8 @@
 #include "anvil/byte-pipe/BytePipeCore.hpp"
 #include <vector>
 #include <map>
+#include <string>
+#include <memory_resource>
 
 namespace anvil { namespace BytePipe {
 
@@ -43,8 +45,43 @@ namespace anvil { namespace BytePipe {
 
 	typedef uint16_t ComponentID;
 
+	/*!
+		\brief An IEEE 754 16-bit floating point value, stored as its raw bits.
+		\see HalfToFloat
+		\see FloatToHalf
+	*/
 	enum half : uint16_t {};
 
+	/*!
+		\brief Convert a 16-bit floating point value to 32-bit floating point.
+		\details The conversion is exact, NaNs are made quiet but keep their payload.
+	*/
+	float HalfToFloat(const half value);
+
+	/*!
+		\brief Convert a 32-bit floating point value to 16-bit floating point.
+		\details Values are rounded to the nearest half (ties to even), values that are too large become infinity.
+	*/
+	half FloatToHalf(const float value);
+
+	/*!
+		\brief Convert a 64-bit floating point value to 16-bit floating point.
+		\details The value is rounded once, so the result may differ from FloatToHalf(static_cast<float>(value)).
+	*/
+	half DoubleToHalf(const double value);
+
+	/*!
+		\brief Convert an array of 16-bit floating point values to 32-bit floating point.
+		\details Uses F16C instructions when they are enabled, the results are the same as HalfToFloat.
+	*/
+	void HalfToFloat(const half* src, float* dst, const size_t count);
+
+	/*!
+		\brief Convert an array of 32-bit floating point values to 16-bit floating point.
+		\details Uses F16C instructions when they are enabled, the results are the same as FloatToHalf.
+	*/
+	void FloatToHalf(const float* src, half* dst, const size_t count);
+
 
 	template<class T>
 	static ANVIL_CONSTEXPR Type GetTypeID();
@@ -128,12 +165,28 @@ namespace anvil { namespace BytePipe {
 		void Optimise();
 	};
 
+	/*!
+		\brief A DOM (document object model) style value.
+		\details Strings, arrays and objects are reference counted and shared between copies of a value.
+		Shared data is only copied when it is modified (copy-on-write), so copying a large document is O(1).
+		The memory for strings, arrays and objects is allocated from a std::pmr::memory_resource, which must
+		outlive all values that use it. Copies made by copy-on-write use the same resource as the original.
+	*/
 	class Value {
 	private:
-		typedef std::vector<Value> Array;
-		typedef std::map<ComponentID, Value> Object;
+		typedef std::pmr::string String;
+		typedef std::pmr::vector<Value> Array;
+		typedef std::pmr::map<ComponentID, Value> Object;
 		PrimativeValue _primative;
+
+		/*!
+			\brief Make sure that this value is the only owner of its string, array or object.
+			\details If the data is shared with another value then it will be copied.
+		*/
+		void MakeUnique();
 	public:
+		typedef Object::const_iterator ComponentIterator;	//!< Points to a std::pair of the component ID and value
+
 		Value();
 		Value(Value&&);
 		Value(const Value&);
@@ -146,6 +199,12 @@ namespace anvil { namespace BytePipe {
 
 		Type GetType() const;
 
+		/*!
+			\brief Check if the string, array or object owned by this value is shared with another value.
+			\details Primative values are never shared.
+		*/
+		bool IsShared() const;
+
 		/*!
 			\brief Set the value to be a null value.
 			\details Previous value will be lost.
@@ -247,14 +306,25 @@ namespace anvil { namespace BytePipe {
 			\brief Set the value to be a string.
 			\details Previous value will be lost.
 			\param value The value to copy, nullptr results in an empty string.
+			\param resource Where the string is allocated, nullptr uses std::pmr::get_default_resource().
+		*/
+		void SetString(const char* value = nullptr, std::pmr::memory_resource* resource = nullptr);
+
+		/*!
+			\brief Set the value to be a string.
+			\details Previous value will be lost.
+			\param value The characters to copy, this does not need to be zero terminated.
+			\param length The number of characters to copy.
+			\param resource Where the string is allocated, nullptr uses std::pmr::get_default_resource().
 		*/
-		void SetString(const char* value = nullptr);
+		void SetString(const char* value, const size_t length, std::pmr::memory_resource* resource = nullptr);
 
 		/*!
 			\brief Set the value to be an array.
 			\details Previous value will be lost.
+			\param resource Where the array is allocated, nullptr uses std::pmr::get_default_resource().
 		*/
-		void SetArray();
+		void SetArray(std::pmr::memory_resource* resource = nullptr);
 
 		/*!
 			\brief Append a value to the end of the array.
@@ -266,8 +336,9 @@ namespace anvil { namespace BytePipe {
 		/*!
 			\brief Set the value to be an object.
 			\details Previous value will be lost.
+			\param resource Where the object is allocated, nullptr uses std::pmr::get_default_resource().
 		*/
-		void SetObject();
+		void SetObject(std::pmr::memory_resource* resource = nullptr);
 
 		/*!
 			\brief Add a member value to an object.
@@ -293,14 +364,32 @@ namespace anvil { namespace BytePipe {
 		double GetF64() const;
 		const char* GetString();
 
+		/*!
+			\brief Get the characters of a string.
+			\details Unlike the non-const version other types are not converted, an exception is thrown instead.
+			\return The null terminated characters.
+		*/
+		const char* GetString() const;
+
 		/*!
 			\brief Get a child value of an array or object.
 			\details Throws an exception if the index is out of bounds or the component ID doesn't exist.
+			If the array or object is shared with another value then it will be copied first. Copies of this value 
+			made after the reference is returned will copy the array or object instead of sharing it, so that 
+			writes through the reference are not seen by them.
 			\param index The index in an array or the componend ID of an object.
 			\return The value at the location.
 		*/
 		Value& GetValue(const uint32_t index);
 
+		/*!
+			\brief Get a child value of an array or object.
+			\details Throws an exception if the index is out of bounds or the component ID doesn't exist.
+			\param index The index in an array or the componend ID of an object.
+			\return The value at the location.
+		*/
+		const Value& GetValue(const uint32_t index) const;
+
 		/*!
 			\brief Get component ID at a specific index.
 			\details Throws an exception if the index is out of bounds.
@@ -309,6 +398,24 @@ namespace anvil { namespace BytePipe {
 		*/
 		ComponentID GetComponentID(const uint32_t index) const;
 
+		/*!
+			\brief Get the first component of an object.
+			\details Components are visited in order of component ID. Iterating from GetComponentsBegin to 
+			GetComponentsEnd is O(n), where calling GetComponentID for each index is O(n^2).
+			Throws an exception if the value is not an object.
+			\return An iterator to the first component.
+			\see GetComponentsEnd
+		*/
+		ComponentIterator GetComponentsBegin() const;
+
+		/*!
+			\brief Get the end of the components of an object.
+			\details Throws an exception if the value is not an object.
+			\return An iterator to one past the last component.
+			\see GetComponentsBegin
+		*/
+		ComponentIterator GetComponentsEnd() const;
+
 		/*!
 			\brief Return the value as a primative
 			\detail Throws an exception if the type is not numerical.
@@ -316,11 +423,29 @@ namespace anvil { namespace BytePipe {
 		PrimativeValue GetPrimativeValue() const;
 
 		/*!
-			\brief Get the number of child values in an array or object.
-			\detail Zero will be returned if the value is not an array or object.
+			\brief Get the number of child values in an array or object, or the number of characters in a string.
+			\detail Zero will be returned if the value is not a string, array or object.
 		*/
 		size_t GetSize() const;
 
+		/*!
+			\brief Get the type of the values in an array.
+			\details If all values in the array have the same primative type the array can be serialised as a 
+			primative array. The result is cached with the array.
+			\return The type of the values, or TYPE_NULL if the value is not an array, the array is empty or the 
+			values have different types.
+		*/
+		Type GetArrayElementType() const;
+
+		/*!
+			\brief Get the number of bytes that the value will use when it is serialised by a Writer.
+			\details This does not include the pipe header. The size of arrays and objects is cached with the data 
+			and is updated incrementally as values are added, so this is usually O(1). Once a child has been returned 
+			by the non-const GetValue the size is recalculated on every call, because the child may have been modified.
+			\see EncodeValue
+		*/
+		size_t EncodedSize() const;
+
 		/*!
 			\brief Casts the value to the smallest type that can represent it without losing precision.
 		*/
@@ -15,7 +15,8 @@
 #ifndef ANVIL_LUTILS_BYTEPIPE_PACKET_HPP
 #define ANVIL_LUTILS_BYTEPIPE_PACKET_HPP
 
-#include <deque>
+#include <chrono>
+#include <vector>
 #include "anvil/byte-pipe/BytePipeReader.hpp"
 #include "anvil/byte-pipe/BytePipeWriter.hpp"
 
@@ -24,7 +25,8 @@ namespace anvil { namespace BytePipe {
 	/*!
 		\page Packet Pipes
 		\brief Packet pipes guarantee that downstream pipes will operate on a fixed data size 
-		\details This may be required for certain kinds of pipes
+		\details This may be required for certain kinds of pipes.
+		Packets can also be variable-size, in which case a packet that is flushed before it is full is not padded.
 	*/
 
 #pragma pack(push, 1)
@@ -64,32 +66,83 @@ namespace anvil { namespace BytePipe {
 	};
 
 
+	/*!
+		\brief Reads the payloads of packets written by PacketOutputPipe.
+		\details When a call to ReadBytes needs all of the used bytes in a packet they are read directly into the
+		caller's memory, otherwise the payload is read into a buffer that is reused for every packet.
+		ReadBytes returns fewer bytes than requested if the downstream pipe ends before the next packet.
+	*/
 	class PacketInputPipe : public InputPipe {
 	private:
-		std::deque<uint8_t> _buffer;
 		InputPipe& _downstream_pipe;
+		std::vector<uint8_t> _buffer;	//!< The payload of the current packet
+		uint32_t _buffer_begin;			//!< The first byte of the payload that has not been read
+		uint32_t _buffer_end;			//!< The number of used bytes in the payload
 
-		void ReadNextPacket();
+		bool ReadPacketHeader(uint32_t& used_bytes, uint32_t& unused_bytes);
+		void SkipUnusedBytes(const uint32_t bytes);
 	public:
 		PacketInputPipe(InputPipe& downstream_pipe);
 		virtual ~PacketInputPipe();
 		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
 	};
 
+	/*!
+		\brief Splits the bytes written to it into packets.
+		\details A packet is written when it is full or when the pipe is flushed. Packets are fixed-size by default,
+		the unused part of a packet that is flushed early is filled with the default word. Downstream pipes that
+		require fixed-size blocks (for example RawHamming74OutputPipe) depend on this.
+		Variable-size packets are truncated to the bytes that were written instead, which costs much less for small
+		messages that are flushed often. PacketInputPipe reads both kinds of packet.
+		Small writes are combined into one packet. A flush threshold and deadline can be set so that packets are
+		written automatically, which bounds latency without writing a packet for every message.
+	*/
 	class PacketOutputPipe : public OutputPipe {
 	private:
 		OutputPipe& _downstream_pipe;
 		uint8_t* _buffer;
 		size_t _max_packet_size;
 		size_t _current_packet_size;
+		size_t _flush_threshold;
+		std::chrono::steady_clock::duration _flush_deadline;
+		std::chrono::steady_clock::time_point _packet_start_time;	//!< When the first byte of the current packet was written
 		uint8_t _default_word;
+		bool _fixed_size;
 
 		void _Flush();
 	public:
-		PacketOutputPipe(OutputPipe& downstream_pipe, const size_t packet_size, const uint8_t default_word = 0u);
+		/*!
+			\param downstream_pipe The pipe that packets are written to.
+			\param packet_size The maximum size of a packet in bytes, including the header.
+			\param default_word The value used to fill the unused bytes of fixed-size packets.
+			\param fixed_size If false then packets are not padded to packet_size.
+		*/
+		PacketOutputPipe(OutputPipe& downstream_pipe, const size_t packet_size, const uint8_t default_word = 0u, const bool fixed_size = true);
 		virtual ~PacketOutputPipe();
 		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
 		void Flush() final;
+
+		/*!
+			\brief Write a packet once this many bytes have been written to it, instead of waiting until it is full.
+			\details Packets written because of the threshold do not flush the downstream pipe, the same as full packets.
+			\param bytes The number of bytes, 0 or a value larger than the payload of a packet uses the full packet (the default).
+		*/
+		void SetFlushThreshold(const size_t bytes);
+
+		/*!
+			\brief Flush the pipe once the oldest byte in the current packet has waited this long.
+			\details The deadline is checked when bytes are written and when Poll is called, a producer that may stop
+			writing should call Poll regularly (for example from its event loop).
+			\param deadline The longest time that a byte can wait, 0 disables the deadline (the default).
+		*/
+		void SetFlushDeadline(const std::chrono::steady_clock::duration deadline);
+
+		/*!
+			\brief Flush the pipe if the deadline of the current packet has passed.
+			\return True if the pipe was flushed.
+			\see SetFlushDeadline
+		*/
+		bool Poll();
 	};
 
 }}
@@ -16,6 +16,7 @@
 #define ANVIL_LUTILS_BYTEPIPE_RLE_HPP
 
 #include <iostream>
+#include <vector>
 #include "anvil/byte-pipe/BytePipeReader.hpp"
 #include "anvil/byte-pipe/BytePipeWriter.hpp"
 
@@ -32,8 +33,41 @@ namespace anvil { namespace BytePipe {
 		were N copies of it in total.
 		A 0 signals that there are N words in the block that do not have any special
 		encoding.
+		The encoder only starts a repeating block when a run is long enough to save space, shorter runs are
+		stored in the surrounding non-repeating block.
 	*/
 
+	/*!
+		\brief Count how many words at the start of an array are equal to a given word.
+		\details Words are compared 16 to 64 bytes at a time with SSE2 or AVX2 when they are enabled.
+		\param src The array to search.
+		\param word The word to compare against, this may point into src.
+		\param count The number of words in src.
+		\param word_bytes The size of a word in bytes, this must be 1, 2, 4 or 8.
+		\return The number of words before the first one that is different from word.
+	*/
+	uint32_t CountRepeatedWords(const void* src, const void* word, const uint32_t count, const uint32_t word_bytes);
+
+	/*!
+		\brief Find the first word in an array that is equal to the word after it.
+		\details Words are compared 16 to 64 bytes at a time with SSE2 or AVX2 when they are enabled.
+		\param src The array to search.
+		\param count The number of words in src.
+		\param word_bytes The size of a word in bytes, this must be 1, 2, 4 or 8.
+		\return The index of the word, or count if no words are repeated.
+	*/
+	uint32_t FindRepeatedWord(const void* src, const uint32_t count, const uint32_t word_bytes);
+
+	/*!
+		\brief Write the same word to every element of an array.
+		\details The word is broadcast to a SSE2 or AVX2 register and stored 16 or 32 bytes at a time when they are enabled.
+		\param dst The array to write.
+		\param word The word to write.
+		\param count The number of words in dst.
+		\param word_bytes The size of a word in bytes, this must be 1, 2, 4 or 8.
+	*/
+	void FillRepeatedWord(void* dst, const void* word, const uint32_t count, const uint32_t word_bytes);
+
 	template<class LengthWord = uint16_t, class DataWord = uint8_t>
 	class RLEEncoderPipe final : public OutputPipe {
 	private:
@@ -45,6 +79,11 @@ namespace anvil { namespace BytePipe {
 			MAX_RLE_LENGTH = static_cast<LengthWord>(-1) >> 1
 		};
 
+		enum : uint32_t {
+			// A run inside non-repeating data costs a block header and a word, plus the header of the block that resumes after it
+			MIN_RUN_LENGTH = (sizeof(LengthWord) * 2u + sizeof(DataWord)) / sizeof(DataWord) + 1u
+		};
+
 		OutputPipe& _output;
 		DataWord* _buffer;
 		DataWord _current_word;
@@ -79,168 +118,36 @@ namespace anvil { namespace BytePipe {
 			return false;
 		}
 
-		void WriteWordRLE(const DataWord word) {
-			// If the current RLE block is full then flush the data
-			if (_length == MAX_RLE_LENGTH) {
-NEW_BLOCK:
-				_Flush();
-				// Flush the current block and write as aif it was a non-repeating block
-				WriteWordNonRLE(word);
-				return;
-			}
-			
-			if (_length == 0u) {
-				// Start a new repeating block
-				_current_word = word;
-				_length = 1u;
-				_rle_mode = true;
-			} else if (word == _current_word) {
-				// Add the word to the repeat
-				++_length;
-			} else {
-				goto NEW_BLOCK;
+		void AppendLiterals(const DataWord* src, uint32_t words) {
+			while (words > 0u) {
+				if (_length == MAX_RLE_LENGTH) _Flush();
+				const uint32_t space = static_cast<uint32_t>(MAX_RLE_LENGTH - _length);
+				const uint32_t count = words < space ? words : space;
+				memcpy(_buffer + _length, src, sizeof(DataWord) * count);
+				_length += static_cast<LengthWord>(count);
+				src += count;
+				words -= count;
 			}
 		}
 
-		void WriteWordNonRLE(const DataWord word) {
-			// If the current RLE block is full then flush the data
-			if (_length == MAX_RLE_LENGTH) _Flush();
-
-			if (_length > 0u) {
-				// If the word is the same as the last word in the buffer
-				if (_buffer[_length - 1u] == word) {
-					// Flush the current block except for the last word
-					--_length;
-					_Flush();
-
-					// Start a new RLE block
-					_current_word = word;
-					_length = 2u;
-					_rle_mode = true;
-					return;
-				}
-			}
-
-			// Add word to buffer
-			_buffer[_length++] = word;
+		void StartRun(const DataWord word, const LengthWord length) {
+			_Flush();
+			_current_word = word;
+			_length = length;
+			_rle_mode = true;
 		}
 
-		void WriteWord(const DataWord word) {
-			// If the current block is repeating
-			if (_rle_mode) {
-				WriteWordRLE(word);
-			} else {
-				WriteWordNonRLE(word);
-			}
-		}
-
-		void WriteWord4(const uint32_t word) {
-			if ANVIL_CONSTEXPR (std::is_same<DataWord, uint8_t>::value) {
-
-				const uint32_t w1 = word & 255u;
-				const uint32_t w2 = (word >> 8u) & 255u;
-				const uint32_t w3 = (word >> 16u) & 255u;
-				const uint32_t w4 = word >> 24u;
-
-
-				// If all words are the same
-				if (((w1 ^ w2) | (w1 ^ w3) | (w1 ^ w4)) == 0u) {
-					// If the currently block isn't repeating or is repeating a different word then flush it
-					if (_length > 0u) {
-						if (_rle_mode) {
-							if (w1 != _current_word) {
-							FLUSH:
-								// Flush the current block
-								_Flush();
-							}
-						} else {
-							goto FLUSH;
-						}
-					}
-
-					_rle_mode = true;
-					_current_word = static_cast<DataWord>(w1);
-					if (_length < MAX_RLE_LENGTH - 4u) {
-						// Add all 4 words to the block at once
-						_length += 4u;
-					} else {
-						// Add the words individually
-						WriteWordRLE(static_cast<DataWord>(w1));
-						WriteWordRLE(static_cast<DataWord>(w2));
-						WriteWordRLE(static_cast<DataWord>(w3));
-						WriteWordRLE(static_cast<DataWord>(w4));
-					}
-					return;
-				}
-
-				// Add the words individually
-				WriteWord(static_cast<DataWord>(w1));
-				WriteWord(static_cast<DataWord>(w2));
-				WriteWord(static_cast<DataWord>(w3));
-				WriteWord(static_cast<DataWord>(w4));
-			} else {
-				throw std::runtime_error("RLEEncoderPipe::WriteWord4 : Only implemented for 1 byte words");
-			}
-		}
-
-		void WriteWord8(const uint64_t word) {
-			if ANVIL_CONSTEXPR (std::is_same<DataWord, uint8_t>::value) {
-
-				const uint64_t w1 = word & 255ull;
-				const uint64_t w2 = (word >> 8ull) & 255ull;
-				const uint64_t w3 = (word >> 16ull) & 255ull;
-				const uint64_t w4 = (word >> 24ull) & 255ull;
-				const uint64_t w5 = (word >> 32ull) & 255ull;
-				const uint64_t w6 = (word >> 40ull) & 255ull;
-				const uint64_t w7 = (word >> 48ull) & 255ull;
-				const uint64_t w8 = word >> 56ull;
-
-				// If all words are the same
-				if (((w1 ^ w2) | (w1 ^ w3) | (w1 ^ w4) | (w1 ^ w5) | (w1 ^ w6) | (w1 ^ w7) | (w1 ^ w8)) == 0u) {
-					// If the currently block isn't repeating or is repeating a different word then flush it
-					if (_length > 0u) {
-						if (_rle_mode) {
-							if (w1 != _current_word) {
-							FLUSH:
-								// Flush the current block
-								_Flush();
-							}
-						} else {
-							goto FLUSH;
-						}
-					}
-
-					_rle_mode = true;
-					_current_word = static_cast<DataWord>(w1);
-					if (_length < MAX_RLE_LENGTH - 8u) {
-						// Add all 4 words to the block at once
-						_length += 8u;
-					} else {
-						// Add the words individually
-						WriteWordRLE(static_cast<DataWord>(w1));
-						WriteWordRLE(static_cast<DataWord>(w2));
-						WriteWordRLE(static_cast<DataWord>(w3));
-						WriteWordRLE(static_cast<DataWord>(w4));
-						WriteWordRLE(static_cast<DataWord>(w5));
-						WriteWordRLE(static_cast<DataWord>(w6));
-						WriteWordRLE(static_cast<DataWord>(w7));
-						WriteWordRLE(static_cast<DataWord>(w8));
-					}
-					return;
-				}
-
-				// Add the words individually
-				WriteWord(static_cast<DataWord>(w1));
-				WriteWord(static_cast<DataWord>(w2));
-				WriteWord(static_cast<DataWord>(w3));
-				WriteWord(static_cast<DataWord>(w4));
-				WriteWord(static_cast<DataWord>(w5));
-				WriteWord(static_cast<DataWord>(w6));
-				WriteWord(static_cast<DataWord>(w7));
-				WriteWord(static_cast<DataWord>(w8));
-			} else {
-				throw std::runtime_error("RLEEncoderPipe::WriteWord8 : Only implemented for 1 byte words");
+		// Returns the number of words at the start of src that should be written as literals, stopping at the first run of MIN_RUN_LENGTH or more words
+		static uint32_t CountLiterals(const DataWord* src, const uint32_t words) {
+			uint32_t i = 0u;
+			while (i < words) {
+				const uint32_t run_begin = i + FindRepeatedWord(src + i, words - i, sizeof(DataWord));
+				if (run_begin >= words) return words;
+				const uint32_t run_end = run_begin + CountRepeatedWords(src + run_begin, src + run_begin, words - run_begin, sizeof(DataWord));
+				if (run_end - run_begin >= MIN_RUN_LENGTH) return run_begin;
+				i = run_end;
 			}
+			return words;
 		}
 	public:
 		RLEEncoderPipe(OutputPipe& output) :
@@ -264,26 +171,42 @@ NEW_BLOCK:
 
 			const DataWord* wordPtr = static_cast<const DataWord*>(src);
 
+			while (words > 0u) {
+				if (_rle_mode) {
+					// Extend the current run
+					const uint32_t space = static_cast<uint32_t>(MAX_RLE_LENGTH - _length);
+					const uint32_t count = CountRepeatedWords(wordPtr, &_current_word, words < space ? words : space, sizeof(DataWord));
+					_length += static_cast<LengthWord>(count);
+					wordPtr += count;
+					words -= count;
+
+					// The run has ended or the block is full
+					if (words > 0u) _Flush();
+					continue;
+				}
 
-			// Optimise memory reads for 1 byte data
-			if ANVIL_CONSTEXPR (std::is_same<DataWord, uint8_t>::value) {
-				if ANVIL_CONSTEXPR (sizeof(intptr_t) >= 8u) {
-					while (words >= 8u) {
-						WriteWord8(*reinterpret_cast<const uint64_t*>(wordPtr));
-						wordPtr += 8u;
-						words -= 8u;
-					}
-				} else {
-					while (words >= 4u) {
-						WriteWord4(*reinterpret_cast<const uint32_t*>(wordPtr));
-						wordPtr += 4u;
-						words -= 4u;
+				// Check if a run that started at the end of the previous write continues into this one
+				if (_length > 0u) {
+					const DataWord last = _buffer[_length - 1u];
+					if (wordPtr[0u] == last) {
+						LengthWord tail = 1u;
+						while (tail < _length && _buffer[_length - 1u - tail] == last) ++tail;
+						const uint32_t count = CountRepeatedWords(wordPtr, &last, words < MIN_RUN_LENGTH ? words : MIN_RUN_LENGTH, sizeof(DataWord));
+						if (tail + count >= MIN_RUN_LENGTH) {
+							_length -= tail;
+							StartRun(last, tail);
+							continue;
+						}
 					}
 				}
-			}
 
-			for (uint32_t i = 0; i < words; ++i) {
-				WriteWord(wordPtr[i]);
+				// Copy everything before the next run into the literal block
+				const uint32_t literals = CountLiterals(wordPtr, words);
+				AppendLiterals(wordPtr, literals);
+				wordPtr += literals;
+				words -= literals;
+
+				if (words > 0u) StartRun(wordPtr[0u], 0u);
 			}
 
 			return bytes;
@@ -307,42 +230,99 @@ NEW_BLOCK:
 			MAX_RLE_LENGTH = static_cast<LengthWord>(-1) >> 1
 		};
 
+		enum : uint32_t {
+			INPUT_BUFFER_SIZE = 65536u,
+			MIN_FILL_LENGTH = 16u	// Runs shorter than this are filled one word at a time
+		};
+
 		InputPipe& _input;
-		DataWord* _buffer;
-		LengthWord _length;
+		uint8_t* _buffer;			//!< Encoded bytes that have been read from the input but not decoded yet
+		uint32_t _buffer_begin;
+		uint32_t _buffer_end;
+		LengthWord _length;			//!< The number of words remaining in the current block
 		DataWord _repeat_word;
 		bool _rle_mode;
 
-		void ReadNextBlock() {
+		// Makes sure that at least the given number of bytes are in the buffer, returns false if the input ends first
+		bool BufferBytes(const uint32_t bytes) {
+			if (_buffer_end - _buffer_begin >= bytes) return true;
+
+			// Move the bytes that have not been decoded yet to the start of the buffer
+			_buffer_end -= _buffer_begin;
+			memmove(_buffer, _buffer + _buffer_begin, _buffer_end);
+			_buffer_begin = 0u;
+
+			while (_buffer_end < bytes) {
+				const uint32_t bytes_read = _input.ReadBytes(_buffer + _buffer_end, INPUT_BUFFER_SIZE - _buffer_end);
+				if (bytes_read == 0u) return false;
+				_buffer_end += bytes_read;
+			}
+			return true;
+		}
+
+		bool ReadNextBlock() {
 			// Read the length of the block
-			LengthWord len = 0u;
-			uint32_t bytes_read = _input.ReadBytes(&len, sizeof(LengthWord));
-			if (bytes_read != sizeof(LengthWord)) throw std::runtime_error("RLEDecoderPipe::ReadNextBlock : Failed to read block length");
+			if (! BufferBytes(sizeof(LengthWord))) {
+				if (_buffer_begin == _buffer_end) return false;
+				throw std::runtime_error("RLEDecoderPipe::ReadNextBlock : Failed to read block length");
+			}
+			LengthWord len;
+			memcpy(&len, _buffer + _buffer_begin, sizeof(LengthWord));
 
 			// If the block is repeated word
 			if (len & RLE_FLAG) {
-				len &= ~RLE_FLAG;
-				_length = len;
-
+				if (! BufferBytes(sizeof(LengthWord) + sizeof(DataWord))) throw std::runtime_error("RLEDecoderPipe::ReadNextBlock : Failed to read repeated word");
+				memcpy(&_repeat_word, _buffer + _buffer_begin + sizeof(LengthWord), sizeof(DataWord));
+				_buffer_begin += sizeof(LengthWord) + sizeof(DataWord);
+				_length = len & ~RLE_FLAG;
 				_rle_mode = true;
-				_repeat_word = 0u;
-				
-				// Read the word
-				bytes_read = _input.ReadBytes(&_repeat_word, sizeof(DataWord));
-				if (bytes_read != sizeof(DataWord)) throw std::runtime_error("RLEDecoderPipe::ReadNextBlock : Failed to repeated word");
 			} else {
+				// The words are read from the buffer as they are needed
+				_buffer_begin += sizeof(LengthWord);
 				_length = len;
 				_rle_mode = false;
-				bytes_read = _input.ReadBytes(_buffer, _length * sizeof(DataWord));
-				if (bytes_read != _length * sizeof(DataWord)) throw std::runtime_error("RLEDecoderPipe::ReadNextBlock : Failed to non-repeating words");
 			}
+			return true;
+		}
+
+		// Returns the number of words copied, which may be less than count if the rest of the block has not been read from the input yet
+		uint32_t ReadLiterals(DataWord* dst, uint32_t count) {
+			uint32_t available = (_buffer_end - _buffer_begin) / sizeof(DataWord);
+			if (available == 0u) {
+				// Large blocks are read directly into the destination
+				if (_buffer_begin == _buffer_end && count * sizeof(DataWord) >= INPUT_BUFFER_SIZE) {
+					uint8_t* dst8 = reinterpret_cast<uint8_t*>(dst);
+					uint32_t bytes = count * sizeof(DataWord);
+					while (bytes > 0u) {
+						const uint32_t bytes_read = _input.ReadBytes(dst8, bytes);
+						if (bytes_read == 0u) throw std::runtime_error("RLEDecoderPipe::ReadLiterals : Failed to read non-repeating words");
+						dst8 += bytes_read;
+						bytes -= bytes_read;
+					}
+					return count;
+				}
+
+				if (! BufferBytes(sizeof(DataWord))) throw std::runtime_error("RLEDecoderPipe::ReadLiterals : Failed to read non-repeating words");
+				available = (_buffer_end - _buffer_begin) / sizeof(DataWord);
+			}
+
+			if (count > available) count = available;
+			memcpy(dst, _buffer + _buffer_begin, count * sizeof(DataWord));
+			_buffer_begin += count * sizeof(DataWord);
+			return count;
 		}
 	public:
+		/*!
+			\param input The pipe that the encoded data is read from.
+			Encoded data is read ahead in large chunks, so the input should end (return fewer bytes than requested) when the encoded data ends.
+		*/
 		RLEDecoderPipe(InputPipe& input) :
 			_input(input),
-			_buffer(new DataWord[MAX_RLE_LENGTH]),
-			_repeat_word(0u),
+			_buffer(new uint8_t[INPUT_BUFFER_SIZE]),
+			_buffer_begin(0u),
+			_buffer_end(0u),
 			_length(0u),
+			_repeat_word(0u),
 			_rle_mode(false)
 		{}
 
@@ -353,31 +333,128 @@ NEW_BLOCK:
 
 
 		uint32_t ReadBytes(void* dst, const uint32_t bytes) final{
-			uint32_t words = bytes / sizeof(DataWord);
+			const uint32_t words = bytes / sizeof(DataWord);
 			if (words * sizeof(DataWord) != bytes) throw std::runtime_error("RLEDecoderPipe::ReadBytes : Byte count is not divisible by the word size");
 
 			DataWord* wordPtr = static_cast<DataWord*>(dst);
-			uint32_t wordsToRead = 0u;
+			uint32_t words_remaining = words;
 
-			while (words != 0u) {
-				if (_length == 0u) ReadNextBlock();
-				wordsToRead = words < _length ? words : _length;
+			// Decode as many blocks as are needed to fill dst
+			while (words_remaining != 0u) {
+				if (_length == 0u) {
+					if (! ReadNextBlock()) break;
+					continue;
+				}
 
+				uint32_t count = words_remaining < _length ? words_remaining : _length;
 				if (_rle_mode) {
-					for (uint32_t i = 0u; i < wordsToRead; ++i) wordPtr[i] = _repeat_word;
+					if (count < MIN_FILL_LENGTH) {
+						for (uint32_t i = 0u; i < count; ++i) wordPtr[i] = _repeat_word;
+					} else {
+						FillRepeatedWord(wordPtr, &_repeat_word, count, sizeof(DataWord));
+					}
 				} else {
-					memcpy(wordPtr, _buffer, sizeof(DataWord) * wordsToRead);
+					count = ReadLiterals(wordPtr, count);
 				}
 
-				_length -= wordsToRead;
-				words -= wordsToRead;
-				wordPtr += wordsToRead;
+				_length -= static_cast<LengthWord>(count);
+				words_remaining -= count;
+				wordPtr += count;
 			}
 
-			return bytes;
+			return (words - words_remaining) * sizeof(DataWord);
 		}
 	};
 
+	/*!
+		\page ZeroRLE (Zero run-length encoding)
+		\details
+		The zero RLE encoder / decoder pipes are a simpler form of RLE for data that is mostly zero bytes, for example
+		sparse tensors or padded packets. The encoded data is a series of pairs, each pair contains :
+		- The number of literal bytes, as a varint.
+		- The literal bytes, which are copied to the output.
+		- The number of zero bytes that follow the literals, as a varint.
+
+		Varints are little endian groups of 7 bits, the most significant bit of each byte is set if another byte follows.
+		Zero runs shorter than 3 bytes are stored as literals, so literals are not always non-zero.
+	*/
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Encodes the bytes written to it as literals and zero runs and writes them to another pipe.
+		\details Zero bytes are found 16 to 64 bytes at a time with SSE2 or AVX2, and the bytes between them are
+		copied into the literal buffer in bulk. Zero runs can continue across calls to WriteBytes.
+		\see ZeroRLEDecoderPipe
+	*/
+	class ZeroRLEEncoderPipe final : public OutputPipe {
+	private:
+		ZeroRLEEncoderPipe(ZeroRLEEncoderPipe&&) = delete;
+		ZeroRLEEncoderPipe(const ZeroRLEEncoderPipe&) = delete;
+		ZeroRLEEncoderPipe& operator=(ZeroRLEEncoderPipe&&) = delete;
+		ZeroRLEEncoderPipe& operator=(const ZeroRLEEncoderPipe&) = delete;
+
+		OutputPipe& _output;
+		std::vector<uint8_t> _buffer;	//!< Space for the literal count, the literals and then the zero count
+		uint32_t _literal_bytes;
+		uint64_t _zero_bytes;			//!< The length of the zero run after the literals
+
+		bool _Flush();
+		void WritePair();
+		void AppendLiterals(const uint8_t* src, uint32_t bytes);
+	public:
+		enum : uint32_t {
+			MAX_LITERAL_BYTES = 65536u,		//!< A pair is written when this many literals are buffered
+			MIN_ZERO_RUN = 3u				//!< Shorter zero runs cost less to store as literals
+		};
+
+		/*!
+			\param output The pipe that the encoded data is written to.
+		*/
+		ZeroRLEEncoderPipe(OutputPipe& output);
+		virtual ~ZeroRLEEncoderPipe();
+
+		uint32_t WriteBytes(const void* src, const uint32_t bytes) final;
+		void Flush() final;
+	};
+
+	/*!
+		\author Adam Smith
+		\date October 2026
+		\brief Decodes bytes that were written by ZeroRLEEncoderPipe.
+		\details Encoded data is read ahead in large chunks, so the input should end (return fewer bytes than requested)
+		when the encoded data ends. Zero runs are written with memset and literals are copied in bulk.
+		An exception is thrown if the input ends inside a pair.
+		\see ZeroRLEEncoderPipe
+	*/
+	class ZeroRLEDecoderPipe final : public InputPipe {
+	private:
+		ZeroRLEDecoderPipe(ZeroRLEDecoderPipe&&) = delete;
+		ZeroRLEDecoderPipe(const ZeroRLEDecoderPipe&) = delete;
+		ZeroRLEDecoderPipe& operator=(ZeroRLEDecoderPipe&&) = delete;
+		ZeroRLEDecoderPipe& operator=(const ZeroRLEDecoderPipe&) = delete;
+
+		InputPipe& _input;
+		std::vector<uint8_t> _buffer;	//!< Encoded bytes that have been read from the input but not decoded yet
+		uint32_t _buffer_begin;
+		uint32_t _buffer_end;
+		uint64_t _literal_bytes;		//!< The number of literals remaining in the current pair
+		uint64_t _zero_bytes;			//!< The number of zeros remaining in the current pair
+		bool _zero_count_pending;		//!< True if the zero count of the current pair has not been read yet
+
+		bool BufferBytes(const uint32_t bytes);
+		bool ReadVarint(uint64_t& value);
+		uint32_t ReadLiterals(uint8_t* dst, uint32_t bytes);
+	public:
+		/*!
+			\param input The pipe that the encoded data is read from.
+		*/
+		ZeroRLEDecoderPipe(InputPipe& input);
+		virtual ~ZeroRLEDecoderPipe();
+
+		uint32_t ReadBytes(void* dst, const uint32_t bytes) final;
+	};
+
 }}
 
 #endif
@@ -15,6 +15,7 @@
 #ifndef ANVIL_BYTEPIPE_READER_HPP
 #define ANVIL_BYTEPIPE_READER_HPP
 
+#include <cstddef>
 #include "anvil/byte-pipe/BytePipeCore.hpp"
 #include "anvil/byte-pipe/BytePipeEndian.hpp"
 #include "anvil/byte-pipe/BytePipeObjects.hpp"
@@ -31,6 +32,17 @@ namespace anvil { namespace BytePipe {
 	public:
 		virtual ~InputPipe() {}
 		virtual uint32_t ReadBytes(void* dst, const uint32_t bytes) = 0;
+
+		/*!
+			\brief Read bytes without copying them.
+			\details Pipes that already hold the data in memory (for example a memory mapped file) can return the
+			address of the data instead of copying it. The memory must remain valid until the next call to the pipe.
+			\param bytes The number of bytes to read.
+			\return The address of the bytes, or nullptr if the pipe cannot do this, in which case nothing is read.
+		*/
+		virtual const void* ReadBytesZeroCopy(const uint32_t /*bytes*/) {
+			return nullptr;
+		}
 	};
 
 
@@ -40,6 +52,9 @@ namespace anvil { namespace BytePipe {
 		\brief Interface for serialising or deserialising data.
 	*/
 	class Parser {
+	private:
+		std::vector<float> _f16_buffer;	//!< Reused by OnPrimativeArrayF16 so that arrays can be converted without allocating
+		std::vector<uint64_t> _sparse_buffer;	//!< Reused by OnPrimativeSparseArray when AcquireArrayBuffer does not provide memory
 	public:
 		Parser() {
 
@@ -222,16 +237,65 @@ namespace anvil { namespace BytePipe {
 			\param value The value
 		*/
 		virtual void OnPrimativeF16(const half value) { 
-			OnPrimativeF32(static_cast<float>(value));  //! \bug half to float conversion not implemented
+			OnPrimativeF32(HalfToFloat(value));
 		}
 
 		// Object Support
 
-		void OnValue(const Value& value);
+		/*!
+			\brief Handle a DOM style value.
+			\details The default implementation walks the value and calls the other callbacks for each node.
+			\param value The value
+		*/
+		virtual void OnValue(const Value& value);
 		void OnValue(const PrimativeValue& value);
 
+		// Object Shapes
+
+		/*!
+			\brief Define the component IDs of objects that share the same layout.
+			\details This is called once per shape, before the first object that uses it. A parser that decodes
+			fixed structures can use it to prepare how each component is handled, instead of looking up every
+			component ID. Defining a shape again replaces the previous definition. The default implementation
+			does nothing.
+			\param shape The shape ID (up to 65535).
+			\param component_ids The component IDs in the order that the values are parsed.
+			\param component_count The number of components in the shape.
+			\see OnShapedObjectBegin
+		*/
+		virtual void OnObjectShape(const uint32_t /*shape*/, const ComponentID* /*component_ids*/, const uint32_t /*component_count*/) {
+
+		}
+
+		/*!
+			\brief Signal that the next values are part of an object with the layout of a shape.
+			\details This replaces OnObjectBegin, OnObjectEnd must still be called after the values. OnComponentID
+			is called before each value with the IDs from the shape in order. The default implementation calls
+			OnObjectBegin.
+			\param shape The shape ID, this must have been defined with OnObjectShape.
+			\param component_count The number of components in the shape.
+			\see OnObjectShape
+		*/
+		virtual void OnShapedObjectBegin(const uint32_t /*shape*/, const uint32_t component_count) {
+			OnObjectBegin(component_count);
+		}
+
 		// Array Optimisations
 
+		/*!
+			\brief Provide the memory that the next array of primative values will be read into.
+			\details This is called immediately before the matching OnPrimativeArray or OnPrimativeTensor function. If memory is returned
+			then the values are read directly into it (with the byte order already corrected) and src will point
+			to it, which avoids copying the values out of the reader's own buffer. The memory must have space for
+			count values of the requested type and remain valid until the OnPrimativeArray call returns.
+			\param type The type of the values in the array.
+			\param count The number of values in the array.
+			\return The memory to read into, or nullptr if the reader should use its own buffer.
+		*/
+		virtual void* AcquireArrayBuffer(const Type /*type*/, const uint32_t /*count*/) {
+			return nullptr;
+		}
+
 		/*!
 			\brief Handle an array of primative values (8-bit unsigned integers)
 			\details This is the same as the following code, but is a special case that could be optimised :
@@ -421,38 +485,123 @@ namespace anvil { namespace BytePipe {
 
 		/*!
 			\brief Handle an array of primative values (16-bit floating point)
+			\details The default implementation converts the values to 32-bit floating point with HalfToFloat
+			and calls OnPrimativeArrayF32 once. The converted values are stored in a buffer that is reused by 
+			later arrays, so memory is only allocated when an array is larger than any before it.
+			\param src The address of the first value
+			\param size The number of values in the array
+		*/
+		virtual void OnPrimativeArrayF16(const half* src, const uint32_t size);
+
+		/*!
+			\brief Handle an array of primative values (bool)
 			\details This is the same as the following code, but is a special case that could be optimised :
 			\code{.cpp}
 			OnArrayBegin(size);
-			for (uint32_t i = 0u; i < size; ++i) OnPrimativeF16(src[i]);
+			for (uint32_t i = 0u; i < size; ++i) OnPrimativeBool(src[i]);
 			OnArrayEnd();
 			\endcode
 			\param src The address of the first value
 			\param size The number of values in the array
 		*/
-		virtual void OnPrimativeArrayF16(const half* src, const uint32_t size) {
+		virtual void OnPrimativeArrayBool(const bool* src, const uint32_t size) {
 			OnArrayBegin(size);
-			for (uint32_t i = 0u; i < size; ++i) OnPrimativeF16(src[i]);
+			for (uint32_t i = 0u; i < size; ++i) OnPrimativeBool(src[i]);
 			OnArrayEnd();
 		}
 
 		/*!
-			\brief Handle an array of primative values (bool)
+			\brief Handle an array of user defined binary structures.
 			\details This is the same as the following code, but is a special case that could be optimised :
 			\code{.cpp}
 			OnArrayBegin(size);
-			for (uint32_t i = 0u; i < size; ++i) OnPrimativeBool(src[i]);
+			for (uint32_t i = 0u; i < size; ++i) OnUserPOD(type, bytes, static_cast<const uint8_t*>(src) + i * bytes);
 			OnArrayEnd();
 			\endcode
-			\param src The address of the first value
-			\param size The number of values in the array
+			\param type A 24-bit ID code that describes which structure is being parsed.
+			\param bytes The size of one structure in bytes.
+			\param src The address of the first structure, structures are tightly packed.
+			\param size The number of structures in the array
 		*/
-		virtual void OnPrimativeArrayBool(const bool* src, const uint32_t size) {
+		virtual void OnUserPODArray(const uint32_t type, const uint32_t bytes, const void* src, const uint32_t size) {
 			OnArrayBegin(size);
-			for (uint32_t i = 0u; i < size; ++i) OnPrimativeBool(src[i]);
+			for (uint32_t i = 0u; i < size; ++i) OnUserPOD(type, bytes, static_cast<const uint8_t*>(src) + static_cast<size_t>(i) * bytes);
 			OnArrayEnd();
 		}
 
+		/*!
+			\brief Handle an N-dimensional array of primative values.
+			\details The values are stored contiguously in row-major order (the last dimension is contiguous).
+			The default implementation outputs nested arrays, the last dimension is output with OnPrimativeArray.
+			For example a 2 x 3 tensor of floats is output as :
+			\code{.cpp}
+			OnArrayBegin(2);
+			OnPrimativeArrayF32(src, 3);
+			OnPrimativeArrayF32(src + 3, 3);
+			OnArrayEnd();
+			\endcode
+			A tensor with a rank of 0 contains a single value.
+			\param type The type of the values, this must be a primative type.
+			\param rank The number of dimensions.
+			\param shape The size of each dimension, starting with the outermost.
+			\param src The address of the first value.
+			\see OnPrimativeTensorStrided
+		*/
+		virtual void OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src);
+
+		/*!
+			\brief Handle an N-dimensional array of primative values that are not stored contiguously.
+			\details If the strides describe a contiguous row-major tensor then OnPrimativeTensor is called
+			directly, otherwise the values are copied into a contiguous buffer first.
+			\param type The type of the values, this must be a primative type.
+			\param rank The number of dimensions.
+			\param shape The size of each dimension, starting with the outermost.
+			\param strides The distance in bytes between consecutive values of each dimension.
+			\param src The address of the first value.
+			\see OnPrimativeTensor
+		*/
+		void OnPrimativeTensorStrided(const Type type, const uint32_t rank, const uint32_t* shape, const ptrdiff_t* strides, const void* src);
+
+		/*!
+			\brief Handle an array of primative values where most of the values are zero.
+			\details Only the values that are not zero are listed. The default implementation expands the array
+			with ScatterSparseValues (into the memory from AcquireArrayBuffer if it is provided, otherwise into a 
+			buffer that is reused between calls) and then calls OnPrimativeArray.
+			\param type The type of the values, this must be a primative type.
+			\param size The number of values in the dense array.
+			\param indices The index of each value in the dense array, in ascending order.
+			\param values The values that are not zero.
+			\param count The number of values and indices.
+			\see Writer::SetSparseArrays
+		*/
+		virtual void OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count);
+
+		/*!
+			\brief Handle an array of objects that have the same primative components, stored as one array per component.
+			\details Each column contains the value of one component for every object in the array, so a parser
+			can process a component of every object with one pass over contiguous memory.
+			The default implementation reconstructs the objects, for example 2 rows with the components 1 and 2 are output as :
+			\code{.cpp}
+			OnArrayBegin(2);
+			OnObjectBegin(2);
+			OnComponentID(1); OnValue(columns[0][0]);
+			OnComponentID(2); OnValue(columns[1][0]);
+			OnObjectEnd();
+			OnObjectBegin(2);
+			OnComponentID(1); OnValue(columns[0][1]);
+			OnComponentID(2); OnValue(columns[1][1]);
+			OnObjectEnd();
+			OnArrayEnd();
+			\endcode
+			\param rows The number of objects in the array.
+			\param column_count The number of components in each object.
+			\param component_ids The component ID of each column.
+			\param types The type of each column, these must be primative types.
+			\param columns The address of the values in each column.
+			\see Writer::SetColumnarArrays
+		*/
+		virtual void OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns);
+
 		// Template helpers
 
 		template<class T>
@@ -612,6 +761,9 @@ namespace anvil { namespace BytePipe {
 		\author Adam Smtih
 		\date ??? 2019
 		\brief Reads binary serialised data from an InputPipe and outputs it into a Parser
+		\details Strings, arrays and user PODs are read into a buffer that is kept between calls to Read, so
+		after the largest value has been seen reading does not allocate memory. Strings from the pipe's string
+		table (see Writer::SetStringTable) are output directly from the table without being copied.
 		\see Writer
 	*/
 	class Reader {
@@ -622,9 +774,18 @@ namespace anvil { namespace BytePipe {
 		Reader& operator=(const Reader&) = delete;
 
 		InputPipe& _pipe;
+		std::pmr::vector<uint64_t> _buffer;
+		std::pmr::vector<std::pmr::string> _string_table;
+		std::pmr::vector<std::pmr::vector<ComponentID>> _shapes;
 
 	public:
 		Reader(InputPipe& pipe);
+
+		/*!
+			\param pipe The pipe to read from.
+			\param resource Where the read buffer, string table and object shapes are allocated, this must outlive the Reader.
+		*/
+		Reader(InputPipe& pipe, std::pmr::memory_resource* resource);
 		~Reader();
 
 		void Read(Parser& dst);
@@ -634,17 +795,32 @@ namespace anvil { namespace BytePipe {
 		\author Adam Smtih
 		\date March 2021
 		\brief Converts data into DOM (document object model) style format.
+		\details The strings, arrays and objects of the values are allocated from a std::pmr::memory_resource,
+		for example a std::pmr::monotonic_buffer_resource can be used to allocate everything for one message
+		from an arena that is released in one operation.
 	*/
 	class ValueParser final : public Parser {
 	private:
+		struct Container {
+			Value value;
+			ComponentID id;	//!< The component ID of the container in its parent object
+		};
+
+		std::pmr::memory_resource* const _resource;
 		Value _root;
-		std::vector<Value*> _value_stack;
+		std::pmr::vector<Container> _value_stack;	//!< Arrays and objects that are being parsed, they are added to their parent when they end
 		ComponentID _component_id;
 
-		Value& CurrentValue();
-		Value& NextValue();
+		void AddValue(Value&& value);
+		void EndContainer();
 	public:
 		ValueParser();
+
+		/*!
+			\param resource Where values and the parser's own memory are allocated. This must outlive the parser
+			and any values that share data with GetValue().
+		*/
+		ValueParser(std::pmr::memory_resource* resource);
 		virtual ~ValueParser();
 
 		Value& GetValue();
@@ -672,6 +848,7 @@ namespace anvil { namespace BytePipe {
 		void OnPrimativeS16(const int16_t value) final;
 		void OnPrimativeS32(const int32_t value) final;
 		void OnPrimativeF16(const half value) final;
+		void OnPrimativeArrayF16(const half* src, const uint32_t size) final;
 	};
 
 }}
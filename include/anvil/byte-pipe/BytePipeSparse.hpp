@@ -0,0 +1,88 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_SPARSE_HPP
+#define ANVIL_LUTILS_BYTEPIPE_SPARSE_HPP
+
+#include "anvil/byte-pipe/BytePipeCore.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page Sparse Arrays
+		\details
+		A sparse array only stores the values that are not zero, along with their index in the array.
+		A value is zero when all of its bytes are zero, so -0.0 is kept as a value.
+		Writer::SetSparseArrays enables the encoding, Parser::OnPrimativeSparseArray receives it.
+
+		The functions below work on values of 1, 2, 4 or 8 bytes. Zero values are found 32 bytes at a time
+		with AVX2 when it is enabled (see BytePipeCore.hpp).
+	*/
+
+	/*!
+		\brief Count the values in an array that are not zero.
+		\param src The values.
+		\param element_bytes The size of one value in bytes.
+		\param size The number of values in src.
+		\return The number of values that are not zero.
+	*/
+	uint32_t CountNonZeroValues(const void* src, const uint32_t element_bytes, const uint32_t size);
+
+	/*!
+		\brief Copy the values in an array that are not zero, along with their indices.
+		\param src The values.
+		\param element_bytes The size of one value in bytes.
+		\param size The number of values in src.
+		\param indices Where the indices are written in ascending order, this must have space for every value
+		that is not zero (see CountNonZeroValues).
+		\param values Where the values are written, this must have space for every value that is not zero.
+		\return The number of values that are not zero.
+	*/
+	uint32_t GatherNonZeroValues(const void* src, const uint32_t element_bytes, const uint32_t size, uint32_t* indices, void* values);
+
+	/*!
+		\brief Expand a sparse array into a dense one.
+		\details dst is filled with zero and then the values are copied to their indices.
+		\param indices The index of each value, these must be less than size.
+		\param values The values.
+		\param element_bytes The size of one value in bytes.
+		\param count The number of values.
+		\param dst Where the dense array is written.
+		\param size The number of values in dst.
+	*/
+	void ScatterSparseValues(const uint32_t* indices, const void* values, const uint32_t element_bytes, const uint32_t count, void* dst, const uint32_t size);
+
+	/*!
+		\brief Set the bit for each index in a bitmap.
+		\details Bit i is stored in byte i / 8 at position i % 8 (the least significant bit is index 0).
+		\param indices The indices to set, these must be less than size.
+		\param count The number of indices.
+		\param bitmap Where the bitmap is written, this must be (size + 7) / 8 bytes.
+		\param size The number of bits in the bitmap.
+	*/
+	void IndicesToBitmap(const uint32_t* indices, const uint32_t count, uint8_t* bitmap, const uint32_t size);
+
+	/*!
+		\brief List the bits that are set in a bitmap.
+		\param bitmap The bitmap, in the same layout as IndicesToBitmap.
+		\param size The number of bits in the bitmap, bits after this are ignored.
+		\param indices Where the indices are written in ascending order.
+		\param max_count The number of indices that can be written, bits after this are counted but not written.
+		\return The number of bits that are set.
+	*/
+	uint32_t BitmapToIndices(const uint8_t* bitmap, const uint32_t size, uint32_t* indices, const uint32_t max_count);
+
+}}
+
+#endif
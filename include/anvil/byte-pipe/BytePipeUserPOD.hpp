@@ -0,0 +1,66 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_USER_POD_HPP
+#define ANVIL_LUTILS_BYTEPIPE_USER_POD_HPP
+
+#include <initializer_list>
+#include "anvil/byte-pipe/BytePipeCore.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page User POD Layouts
+		\details
+		User PODs are written as raw bytes, so a pipe that is read on a machine with a different byte order needs
+		to know where the multi-byte fields of each structure are. RegisterUserPOD records the width of every
+		field in a POD type, Reader and Writer then use it to swap the byte order of registered PODs.
+		PODs that have not been registered are passed through without being swapped.
+
+		If every field is aligned to its own width (which is the default layout for most compilers) the byte order
+		of an array of PODs is swapped 16 bytes at a time with SSSE3 when it is enabled (see BytePipeCore.hpp).
+	*/
+
+	/*!
+		\brief Describe the fields of a user POD type so that its byte order can be swapped.
+		\details Registering the same layout twice has no effect, an exception is thrown if the type has already
+		been registered with a different layout. Layouts cannot be removed once they are registered.
+		\param type The user POD ID.
+		\param bytes The size of the structure in bytes.
+		\param field_widths The size of each field in order, this must be 1, 2, 4 or 8. Padding is described as
+		fields of 1 byte. The widths must add up to bytes.
+		\param field_count The number of values in field_widths.
+	*/
+	void RegisterUserPOD(const uint32_t type, const uint32_t bytes, const uint8_t* field_widths, const uint32_t field_count);
+
+	static inline void RegisterUserPOD(const uint32_t type, const uint32_t bytes, const std::initializer_list<uint8_t> field_widths) {
+		RegisterUserPOD(type, bytes, field_widths.begin(), static_cast<uint32_t>(field_widths.size()));
+	}
+
+	/*!
+		\brief Swap the byte order of the fields in an array of user PODs.
+		\details An exception is thrown if the type is registered with a different size.
+		\param type The user POD ID.
+		\param src The PODs to swap.
+		\param dst Where the swapped PODs are written, this can be the same as src but must not partially overlap it.
+		\param bytes The size of one POD in bytes.
+		\param count The number of PODs in the array.
+		\return False if the type has not been registered, in which case dst is not modified.
+		\see RegisterUserPOD
+	*/
+	bool SwapUserPODByteOrder(const uint32_t type, const void* src, void* dst, const uint32_t bytes, const uint32_t count);
+
+}}
+
+#endif
@@ -16,6 +16,9 @@
 #define ANVILBYTEPIPE_WRITER_HPP
 
 #include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include "anvil/byte-pipe/BytePipeReader.hpp"
 
 namespace anvil { namespace BytePipe {
@@ -33,6 +36,18 @@ namespace anvil { namespace BytePipe {
 		virtual void Flush() = 0;
 	};
 
+	/*!
+		\brief Serialise a value directly into a contiguous block of memory.
+		\details The bytes are the same as those written by Writer::OnValue with the default settings, the pipe 
+		header is not included.
+		Arrays where all values are the same primative type are written as primative arrays.
+		\param value The value to serialise.
+		\param dst The destination memory, this must be at least Value::EncodedSize() bytes.
+		\param endianness The byte order that the value is encoded with.
+		\return The number of bytes written.
+	*/
+	size_t EncodeValue(const Value& value, void* dst, const Endianness endianness);
+
 	/*!
 		\author Adam Smtih
 		\date September 2019
@@ -50,20 +65,61 @@ namespace anvil { namespace BytePipe {
 			STATE_CLOSED,
 			STATE_NORMAL,
 			STATE_ARRAY,
-			STATE_OBJECT
+			STATE_OBJECT,
+			STATE_SHAPED_OBJECT
+		};
+
+		struct ObjectShape {
+			std::vector<ComponentID> component_ids;
+			bool written;	//!< True if the shape has been written to the current pipe
+		};
+
+		struct ShapedObject {
+			uint32_t shape;
+			uint32_t component;	//!< The index of the next component
+		};
+
+		struct StringTableEntry {
+			std::string value;
+			uint32_t previous;	//!< The entry that was used less recently
+			uint32_t next;		//!< The entry that was used more recently
 		};
 
 		OutputPipe& _pipe;
+		uint64_t _bytes_written;
 		std::vector<State> _state_stack;
+		std::vector<uint8_t> _value_buffer;
+		std::vector<uint32_t> _sparse_indices;
+		std::vector<uint8_t> _sparse_values;
+		std::vector<uint8_t> _packed_values;
+		std::vector<uint64_t> _xor_words;
+		std::vector<uint64_t> _array_values;	//!< Primative arrays copied out of a Value by OnValue
+		std::vector<StringTableEntry> _string_table;	//!< The last entry is the head of the LRU list
+		std::unordered_map<std::string_view, uint32_t> _string_table_lookup;
+		uint32_t _string_table_size;
+		uint32_t _string_table_max_length;
+		std::vector<ObjectShape> _shapes;
+		std::vector<ShapedObject> _shaped_objects;
 		State _default_state;
 		Version _version;
 		bool _swap_byte_order;
+		bool _f32_arrays_as_f16;
+		bool _sparse_arrays;
+		bool _bit_packed_arrays;
+		bool _xor_float_arrays;
+		bool _columnar_arrays;
 
 		State GetCurrentState() const;
 		void Write(const void* src, const uint32_t bytes);
 		void _OnPrimative32(uint32_t value, const uint8_t id);
 		void _OnPrimative64(uint64_t value, const uint8_t id);
 		void _OnPrimativeArray(const void* ptr, const uint32_t size, const uint8_t id);
+		void WritePrimatives(const void* ptr, const uint32_t size, const uint32_t element_bytes);
+		void ResetStringTable();
+		void UseStringTableEntry(const uint32_t entry);
+		void WriteStringTableEntry(const char* value, const uint32_t length);
+		void WriteColumnarArray(const Value& value);
+		bool WriteValueThroughCallbacks(const Value& value, uint8_t*& dst, const size_t buffer_size);
 
 		Writer(OutputPipe& pipe, Version version, bool swap_byte_order);
 	public:
@@ -74,6 +130,65 @@ namespace anvil { namespace BytePipe {
 
 		Endianness GetEndianness() const;
 
+		/*!
+			\brief Write arrays of 32-bit floating point values as 16-bit floating point.
+			\details This halves the size of the arrays, values are rounded with FloatToHalf.
+			Readers receive the arrays through OnPrimativeArrayF16.
+			\param enabled True to convert arrays, false to write them unchanged (the default).
+		*/
+		void SetF32ArraysAsF16(const bool enabled);
+
+		/*!
+			\brief Write primative arrays that are mostly zero as sparse arrays.
+			\details Each array is checked for zero values and is only written as a sparse array if that is
+			smaller than writing every value. The indices of the other values are written as a list, or as a bitmap
+			when that is smaller. Readers receive the arrays through OnPrimativeSparseArray.
+			\param enabled True to write sparse arrays, false to write every value (the default).
+		*/
+		void SetSparseArrays(const bool enabled);
+
+		/*!
+			\brief Write arrays of 32 and 64-bit integers as bit packed arrays.
+			\details Each array is packed in blocks of 128 values and is only written packed if that is smaller than
+			writing every value. This works best for timestamps, counters and other values that are close together.
+			Readers unpack the arrays, so parsers receive them through the normal array callbacks.
+			\param enabled True to write bit packed arrays, false to write every value (the default).
+			\see BitPackIntegers
+		*/
+		void SetBitPackedArrays(const bool enabled);
+
+		/*!
+			\brief Write arrays of 32 and 64-bit floating point values with XOR compression.
+			\details Each value is stored as the bits that changed since the value before it, which makes slowly
+			changing series much smaller. An array is only compressed if that is smaller than writing every value
+			and the values always round trip exactly. The setting can be changed between arrays to choose which ones are compressed.
+			Readers decompress the arrays, so parsers receive them through the normal array callbacks.
+			\param enabled True to compress floating point arrays, false to write every value (the default).
+			\see XORCompressFloats
+		*/
+		void SetXORFloatArrays(const bool enabled);
+
+		/*!
+			\brief Write repeated strings as references to a table of strings that have already been written.
+			\details The first time a string is written it is added to the table, later copies of it are
+			written as a 3 byte reference. When the table is full the least recently used string is replaced.
+			The table is cleared each time the pipe is opened or this function is called.
+			\param max_strings The number of strings that the table can hold (up to 65536), 0 disables the
+			table (the default).
+			\param max_length Strings that are longer than this are not added to the table. Together with
+			max_strings this bounds the memory used by the table.
+		*/
+		void SetStringTable(const uint32_t max_strings, const uint32_t max_length);
+
+		/*!
+			\brief Write arrays of objects with the same primative components as one array per component.
+			\details This applies to values written with OnValue. An array is written as columns if every value in it
+			is an object with the same component IDs, and each component has the same primative type in every object.
+			Readers receive the arrays through OnColumnarArray.
+			\param enabled True to write columns, false to write each object (the default).
+		*/
+		void SetColumnarArrays(const bool enabled);
+
 		// Inherited from Parser
 
 		void OnPipeOpen() final;
@@ -83,6 +198,20 @@ namespace anvil { namespace BytePipe {
 		void OnObjectBegin(const uint32_t component_count) final;
 		void OnObjectEnd() final;
 		void OnComponentID(const uint16_t id) final;
+
+		/*!
+			\brief Define the component IDs of a shape.
+			\details The shape is written to the pipe with the first object that uses it. Objects that use a shape
+			do not write their component IDs, which saves 2 bytes for every value.
+			A shape cannot be redefined while an object that uses it is being written.
+		*/
+		void OnObjectShape(const uint32_t shape, const ComponentID* component_ids, const uint32_t component_count) final;
+
+		/*!
+			\brief Write an object that uses a shape.
+			\details The following calls to OnComponentID must match the IDs of the shape, in order.
+		*/
+		void OnShapedObjectBegin(const uint32_t shape, const uint32_t component_count) final;
 		void OnNull() final;
 		void OnPrimativeF64(const double value) final;
 		void OnPrimativeString(const char* value, const uint32_t length) final;
@@ -114,6 +243,46 @@ namespace anvil { namespace BytePipe {
 		void OnPrimativeArrayBool(const bool* src, const uint32_t size) final;
 
 		void OnUserPOD(const uint32_t type, const uint32_t bytes, const void* data) final;
+
+		/*!
+			\brief Write an array of user PODs.
+			\details The PODs are written with a single call to the pipe, if the pipe has a different byte order and
+			the POD type has been registered with RegisterUserPOD their fields are swapped first.
+		*/
+		void OnUserPODArray(const uint32_t type, const uint32_t bytes, const void* src, const uint32_t size) final;
+
+		/*!
+			\brief Write an N-dimensional array of primative values.
+			\details The values are written contiguously after the shape, padding is inserted so that the first value
+			is aligned to 64 bytes from the start of the pipe. When the pipe is read from memory that is 64 byte
+			aligned (for example a memory mapped file) Reader can output the values without copying them.
+		*/
+		void OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src) final;
+
+		/*!
+			\brief Write a sparse array of primative values.
+			\details The array is written as a sparse array even if SetSparseArrays is disabled.
+		*/
+		void OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count) final;
+
+		/*!
+			\brief Write an array of objects as one array per component.
+			\details The columns are written one after another, each with a single write to the pipe.
+		*/
+		void OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns) final;
+
+		/*!
+			\brief Write a DOM style value.
+			\details The value is encoded into a buffer of Value::EncodedSize() bytes and then written to the
+			pipe with a single call, instead of one write per node. The output is the same as writing the value 
+			through the callbacks, with primative arrays passed to OnPrimativeArray. Parts of the value that are 
+			affected by the writer's settings (SetStringTable, SetF32ArraysAsF16, SetSparseArrays, 
+			SetBitPackedArrays, SetXORFloatArrays and SetColumnarArrays) are written through the callbacks, and 
+			the rest is still encoded as blocks between them.
+			\param value The value
+		*/
+		void OnValue(const Value& value) final;
+		using Parser::OnValue;
 	};
 
 }}
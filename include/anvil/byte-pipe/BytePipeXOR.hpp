@@ -0,0 +1,71 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#ifndef ANVIL_LUTILS_BYTEPIPE_XOR_HPP
+#define ANVIL_LUTILS_BYTEPIPE_XOR_HPP
+
+#include "anvil/byte-pipe/BytePipeObjects.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	/*!
+		\page XOR Compressed Arrays
+		\details
+		Floating point values that change slowly share their sign, exponent and high mantissa bits with the
+		value before them. XOR compression (as used by the Gorilla time series database) stores the first value
+		unchanged and then the XOR of each value with the value before it :
+		- '0' : The value is the same as the previous value.
+		- '10' : The meaningful bits of the XOR fit inside the previous window of leading and trailing zeros,
+		only the bits inside the window are written.
+		- '11' : A new window, the number of leading zeros (5 bits for F32, 6 bits for F64), the number of
+		meaningful bits minus 1 (5 or 6 bits) and then the meaningful bits.
+
+		Values are compared as bit patterns, so every value (including NaN payloads and -0.0) round trips exactly.
+		The bits are written into 64-bit words, starting from the most significant bit.
+		Writer::SetXORFloatArrays enables the encoding, Reader decompresses the arrays before they are output so
+		parsers receive them through the normal array callbacks.
+	*/
+
+	/*!
+		\brief Return the largest number of words that XORCompressFloats can write.
+		\param type The type of the values, this must be TYPE_F32 or TYPE_F64.
+		\param size The number of values.
+		\return The number of 64-bit words.
+	*/
+	uint64_t GetMaxXORCompressedWords(const Type type, const uint32_t size);
+
+	/*!
+		\brief XOR compress an array of floating point values.
+		\param src The values.
+		\param type The type of the values, this must be TYPE_F32 or TYPE_F64.
+		\param size The number of values in src.
+		\param dst Where the compressed words are written, this must have space for GetMaxXORCompressedWords words.
+		\return The number of words written to dst.
+	*/
+	uint64_t XORCompressFloats(const void* src, const Type type, const uint32_t size, uint64_t* dst);
+
+	/*!
+		\brief Decompress an array that was written by XORCompressFloats.
+		\details An exception is thrown if the compressed words are not valid.
+		\param src The compressed words, these do not need to be aligned.
+		\param words The number of compressed words.
+		\param type The type of the values, this must be the type that the array was compressed with.
+		\param size The number of values in the array.
+		\param dst Where the values are written.
+	*/
+	void XORDecompressFloats(const void* src, const uint32_t words, const Type type, const uint32_t size, void* dst);
+
+}}
+
+#endif
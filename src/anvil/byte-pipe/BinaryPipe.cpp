@@ -15,6 +15,10 @@
 #include <cstddef>
 #include "anvil/byte-pipe/BytePipeWriter.hpp"
 #include "anvil/byte-pipe/BytePipeEndian.hpp"
+#include "anvil/byte-pipe/BytePipeUserPOD.hpp"
+#include "anvil/byte-pipe/BytePipeSparse.hpp"
+#include "anvil/byte-pipe/BytePipeBitPack.hpp"
+#include "anvil/byte-pipe/BytePipeXOR.hpp"
 
 #ifdef ANVIL_DISABLE_LUTILS
 	#ifndef ANVIL_CONTRACT
@@ -44,7 +48,11 @@ namespace anvil { namespace BytePipe {
 		PID_STRING,
 		PID_ARRAY,
 		PID_OBJECT,
-		PID_USER_POD
+		PID_USER_POD,
+		PID_TENSOR,
+		PID_SPARSE_ARRAY,
+		PID_BIT_PACKED_ARRAY,
+		PID_XOR_ARRAY
 	};
 
 	enum SecondaryID : uint8_t {
@@ -61,7 +69,26 @@ namespace anvil { namespace BytePipe {
 		SID_F64,
 		SID_C8,
 		SID_F16,
-		SID_B
+		SID_B,
+		SID_USER_POD,	// Only used for arrays
+		SID_COLUMNS		// Only used for arrays
+	};
+
+	// Secondary IDs of PID_STRING, strings that are not in the string table use SID_C8
+	enum StringTableID : uint8_t {
+		STID_DEFINE = 1u,	//!< Store the string in the string table and output it
+		STID_REFERENCE = 2u	//!< Output a string that is already in the string table
+	};
+
+	// Secondary IDs of PID_OBJECT, objects that write their component IDs use SID_NULL
+	enum ObjectShapeID : uint8_t {
+		OSID_DEFINE = 1u,	//!< Define a shape and then output an object that uses it
+		OSID_REFERENCE = 2u	//!< Output an object that uses a shape that is already defined
+	};
+
+	enum SparseEncoding : uint8_t {
+		SPARSE_INDICES,	//!< A uint32_t index for each value
+		SPARSE_BITMAP	//!< One bit for every index in the array
 	};
 
 	// Header definitions
@@ -101,10 +128,20 @@ namespace anvil { namespace BytePipe {
 				uint32_t components;
 			} object_v1;
 
+			struct {
+				uint16_t shape;
+				uint32_t components;	//!< Only written for OSID_DEFINE
+			} object_shape_v1;
+
 			struct {
 				uint32_t length;
 			} string_v1;
 
+			struct {
+				uint16_t entry;
+				uint32_t length;	//!< Only written for STID_DEFINE
+			} string_table_v1;
+
 			union ValueHeaderPrimative {
 				bool b;
 				uint8_t u8;
@@ -125,6 +162,39 @@ namespace anvil { namespace BytePipe {
 				uint16_t extended_secondary_id;
 				uint32_t bytes;
 			} user_pod;
+
+			struct {
+				uint32_t size;
+				uint32_t type;
+				uint32_t bytes;
+			} user_pod_array;
+
+			struct {
+				uint32_t rows;
+				uint16_t columns;
+				uint32_t bytes;	//!< The size of all columns
+			} columns_v1;
+
+			struct {
+				uint8_t rank;
+				uint8_t padding;	//!< Number of zero bytes between the shape and the values
+			} tensor_v1;
+
+			struct {
+				uint32_t size;
+				uint32_t count;		//!< Number of values that are not zero
+				uint8_t encoding;	//!< SparseEncoding
+			} sparse_array_v1;
+
+			struct {
+				uint32_t size;
+				uint32_t bytes;		//!< The size of the packed blocks
+			} bit_packed_array_v1;
+
+			struct {
+				uint32_t size;
+				uint32_t words;		//!< The number of 64-bit words that the compressed values use
+			} xor_array_v1;
 		};
 	};
 #pragma pack(pop)
@@ -133,8 +203,16 @@ namespace anvil { namespace BytePipe {
 
 	static_assert(sizeof(PipeHeaderV1) == 1u, "PipeHeaderV1 was not packed correctly by compiler");
 	static_assert(sizeof(PipeHeaderV2) == 2u, "PipeHeaderV2 was not packed correctly by compiler");
-	static_assert(sizeof(ValueHeader) == 9u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader) == 13u, "ValueHeader was not packed correctly by compiler");
 	static_assert(sizeof(ValueHeader::user_pod) == 6u, "ValueHeader was not packed correctly by compiler");
+	static_assert(offsetof(ValueHeader, user_pod_array.size) == offsetof(ValueHeader, array_v1.size), "ValueHeader was not packed correctly by compiler");
+	static_assert(offsetof(ValueHeader, columns_v1.rows) == offsetof(ValueHeader, array_v1.size), "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::object_shape_v1) == 6u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::string_table_v1) == 6u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::tensor_v1) == 2u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::sparse_array_v1) == 9u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::bit_packed_array_v1) == 8u, "ValueHeader was not packed correctly by compiler");
+	static_assert(sizeof(ValueHeader::xor_array_v1) == 8u, "ValueHeader was not packed correctly by compiler");
 	static_assert(offsetof(ValueHeader, primative_v1.u8) == 1u, "ValueHeader was not packed correctly by compiler");
 
 	// Helper functions
@@ -249,7 +327,7 @@ namespace anvil { namespace BytePipe {
 		TYPE_S32, // SID_S32
 		TYPE_S64, // SID_S64
 		TYPE_F32, // SID_F32
-		TYPE_F32, // SID_F64
+		TYPE_F64, // SID_F64
 		TYPE_C8, // SID_C8
 		TYPE_F16, // SID_F16,
 		TYPE_BOOL // SID_B
@@ -313,6 +391,22 @@ namespace anvil { namespace BytePipe {
 		detail::CallOnPrimativeB	// SID_B
 	};
 
+	static void SwapPrimativeArrayByteOrder(const void* src, void* dst, const uint32_t element_bytes, const uint32_t size) {
+		// src and dst can be the same address
+		if (element_bytes == 2u) {
+			typedef uint16_t T;
+			for (uint32_t i = 0u; i < size; ++i) static_cast<T*>(dst)[i] = SwapByteOrder(static_cast<const T*>(src)[i]);
+		} else if (element_bytes == 4u) {
+			typedef uint32_t T;
+			for (uint32_t i = 0u; i < size; ++i) static_cast<T*>(dst)[i] = SwapByteOrder(static_cast<const T*>(src)[i]);
+		} else if (element_bytes == 8u) {
+			typedef uint64_t T;
+			for (uint32_t i = 0u; i < size; ++i) static_cast<T*>(dst)[i] = SwapByteOrder(static_cast<const T*>(src)[i]);
+		} else {
+			throw std::runtime_error("SwapPrimativeArrayByteOrder : Cannot swap byte order");
+		}
+	}
+
 	template<class T>
 	static ANVIL_CONSTEXPR SecondaryID GetSecondaryID();
 
@@ -335,12 +429,20 @@ namespace anvil { namespace BytePipe {
 
 	Writer::Writer(OutputPipe& pipe, Version version, bool swap_byte_order) :
 		_pipe(pipe),
+		_bytes_written(0u),
+		_string_table_size(0u),
+		_string_table_max_length(0u),
 		_default_state(STATE_CLOSED),
 		_version(version),
-		_swap_byte_order(swap_byte_order)
+		_swap_byte_order(swap_byte_order),
+		_f32_arrays_as_f16(false),
+		_sparse_arrays(false),
+		_bit_packed_arrays(false),
+		_xor_float_arrays(false),
+		_columnar_arrays(false)
 	{
 		// Check for invalid settings
-		if (_version == VERSION_1 && GetEndianness() == ENDIAN_BIG) throw std::runtime_error("Writer::Writer : Writing to big endian requires version 2 or higher");
+		if (_version == VERSION_1 && BytePipe::GetEndianness() == ENDIAN_BIG) throw std::runtime_error("Writer::Writer : Writing to big endian requires version 2 or higher");
 	}
 
 	Writer::Writer(OutputPipe& pipe, Version version) :
@@ -353,7 +455,7 @@ namespace anvil { namespace BytePipe {
 
 
 	Writer::Writer(OutputPipe& pipe, Version version, Endianness endianness) :
-		Writer(pipe, version, GetEndianness() != endianness)
+		Writer(pipe, version, BytePipe::GetEndianness() != endianness)
 	{}
 
 	Writer::~Writer() {
@@ -361,13 +463,107 @@ namespace anvil { namespace BytePipe {
 	}
 
 	Endianness Writer::GetEndianness() const {
-		const Endianness e = GetEndianness();
+		const Endianness e = BytePipe::GetEndianness();
 		return _swap_byte_order ? (e == ENDIAN_LITTLE ? ENDIAN_BIG : ENDIAN_LITTLE) : e;
 	}
 
+	void Writer::SetF32ArraysAsF16(const bool enabled) {
+		_f32_arrays_as_f16 = enabled;
+	}
+
+	void Writer::SetSparseArrays(const bool enabled) {
+		_sparse_arrays = enabled;
+	}
+
+	void Writer::SetBitPackedArrays(const bool enabled) {
+		_bit_packed_arrays = enabled;
+	}
+
+	void Writer::SetXORFloatArrays(const bool enabled) {
+		_xor_float_arrays = enabled;
+	}
+
+	void Writer::SetColumnarArrays(const bool enabled) {
+		_columnar_arrays = enabled;
+	}
+
+	void Writer::SetStringTable(const uint32_t max_strings, const uint32_t max_length) {
+		ANVIL_CONTRACT(max_strings <= 65536u, "Writer::SetStringTable : String table cannot contain more than 65536 strings");
+		_string_table.clear();
+		_string_table.resize(max_strings > 0u ? max_strings + 1u : 0u);
+		_string_table_max_length = max_length;
+		ResetStringTable();
+	}
+
+	void Writer::ResetStringTable() {
+		_string_table_lookup.clear();
+		_string_table_size = 0u;
+		if (! _string_table.empty()) {
+			// The head of the LRU list links to itself when the list is empty
+			const uint32_t head = static_cast<uint32_t>(_string_table.size() - 1u);
+			_string_table[head].previous = head;
+			_string_table[head].next = head;
+		}
+	}
+
+	void Writer::UseStringTableEntry(const uint32_t entry) {
+		StringTableEntry* const table = _string_table.data();
+		const uint32_t head = static_cast<uint32_t>(_string_table.size() - 1u);
+
+		// Remove the entry from the list if it is already in it
+		if (entry < _string_table_size) {
+			table[table[entry].previous].next = table[entry].next;
+			table[table[entry].next].previous = table[entry].previous;
+		}
+
+		// Move the entry to the most recently used end of the list
+		table[entry].previous = table[head].previous;
+		table[entry].next = head;
+		table[table[head].previous].next = entry;
+		table[head].previous = entry;
+	}
+
+	void Writer::WriteStringTableEntry(const char* value, const uint32_t length) {
+		ValueHeader header;
+		header.primary_id = PID_STRING;
+
+		// Write a reference if the string is already in the table
+		const auto i = _string_table_lookup.find(std::string_view(value, length));
+		if (i != _string_table_lookup.end()) {
+			UseStringTableEntry(i->second);
+			header.secondary_id = STID_REFERENCE;
+			header.string_table_v1.entry = static_cast<uint16_t>(i->second);
+			Write(&header, sizeof(ValueHeader::string_table_v1.entry) + 1u);
+			return;
+		}
+
+		// Use an empty entry, or replace the least recently used one
+		uint32_t entry;
+		const uint32_t head = static_cast<uint32_t>(_string_table.size() - 1u);
+		if (_string_table_size < head) {
+			entry = _string_table_size;
+			UseStringTableEntry(entry);
+			++_string_table_size;
+		} else {
+			entry = _string_table[head].next;
+			_string_table_lookup.erase(std::string_view(_string_table[entry].value));
+			UseStringTableEntry(entry);
+		}
+		std::string& str = _string_table[entry].value;
+		str.assign(value, length);
+		_string_table_lookup.emplace(std::string_view(str), entry);
+
+		header.secondary_id = STID_DEFINE;
+		header.string_table_v1.entry = static_cast<uint16_t>(entry);
+		header.string_table_v1.length = length;
+		Write(&header, sizeof(ValueHeader::string_table_v1) + 1u);
+		Write(value, length);
+	}
+
 	void Writer::Write(const void* src, const uint32_t bytes) {
 		const uint32_t bytesWritten = _pipe.WriteBytes(src, bytes);
 		ANVIL_CONTRACT(bytesWritten == bytes, "Failed to write to pipe");
+		_bytes_written += bytes;
 	}
 
 	Writer::State Writer::GetCurrentState() const {
@@ -377,6 +573,9 @@ namespace anvil { namespace BytePipe {
 	void Writer::OnPipeOpen() {
 		ANVIL_CONTRACT(_default_state == STATE_CLOSED, "BytePipe was already open");
 		_default_state = STATE_NORMAL;
+		_bytes_written = 0u;
+		ResetStringTable();
+		for (ObjectShape& shape : _shapes) shape.written = false;
 
 		union {
 			PipeHeaderV1 header_v1;
@@ -386,7 +585,7 @@ namespace anvil { namespace BytePipe {
 
 		header_v1.version = _version;
 		if (_version > VERSION_1) {
-			const Endianness e = GetEndianness();
+			const Endianness e = BytePipe::GetEndianness();
 
 			header_v2.little_endian = (_swap_byte_order ? e != ENDIAN_LITTLE : e == ENDIAN_LITTLE) ? 1u : 0u;
 			header_v2.reserved_flag1 = 0u;
@@ -437,13 +636,63 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void Writer::OnObjectEnd() {
-		ANVIL_CONTRACT(GetCurrentState() == PID_OBJECT, "BytePipe was not in object mode");
+		const State state = GetCurrentState();
+		if (state == STATE_SHAPED_OBJECT) {
+			const ShapedObject& object = _shaped_objects.back();
+			ANVIL_CONTRACT(object.component == _shapes[object.shape].component_ids.size(), "Writer::OnObjectEnd : Object does not contain every component of its shape");
+			_shaped_objects.pop_back();
+		} else {
+			ANVIL_CONTRACT(state == STATE_OBJECT, "BytePipe was not in object mode");
+		}
 		_state_stack.pop_back();
 	}
 
 	void Writer::OnComponentID(const uint16_t id) {
-		ANVIL_CONTRACT(GetCurrentState() == PID_OBJECT, "BytePipe was not in object mode");
-		Write(&id, 2u);
+		const State state = GetCurrentState();
+		if (state == STATE_SHAPED_OBJECT) {
+			// The ID is already known from the shape
+			ShapedObject& object = _shaped_objects.back();
+			const std::vector<ComponentID>& ids = _shapes[object.shape].component_ids;
+			ANVIL_CONTRACT(object.component < ids.size() && ids[object.component] == id, "Writer::OnComponentID : Component ID does not match the object's shape");
+			++object.component;
+		} else {
+			ANVIL_CONTRACT(state == STATE_OBJECT, "BytePipe was not in object mode");
+			Write(&id, 2u);
+		}
+	}
+
+	void Writer::OnObjectShape(const uint32_t shape, const ComponentID* component_ids, const uint32_t component_count) {
+		ANVIL_CONTRACT(shape <= UINT16_MAX, "Writer::OnObjectShape : Shape ID must be <= 65535");
+		for (const ShapedObject& object : _shaped_objects) ANVIL_CONTRACT(object.shape != shape, "Writer::OnObjectShape : Shape is being used by an object");
+
+		if (_shapes.size() <= shape) _shapes.resize(shape + 1u, ObjectShape{ std::vector<ComponentID>(), false });
+		ObjectShape& tmp = _shapes[shape];
+		tmp.component_ids.assign(component_ids, component_ids + component_count);
+		tmp.written = false;
+	}
+
+	void Writer::OnShapedObjectBegin(const uint32_t shape, const uint32_t component_count) {
+		ANVIL_CONTRACT(shape < _shapes.size(), "Writer::OnShapedObjectBegin : Shape has not been defined");
+		ObjectShape& tmp = _shapes[shape];
+		ANVIL_CONTRACT(component_count == tmp.component_ids.size(), "Writer::OnShapedObjectBegin : Component count does not match the shape");
+
+		ValueHeader header;
+		header.primary_id = PID_OBJECT;
+		header.object_shape_v1.shape = static_cast<uint16_t>(shape);
+		if (tmp.written) {
+			header.secondary_id = OSID_REFERENCE;
+			Write(&header, sizeof(ValueHeader::object_shape_v1.shape) + 1u);
+		} else {
+			// The first object that uses a shape also defines it
+			header.secondary_id = OSID_DEFINE;
+			header.object_shape_v1.components = component_count;
+			Write(&header, sizeof(ValueHeader::object_shape_v1) + 1u);
+			Write(tmp.component_ids.data(), component_count * sizeof(ComponentID));
+			tmp.written = true;
+		}
+
+		_state_stack.push_back(STATE_SHAPED_OBJECT);
+		_shaped_objects.push_back(ShapedObject{ shape, 0u });
 	}
 
 	void Writer::OnNull() {
@@ -561,6 +810,11 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void Writer::OnPrimativeString(const char* value, const uint32_t length) {
+		if (! _string_table.empty() && length <= _string_table_max_length) {
+			WriteStringTableEntry(value, length);
+			return;
+		}
+
 		ValueHeader header;
 		header.primary_id = PID_STRING;
 		header.secondary_id = SID_C8;
@@ -569,40 +823,130 @@ namespace anvil { namespace BytePipe {
 		Write(value, length);
 	}
 
+	void Writer::WritePrimatives(const void* ptr, const uint32_t size, const uint32_t element_bytes) {
+		const uint32_t bytes = size * element_bytes;
+		if (_swap_byte_order && element_bytes > 1u) {
+			// Values that are already in the value buffer are swapped in place
+			if (ptr != _value_buffer.data()) {
+				if (_value_buffer.size() < bytes) _value_buffer.resize(bytes);
+			}
+			SwapPrimativeArrayByteOrder(ptr, _value_buffer.data(), element_bytes, size);
+			ptr = _value_buffer.data();
+		}
+		Write(ptr, bytes);
+	}
+
+	static inline uint64_t GetSparseArrayBytes(const uint32_t size, const uint32_t count, const uint32_t element_bytes, SparseEncoding& encoding) {
+		const uint64_t index_bytes = static_cast<uint64_t>(count) * sizeof(uint32_t);
+		const uint64_t bitmap_bytes = (static_cast<uint64_t>(size) + 7u) / 8u;
+		encoding = bitmap_bytes < index_bytes ? SPARSE_BITMAP : SPARSE_INDICES;
+		return sizeof(ValueHeader::sparse_array_v1) + (encoding == SPARSE_BITMAP ? bitmap_bytes : index_bytes) + static_cast<uint64_t>(count) * element_bytes;
+	}
+
 	void Writer::_OnPrimativeArray(const void* ptr, const uint32_t size, const uint8_t id) {
+		const uint32_t element_bytes = g_secondary_type_sizes[id];
+		uint64_t smallest_bytes = sizeof(ValueHeader::array_v1) + static_cast<uint64_t>(size) * element_bytes;
+
+		// Check if the array would be smaller when bit packed
+		uint64_t packed_bytes = 0u;
+		if (_bit_packed_arrays && size > 0u && (id == SID_U32 || id == SID_S32 || id == SID_U64 || id == SID_S64)) {
+			const Type type = g_sid_2_object_type[id];
+			const uint64_t max_bytes = GetMaxBitPackedBytes(type, size);
+			if (_packed_values.size() < max_bytes) _packed_values.resize(static_cast<size_t>(max_bytes));
+			packed_bytes = BitPackIntegers(ptr, type, size, _packed_values.data());
+			if (sizeof(ValueHeader::bit_packed_array_v1) + packed_bytes < smallest_bytes) {
+				smallest_bytes = sizeof(ValueHeader::bit_packed_array_v1) + packed_bytes;
+			} else {
+				packed_bytes = 0u;
+			}
+		}
+
+		// Check if the array would be smaller when XOR compressed
+		uint64_t xor_words = 0u;
+		if (_xor_float_arrays && size > 0u && (id == SID_F32 || id == SID_F64)) {
+			const Type type = g_sid_2_object_type[id];
+			const uint64_t max_words = GetMaxXORCompressedWords(type, size);
+			if (_xor_words.size() < max_words) _xor_words.resize(static_cast<size_t>(max_words));
+			xor_words = XORCompressFloats(ptr, type, size, _xor_words.data());
+			if (sizeof(ValueHeader::xor_array_v1) + xor_words * sizeof(uint64_t) < smallest_bytes) {
+				smallest_bytes = sizeof(ValueHeader::xor_array_v1) + xor_words * sizeof(uint64_t);
+			} else {
+				xor_words = 0u;
+			}
+		}
+
+		// Check if the array would be smaller as a sparse array
+		if (_sparse_arrays && size > 0u) {
+			const uint32_t count = CountNonZeroValues(ptr, element_bytes, size);
+			SparseEncoding encoding;
+			if (GetSparseArrayBytes(size, count, element_bytes, encoding) < smallest_bytes) {
+				if (_sparse_indices.size() < count) _sparse_indices.resize(count);
+				if (_sparse_values.size() < static_cast<size_t>(count) * element_bytes) _sparse_values.resize(static_cast<size_t>(count) * element_bytes);
+				GatherNonZeroValues(ptr, element_bytes, size, _sparse_indices.data(), _sparse_values.data());
+				OnPrimativeSparseArray(g_sid_2_object_type[id], size, _sparse_indices.data(), _sparse_values.data(), count);
+				return;
+			}
+		}
+
+		if (packed_bytes > 0u && packed_bytes <= UINT32_MAX) {
+			ValueHeader header;
+			header.primary_id = PID_BIT_PACKED_ARRAY;
+			header.secondary_id = id;
+			header.bit_packed_array_v1.size = size;
+			header.bit_packed_array_v1.bytes = static_cast<uint32_t>(packed_bytes);
+			Write(&header, sizeof(ValueHeader::bit_packed_array_v1) + 1u);
+			if (_swap_byte_order) SwapBitPackedByteOrder(_packed_values.data(), static_cast<uint32_t>(packed_bytes), g_sid_2_object_type[id], size);
+			Write(_packed_values.data(), static_cast<uint32_t>(packed_bytes));
+			return;
+		}
+
+		if (xor_words > 0u && xor_words * sizeof(uint64_t) <= UINT32_MAX) {
+			ValueHeader header;
+			header.primary_id = PID_XOR_ARRAY;
+			header.secondary_id = id;
+			header.xor_array_v1.size = size;
+			header.xor_array_v1.words = static_cast<uint32_t>(xor_words);
+			Write(&header, sizeof(ValueHeader::xor_array_v1) + 1u);
+			WritePrimatives(_xor_words.data(), static_cast<uint32_t>(xor_words), sizeof(uint64_t));
+			return;
+		}
+
 		ValueHeader header;
 		header.primary_id = PID_ARRAY;
 		header.secondary_id = id;
 		header.array_v1.size = size;
 		Write(&header, sizeof(ValueHeader::array_v1) + 1u);
+		WritePrimatives(ptr, size, element_bytes);
+	}
+
+	void Writer::OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count) {
+		const uint8_t id = g_object_type_2_sid[type];
+		ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Writer::OnPrimativeSparseArray : Type is not a primative");
+		ANVIL_CONTRACT(count <= size, "Writer::OnPrimativeSparseArray : Array contains more values than its size");
 		const uint32_t element_bytes = g_secondary_type_sizes[id];
-		ANVIL_ASSUME(element_bytes <= 8u);
-		if (_swap_byte_order && element_bytes > 1u) {
-			// Allocate temporary storage
-			void* buffer = _alloca(size * element_bytes);
-
-			// Copy and swap byte order
-			if (element_bytes == 2u) {
-				typedef uint16_t T;
-				T* buffer2 = static_cast<T*>(buffer);
-				for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(static_cast<const T*>(ptr)[i]);
-			} else if (element_bytes == 4u) {
-				typedef uint32_t T;
-				T* buffer2 = static_cast<T*>(buffer);
-				for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(static_cast<const T*>(ptr)[i]);
-			} else if (element_bytes == 8u) {
-				typedef uint64_t T;
-				T* buffer2 = static_cast<T*>(buffer);
-				for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(static_cast<const T*>(ptr)[i]);
-			} else {
-				throw std::runtime_error("Writer::_OnPrimativeArray : Cannot swap byte order");
-			}
+		SparseEncoding encoding;
+		ANVIL_CONTRACT(GetSparseArrayBytes(size, count, element_bytes, encoding) <= UINT32_MAX, "Writer::OnPrimativeSparseArray : Array is too large to write");
 
-			// Write the swapped bytes
-			Write(buffer, size * element_bytes);
+		ValueHeader header;
+		header.primary_id = PID_SPARSE_ARRAY;
+		header.secondary_id = id;
+		header.sparse_array_v1.size = size;
+		header.sparse_array_v1.count = count;
+		header.sparse_array_v1.encoding = encoding;
+		Write(&header, sizeof(ValueHeader::sparse_array_v1) + 1u);
+
+		// Write the indices
+		if (encoding == SPARSE_BITMAP) {
+			const uint32_t bitmap_bytes = (size + 7u) / 8u;
+			if (_value_buffer.size() < bitmap_bytes) _value_buffer.resize(bitmap_bytes);
+			IndicesToBitmap(indices, count, _value_buffer.data(), size);
+			Write(_value_buffer.data(), bitmap_bytes);
 		} else {
-			Write(ptr, size * element_bytes);
+			WritePrimatives(indices, count, sizeof(uint32_t));
 		}
+
+		// Write the values
+		WritePrimatives(values, count, element_bytes);
 	}
 
 	void Writer::OnPrimativeArrayBool(const bool* ptr, const uint32_t size) {
@@ -651,8 +995,16 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void Writer::OnPrimativeArrayF32(const float* ptr, const uint32_t size) {
-		typedef std::remove_const<std::remove_pointer<decltype(ptr)>::type>::type T;
-		_OnPrimativeArray(ptr, size, GetSecondaryID<T>());
+		if (_f32_arrays_as_f16) {
+			// Convert the values into the value buffer
+			_value_buffer.resize(size * sizeof(half));
+			half* const tmp = reinterpret_cast<half*>(_value_buffer.data());
+			FloatToHalf(ptr, tmp, size);
+			_OnPrimativeArray(tmp, size, GetSecondaryID<half>());
+		} else {
+			typedef std::remove_const<std::remove_pointer<decltype(ptr)>::type>::type T;
+			_OnPrimativeArray(ptr, size, GetSecondaryID<T>());
+		}
 	}
 
 	void Writer::OnPrimativeArrayF64(const double* ptr, const uint32_t size) {
@@ -678,9 +1030,351 @@ namespace anvil { namespace BytePipe {
 		header.user_pod.extended_secondary_id = static_cast<uint16_t>(type >> 4u);
 		header.user_pod.bytes = bytes;
 		Write(&header, sizeof(ValueHeader::user_pod) + 1u);
+
+		// Swap the byte order of registered PODs
+		if (_swap_byte_order) {
+			if (_value_buffer.size() < bytes) _value_buffer.resize(bytes);
+			if (SwapUserPODByteOrder(type, data, _value_buffer.data(), bytes, 1u)) data = _value_buffer.data();
+		}
 		Write(data, bytes);
 	}
 
+	void Writer::OnUserPODArray(const uint32_t type, const uint32_t bytes, const void* src, const uint32_t size) {
+		ANVIL_CONTRACT(type <= 1048575u, "Type must be <= 1048575u");
+		const uint64_t total_bytes = static_cast<uint64_t>(bytes) * size;
+		ANVIL_CONTRACT(total_bytes <= UINT32_MAX, "Writer::OnUserPODArray : Array is too large to write");
+
+		ValueHeader header;
+		header.primary_id = PID_ARRAY;
+		header.secondary_id = SID_USER_POD;
+		header.user_pod_array.size = size;
+		header.user_pod_array.type = type;
+		header.user_pod_array.bytes = bytes;
+		Write(&header, sizeof(ValueHeader::user_pod_array) + 1u);
+
+		// Swap the byte order of registered PODs
+		if (_swap_byte_order) {
+			if (_value_buffer.size() < total_bytes) _value_buffer.resize(static_cast<size_t>(total_bytes));
+			if (SwapUserPODByteOrder(type, src, _value_buffer.data(), bytes, size)) src = _value_buffer.data();
+		}
+
+		// All of the PODs are written with one call
+		Write(src, static_cast<uint32_t>(total_bytes));
+	}
+
+	void Writer::OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns) {
+		ANVIL_CONTRACT(column_count <= UINT16_MAX, "Writer::OnColumnarArray : Array cannot have more than 65535 columns");
+
+		ValueHeader header;
+		header.primary_id = PID_ARRAY;
+		header.secondary_id = SID_COLUMNS;
+		header.columns_v1.rows = rows;
+		header.columns_v1.columns = static_cast<uint16_t>(column_count);
+
+		// The type of each column is written as a secondary ID
+		if (_value_buffer.size() < column_count) _value_buffer.resize(column_count);
+		uint64_t bytes = 0u;
+		for (uint32_t i = 0u; i < column_count; ++i) {
+			const uint8_t id = g_object_type_2_sid[types[i]];
+			ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Writer::OnColumnarArray : Column type is not a primative");
+			_value_buffer[i] = id;
+			bytes += static_cast<uint64_t>(g_secondary_type_sizes[id]) * rows;
+		}
+		ANVIL_CONTRACT(bytes <= UINT32_MAX, "Writer::OnColumnarArray : Array is too large to write");
+		header.columns_v1.bytes = static_cast<uint32_t>(bytes);
+
+		Write(&header, sizeof(ValueHeader::columns_v1) + 1u);
+		Write(component_ids, column_count * sizeof(ComponentID));
+		Write(_value_buffer.data(), column_count);
+		for (uint32_t i = 0u; i < column_count; ++i) {
+			WritePrimatives(columns[i], rows, g_secondary_type_sizes[g_object_type_2_sid[types[i]]]);
+		}
+	}
+
+	static bool IsColumnarArray(const Value& value) {
+		if (value.GetType() != TYPE_ARRAY) return false;
+		const uint32_t rows = static_cast<uint32_t>(value.GetSize());
+		if (rows == 0u) return false;
+
+		// The first object decides the columns
+		const Value& first = value.GetValue(0u);
+		if (first.GetType() != TYPE_OBJECT) return false;
+		const size_t columns = first.GetSize();
+		if (columns == 0u || columns > UINT16_MAX) return false;
+		const Value::ComponentIterator first_end = first.GetComponentsEnd();
+		for (Value::ComponentIterator i = first.GetComponentsBegin(); i != first_end; ++i) {
+			const SecondaryID id = g_object_type_2_sid[i->second.GetType()];
+			if (id == SID_NULL || id > SID_B) return false;
+		}
+
+		// Every other object must have the same components, they are sorted by ID so they can be compared in order
+		for (uint32_t r = 1u; r < rows; ++r) {
+			const Value& row = value.GetValue(r);
+			if (row.GetType() != TYPE_OBJECT || row.GetSize() != columns) return false;
+			Value::ComponentIterator j = row.GetComponentsBegin();
+			for (Value::ComponentIterator i = first.GetComponentsBegin(); i != first_end; ++i, ++j) {
+				if (j->first != i->first || j->second.GetType() != i->second.GetType()) return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Writer::WriteColumnarArray(const Value& value) {
+		const uint32_t rows = static_cast<uint32_t>(value.GetSize());
+		const Value& first = value.GetValue(0u);
+		const uint32_t column_count = static_cast<uint32_t>(first.GetSize());
+
+		std::vector<ComponentID> component_ids(column_count);
+		std::vector<Type> types(column_count);
+		std::vector<const void*> columns(column_count);
+		std::vector<uint8_t*> dst(column_count);
+		std::vector<uint32_t> element_bytes(column_count);
+
+		// Each column starts on an 8 byte boundary of the buffer
+		size_t words = 0u;
+		std::vector<size_t> offsets(column_count);
+		uint32_t c = 0u;
+		for (Value::ComponentIterator i = first.GetComponentsBegin(); i != first.GetComponentsEnd(); ++i, ++c) {
+			component_ids[c] = i->first;
+			types[c] = i->second.GetType();
+			element_bytes[c] = g_secondary_type_sizes[g_object_type_2_sid[types[c]]];
+			offsets[c] = words;
+			words += (static_cast<size_t>(element_bytes[c]) * rows + 7u) / 8u;
+		}
+		std::vector<uint64_t> buffer(words);
+		for (c = 0u; c < column_count; ++c) {
+			dst[c] = reinterpret_cast<uint8_t*>(buffer.data() + offsets[c]);
+			columns[c] = dst[c];
+		}
+
+		// Transpose the objects into the columns, each row is read once in component order
+		for (uint32_t r = 0u; r < rows; ++r) {
+			const Value& row = value.GetValue(r);
+			c = 0u;
+			for (Value::ComponentIterator i = row.GetComponentsBegin(); i != row.GetComponentsEnd(); ++i, ++c) {
+				const PrimativeValue tmp = i->second.GetPrimativeValue();
+				memcpy(dst[c], &tmp.u64, element_bytes[c]);
+				dst[c] += element_bytes[c];
+			}
+		}
+
+		OnColumnarArray(rows, column_count, component_ids.data(), types.data(), columns.data());
+	}
+
+	void Writer::OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src) {
+		ANVIL_CONTRACT(rank <= 255u, "Writer::OnPrimativeTensor : Rank must be <= 255");
+		const uint8_t id = g_object_type_2_sid[type];
+		ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Writer::OnPrimativeTensor : Type is not a primative");
+
+		// Check the size at every step so that large shapes cannot overflow
+		const uint32_t element_bytes = g_secondary_type_sizes[id];
+		uint64_t size = 1u;
+		for (uint32_t i = 0u; i < rank; ++i) {
+			ANVIL_CONTRACT(shape[i] == 0u || size <= UINT32_MAX / element_bytes / shape[i], "Writer::OnPrimativeTensor : Tensor is too large to write");
+			size *= shape[i];
+		}
+
+		// Align the values to 64 bytes from the start of the pipe
+		const uint64_t values_offset = _bytes_written + sizeof(ValueHeader::tensor_v1) + 1u + rank * sizeof(uint32_t);
+		const uint32_t padding = static_cast<uint32_t>((64u - (values_offset % 64u)) % 64u);
+
+		ValueHeader header;
+		header.primary_id = PID_TENSOR;
+		header.secondary_id = id;
+		header.tensor_v1.rank = static_cast<uint8_t>(rank);
+		header.tensor_v1.padding = static_cast<uint8_t>(padding);
+		Write(&header, sizeof(ValueHeader::tensor_v1) + 1u);
+
+		// Write the shape
+		if (_swap_byte_order) {
+			uint32_t swapped_shape[255u];
+			for (uint32_t i = 0u; i < rank; ++i) swapped_shape[i] = SwapByteOrder(shape[i]);
+			Write(swapped_shape, rank * sizeof(uint32_t));
+		} else {
+			Write(shape, rank * sizeof(uint32_t));
+		}
+
+		// Write the values
+		const uint8_t zeros[64u] = {};
+		Write(zeros, padding);
+		WritePrimatives(src, static_cast<uint32_t>(size), element_bytes);
+	}
+
+	static inline void SwapPrimativeByteOrder(PrimativeValue& value, const uint32_t bytes) {
+		switch (bytes) {
+		case 2u:
+			value.u16 = SwapByteOrder(value.u16);
+			break;
+		case 4u:
+			value.u32 = SwapByteOrder(value.u32);
+			break;
+		case 8u:
+			value.u64 = SwapByteOrder(value.u64);
+			break;
+		}
+	}
+
+	//! Used by EncodeValue, every value is encoded into the buffer
+	struct NoEncodeHook {
+		inline bool operator()(const Value&, uint8_t*&) const {
+			return false;
+		}
+	};
+
+	/*!
+		\param hook Called before each value is encoded, if it returns true then the hook has handled the value 
+		itself and dst is set to where encoding should continue.
+	*/
+	template<class HOOK>
+	static uint8_t* EncodeValueHelper(const Value& value, uint8_t* dst, const bool swap_byte_order, HOOK& hook) {
+		if (hook(value, dst)) return dst;
+		ValueHeader header;
+
+		switch (value.GetType()) {
+		case TYPE_STRING:
+			{
+				const uint32_t length = static_cast<uint32_t>(value.GetSize());
+				header.primary_id = PID_STRING;
+				header.secondary_id = SID_C8;
+				header.string_v1.length = length;
+				memcpy(dst, &header, sizeof(ValueHeader::string_v1) + 1u);
+				dst += sizeof(ValueHeader::string_v1) + 1u;
+				memcpy(dst, value.GetString(), length);
+				dst += length;
+			}
+			break;
+		case TYPE_ARRAY:
+			{
+				const uint32_t size = static_cast<uint32_t>(value.GetSize());
+				const Type element_type = value.GetArrayElementType();
+				header.primary_id = PID_ARRAY;
+				header.secondary_id = element_type == TYPE_NULL ? SID_NULL : g_object_type_2_sid[element_type];
+				header.array_v1.size = size;
+				memcpy(dst, &header, sizeof(ValueHeader::array_v1) + 1u);
+				dst += sizeof(ValueHeader::array_v1) + 1u;
+
+				if (element_type == TYPE_NULL) {
+					// Generic values
+					for (uint32_t i = 0u; i < size; ++i) dst = EncodeValueHelper(value.GetValue(i), dst, swap_byte_order, hook);
+				} else {
+					// Primative array, copy the values without headers
+					const uint32_t element_bytes = g_secondary_type_sizes[header.secondary_id];
+					for (uint32_t i = 0u; i < size; ++i) {
+						PrimativeValue tmp = value.GetValue(i).GetPrimativeValue();
+						if (swap_byte_order) SwapPrimativeByteOrder(tmp, element_bytes);
+						memcpy(dst, &tmp.u8, element_bytes);
+						dst += element_bytes;
+					}
+				}
+			}
+			break;
+		case TYPE_OBJECT:
+			{
+				const uint32_t size = static_cast<uint32_t>(value.GetSize());
+				header.primary_id = PID_OBJECT;
+				header.secondary_id = SID_NULL;
+				header.object_v1.components = size;
+				memcpy(dst, &header, sizeof(ValueHeader::object_v1) + 1u);
+				dst += sizeof(ValueHeader::object_v1) + 1u;
+
+				const Value::ComponentIterator end = value.GetComponentsEnd();
+				for (Value::ComponentIterator i = value.GetComponentsBegin(); i != end; ++i) {
+					memcpy(dst, &i->first, sizeof(ComponentID));
+					dst += sizeof(ComponentID);
+					dst = EncodeValueHelper(i->second, dst, swap_byte_order, hook);
+				}
+			}
+			break;
+		default:
+			{
+				PrimativeValue tmp = value.GetPrimativeValue();
+				const SecondaryID id = g_object_type_2_sid[tmp.type];
+				const uint32_t bytes = g_secondary_type_sizes[id];
+				if (swap_byte_order) SwapPrimativeByteOrder(tmp, bytes);
+
+				*dst = 0u;
+				reinterpret_cast<ValueHeader*>(dst)->primary_id = PID_PRIMATIVE;
+				reinterpret_cast<ValueHeader*>(dst)->secondary_id = id;
+				++dst;
+				memcpy(dst, &tmp.u8, bytes);
+				dst += bytes;
+			}
+			break;
+		}
+
+		return dst;
+	}
+
+	size_t EncodeValue(const Value& value, void* dst, const Endianness endianness) {
+		uint8_t* const begin = static_cast<uint8_t*>(dst);
+		NoEncodeHook hook;
+		uint8_t* const end = EncodeValueHelper(value, begin, endianness != GetEndianness(), hook);
+		return end - begin;
+	}
+
+	bool Writer::WriteValueThroughCallbacks(const Value& value, uint8_t*& dst, const size_t buffer_size) {
+		const Type type = value.GetType();
+		Type element_type = TYPE_NULL;
+		bool use_callbacks = false;
+		if (type == TYPE_STRING) {
+			use_callbacks = ! _string_table.empty() && value.GetSize() <= _string_table_max_length;
+		} else if (type == TYPE_ARRAY) {
+			element_type = value.GetArrayElementType();
+			if (element_type == TYPE_NULL) use_callbacks = _columnar_arrays && IsColumnarArray(value);
+			else use_callbacks = _f32_arrays_as_f16 || _sparse_arrays || _bit_packed_arrays || _xor_float_arrays;
+		}
+		if (! use_callbacks) return false;
+
+		// Write the bytes that have been encoded so far, the callbacks may use the value buffer
+		Write(_value_buffer.data(), static_cast<uint32_t>(dst - _value_buffer.data()));
+
+		if (type == TYPE_STRING) {
+			OnPrimativeString(value.GetString(), static_cast<uint32_t>(value.GetSize()));
+		} else if (element_type == TYPE_NULL) {
+			WriteColumnarArray(value);
+		} else {
+			// Copy the values into a primative array
+			const uint8_t id = g_object_type_2_sid[element_type];
+			const uint32_t element_bytes = g_secondary_type_sizes[id];
+			const uint32_t size = static_cast<uint32_t>(value.GetSize());
+			const size_t words = (static_cast<size_t>(size) * element_bytes + 7u) / 8u;
+			if (_array_values.size() < words) _array_values.resize(words);
+			uint8_t* const values = reinterpret_cast<uint8_t*>(_array_values.data());
+			for (uint32_t i = 0u; i < size; ++i) {
+				const PrimativeValue tmp = value.GetValue(i).GetPrimativeValue();
+				memcpy(values + static_cast<size_t>(i) * element_bytes, &tmp.u8, element_bytes);
+			}
+			(this->*g_primative_array_callbacks[id])(values, size);
+		}
+
+		// The callbacks may have resized the buffer, encoding continues from the start of it
+		if (_value_buffer.size() < buffer_size) _value_buffer.resize(buffer_size);
+		dst = _value_buffer.data();
+		return true;
+	}
+
+	void Writer::OnValue(const Value& value) {
+		// Encode the value into a buffer of the exact size and write it in one call
+		const size_t bytes = value.EncodedSize();
+		ANVIL_CONTRACT(bytes <= UINT32_MAX, "Writer::OnValue : Value is too large to write");
+		if (_value_buffer.size() < bytes) _value_buffer.resize(bytes);
+
+		const bool use_callbacks = _columnar_arrays || _f32_arrays_as_f16 || _sparse_arrays || _bit_packed_arrays || _xor_float_arrays || ! _string_table.empty();
+		if (use_callbacks) {
+			// Values that depend on the settings are found while encoding, the bytes before each one are written first
+			auto hook = [this, bytes](const Value& child, uint8_t*& dst)->bool {
+				return WriteValueThroughCallbacks(child, dst, bytes);
+			};
+			uint8_t* const end = EncodeValueHelper(value, _value_buffer.data(), _swap_byte_order, hook);
+			Write(_value_buffer.data(), static_cast<uint32_t>(end - _value_buffer.data()));
+		} else {
+			NoEncodeHook hook;
+			EncodeValueHelper(value, _value_buffer.data(), _swap_byte_order, hook);
+			Write(_value_buffer.data(), static_cast<uint32_t>(bytes));
+		}
+	}
+
 	// Reader
 
 	static inline void ReadFromPipe(InputPipe& pipe, void* dst, const uint32_t bytes) {
@@ -692,17 +1386,19 @@ namespace anvil { namespace BytePipe {
 	private:
 		InputPipe& _pipe;
 		Parser& _parser;
-		void* _mem;
-		uint32_t _mem_bytes;
+		std::pmr::vector<uint64_t>& _buffer;
+		std::pmr::vector<std::pmr::string>& _string_table;
+		std::pmr::vector<std::pmr::vector<ComponentID>>& _shapes;
 		bool _swap_byte_order;
 
 		void* AllocateMemory(const uint32_t bytes) {
-			if (_mem_bytes < bytes) {
-				if (_mem) operator delete(_mem);
-				_mem = operator new(bytes);
-				ANVIL_CONTRACT(_mem != nullptr, "Failed to allocate memory");
+			// The buffer belongs to the Reader so it is only reallocated when a larger value is read
+			const size_t words = bytes / sizeof(uint64_t) + 1u;
+			if (_buffer.size() < words) {
+				_buffer.clear();
+				_buffer.resize(words);
 			}
-			return _mem;
+			return _buffer.data();
 		}
 
 		void ReadObject() {
@@ -718,8 +1414,39 @@ namespace anvil { namespace BytePipe {
 			_parser.OnObjectEnd();
 		}
 
+		void ReadShapedObject() {
+			ReadFromPipe(_pipe, &header.object_shape_v1.shape, sizeof(header.object_shape_v1.shape));
+			const uint32_t shape = header.object_shape_v1.shape;
+
+			if (header.secondary_id == OSID_DEFINE) {
+				ReadFromPipe(_pipe, &header.object_shape_v1.components, sizeof(header.object_shape_v1.components));
+				if (_shapes.size() <= shape) _shapes.resize(shape + 1u);
+				std::pmr::vector<ComponentID>& ids = _shapes[shape];
+				ids.resize(header.object_shape_v1.components);
+				ReadFromPipe(_pipe, ids.data(), static_cast<uint32_t>(ids.size() * sizeof(ComponentID)));
+				_parser.OnObjectShape(shape, ids.data(), static_cast<uint32_t>(ids.size()));
+			} else {
+				ANVIL_CONTRACT(header.secondary_id == OSID_REFERENCE, "Unknown object subtype");
+				ANVIL_CONTRACT(shape < _shapes.size(), "Object shape has not been defined");
+			}
+
+			const uint32_t size = static_cast<uint32_t>(_shapes[shape].size());
+			_parser.OnShapedObjectBegin(shape, size);
+			for (uint32_t i = 0u; i < size; ++i) {
+				// The shape is looked up each time because a nested object could define another shape and reallocate the table
+				const std::pmr::vector<ComponentID>& ids = _shapes[shape];
+				ANVIL_CONTRACT(i < ids.size(), "Object shape was redefined while it was being used");
+				_parser.OnComponentID(ids[i]);
+				ReadFromPipe(_pipe, &header, 1u);
+				ReadGeneric();
+			}
+			_parser.OnObjectEnd();
+		}
+
 		inline void ReadPrimative() {
-			const uint32_t id = header.primary_id;
+			ANVIL_CONTRACT(header.primary_id == PID_PRIMATIVE, "Unknown primary type ID");
+			const uint32_t id = header.secondary_id;
+			ANVIL_CONTRACT(id <= SID_B, "Unknown secondary type ID");
 
 			// Read primative value
 			const uint32_t bytes = g_secondary_type_sizes[id];
@@ -748,7 +1475,10 @@ namespace anvil { namespace BytePipe {
 				_parser.OnNull();
 				break;
 			case PID_STRING:
-				ANVIL_CONTRACT(header.secondary_id == SID_C8, "String subtype was not char");
+				if (header.secondary_id != SID_C8) {
+					ReadStringTableEntry();
+					break;
+				}
 				ReadFromPipe(_pipe, &header.string_v1, sizeof(header.string_v1));
 				{
 					const uint32_t len = header.string_v1.length;
@@ -763,10 +1493,31 @@ namespace anvil { namespace BytePipe {
 				ReadArray();
 				break;
 			case PID_OBJECT:
+				if (header.secondary_id != SID_NULL) {
+					ReadShapedObject();
+					break;
+				}
 				ReadFromPipe(_pipe, &header.object_v1, sizeof(header.object_v1));
 				ReadObject();
 				break;
+			case PID_TENSOR:
+				ReadFromPipe(_pipe, &header.tensor_v1, sizeof(header.tensor_v1));
+				ReadTensor();
+				break;
+			case PID_SPARSE_ARRAY:
+				ReadFromPipe(_pipe, &header.sparse_array_v1, sizeof(header.sparse_array_v1));
+				ReadSparseArray();
+				break;
+			case PID_BIT_PACKED_ARRAY:
+				ReadFromPipe(_pipe, &header.bit_packed_array_v1, sizeof(header.bit_packed_array_v1));
+				ReadBitPackedArray();
+				break;
+			case PID_XOR_ARRAY:
+				ReadFromPipe(_pipe, &header.xor_array_v1, sizeof(header.xor_array_v1));
+				ReadXORArray();
+				break;
 			case PID_USER_POD:
+				ReadFromPipe(_pipe, &header.user_pod, sizeof(header.user_pod));
 				{
 					// Construct the user POD ID number
 					uint32_t id = header.user_pod.extended_secondary_id;
@@ -776,7 +1527,9 @@ namespace anvil { namespace BytePipe {
 					// Read the POD from the input pipe
 					void* mem = AllocateMemory(header.user_pod.bytes);
 					ReadFromPipe(_pipe, mem, header.user_pod.bytes);
-					//! \bug Doesn't know how to swap the byte order of a POD
+
+					// PODs that have not been registered are output without swapping their byte order
+					if (_swap_byte_order) SwapUserPODByteOrder(id, mem, mem, header.user_pod.bytes, 1u);
 
 					// Output the POD
 					_parser.OnUserPOD(id, header.user_pod.bytes, mem);
@@ -800,6 +1553,24 @@ namespace anvil { namespace BytePipe {
 				}
 				_parser.OnArrayEnd();
 
+			// The array contains user PODs of the same type
+			} else if (id == SID_COLUMNS) {
+				ReadColumnarArray();
+
+			// The array contains user PODs of the same type
+			} else if (id == SID_USER_POD) {
+				ReadFromPipe(_pipe, &header.user_pod_array.type, sizeof(header.user_pod_array) - sizeof(header.array_v1));
+				const uint32_t size = header.user_pod_array.size;
+				const uint32_t type = header.user_pod_array.type;
+				const uint32_t pod_bytes = header.user_pod_array.bytes;
+				const uint64_t bytes = static_cast<uint64_t>(pod_bytes) * size;
+				ANVIL_CONTRACT(bytes <= UINT32_MAX, "User POD array is too large");
+
+				void* buffer = AllocateMemory(static_cast<uint32_t>(bytes));
+				ReadFromPipe(_pipe, buffer, static_cast<uint32_t>(bytes));
+				if (_swap_byte_order) SwapUserPODByteOrder(type, buffer, buffer, pod_bytes, size);
+				_parser.OnUserPODArray(type, pod_bytes, buffer, size);
+
 			// The array contains primatives of the same type
 			} else {
 				ANVIL_CONTRACT(id <= SID_B, "Unknown secondary type ID");
@@ -807,43 +1578,240 @@ namespace anvil { namespace BytePipe {
 				const uint32_t size = header.array_v1.size;
 				const uint32_t element_bytes = g_secondary_type_sizes[id];
 				const uint32_t bytes = element_bytes * size;
-				void* buffer = buffer = AllocateMemory(bytes);
+
+				// Read directly into the parser's memory if it provides some
+				void* buffer = _parser.AcquireArrayBuffer(g_sid_2_object_type[id], size);
+				if (buffer == nullptr) buffer = AllocateMemory(bytes);
+
 				ReadFromPipe(_pipe, buffer, bytes);
-				if (_swap_byte_order && element_bytes > 1u) {
-					if (bytes == 2u) {
-						typedef uint16_t T;
-						T* buffer2 = static_cast<T*>(buffer);
-						for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(buffer2[i]);
-					} else if (bytes == 4u) {
-						typedef uint32_t T;
-						T* buffer2 = static_cast<T*>(buffer);
-						for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(buffer2[i]);
-					} else if (bytes == 8u) {
-						typedef uint64_t T;
-						T* buffer2 = static_cast<T*>(buffer);
-						for (uint32_t i = 0u; i < size; ++i) buffer2[i] = SwapByteOrder(buffer2[i]);
-					} else {
-						throw std::runtime_error("ReadHelper::ReadArray : Cannot swap byte order");
-					}
-				}
+				if (_swap_byte_order && element_bytes > 1u) SwapPrimativeArrayByteOrder(buffer, buffer, element_bytes, size);
 				(_parser.*g_primative_array_callbacks[id])(buffer, size);
 			}
 		}
+
+		void ReadColumnarArray() {
+			ReadFromPipe(_pipe, &header.columns_v1.columns, sizeof(header.columns_v1) - sizeof(header.columns_v1.rows));
+			const uint32_t rows = header.columns_v1.rows;
+			const uint32_t column_count = header.columns_v1.columns;
+			const uint32_t data_bytes = header.columns_v1.bytes;
+
+			// The buffer holds the component IDs, types, column addresses and then the columns, each starting on an 8 byte boundary
+			const size_t id_bytes = (column_count * sizeof(ComponentID) + 7u) & ~static_cast<size_t>(7u);
+			const size_t type_bytes = (column_count * sizeof(Type) + 7u) & ~static_cast<size_t>(7u);
+			const size_t pointer_bytes = column_count * sizeof(void*);
+			const size_t total_bytes = id_bytes + type_bytes + pointer_bytes + static_cast<size_t>(data_bytes) + column_count * 7u;
+			ANVIL_CONTRACT(total_bytes <= UINT32_MAX, "Columnar array is too large");
+			uint8_t* const buffer = static_cast<uint8_t*>(AllocateMemory(static_cast<uint32_t>(total_bytes)));
+			ComponentID* const component_ids = reinterpret_cast<ComponentID*>(buffer);
+			Type* const types = reinterpret_cast<Type*>(buffer + id_bytes);
+			const void** const columns = reinterpret_cast<const void**>(buffer + id_bytes + type_bytes);
+			uint8_t* data = buffer + id_bytes + type_bytes + pointer_bytes;
+
+			// Read the column descriptions, the types are read as secondary IDs and converted in place
+			ReadFromPipe(_pipe, component_ids, column_count * sizeof(ComponentID));
+			ReadFromPipe(_pipe, types, column_count);
+			uint64_t expected_bytes = 0u;
+			for (uint32_t i = 0u; i < column_count; ++i) {
+				const uint8_t id = types[i];
+				ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Unknown column type ID");
+				types[i] = g_sid_2_object_type[id];
+				expected_bytes += static_cast<uint64_t>(g_secondary_type_sizes[id]) * rows;
+			}
+			ANVIL_CONTRACT(expected_bytes == data_bytes, "Columnar array size does not match its columns");
+
+			// Read each column
+			for (uint32_t i = 0u; i < column_count; ++i) {
+				const uint32_t element_bytes = g_secondary_type_sizes[g_object_type_2_sid[types[i]]];
+				const uint32_t bytes = element_bytes * rows;
+				ReadFromPipe(_pipe, data, bytes);
+				if (_swap_byte_order && element_bytes > 1u) SwapPrimativeArrayByteOrder(data, data, element_bytes, rows);
+				columns[i] = data;
+				data += (bytes + 7u) & ~7u;
+			}
+
+			_parser.OnColumnarArray(rows, column_count, component_ids, types, columns);
+		}
+
+		void ReadTensor() {
+			const uint32_t id = header.secondary_id;
+			ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Unknown secondary type ID");
+			const Type type = g_sid_2_object_type[id];
+
+			// Read the shape
+			const uint32_t rank = header.tensor_v1.rank;
+			uint32_t shape[255u];
+			ReadFromPipe(_pipe, shape, rank * sizeof(uint32_t));
+			const uint32_t element_bytes = g_secondary_type_sizes[id];
+			uint64_t size = 1u;
+			for (uint32_t i = 0u; i < rank; ++i) {
+				if (_swap_byte_order) shape[i] = SwapByteOrder(shape[i]);
+				ANVIL_CONTRACT(shape[i] == 0u || size <= UINT32_MAX / element_bytes / shape[i], "Tensor is too large");
+				size *= shape[i];
+			}
+			const uint32_t bytes = static_cast<uint32_t>(size * element_bytes);
+
+			// Skip the padding
+			uint8_t padding[64u];
+			ANVIL_CONTRACT(header.tensor_v1.padding < 64u, "Tensor padding is too large");
+			ReadFromPipe(_pipe, padding, header.tensor_v1.padding);
+
+			// Use the values in the pipe's memory if they don't need to be modified
+			const void* src = nullptr;
+			const bool swap = _swap_byte_order && element_bytes > 1u;
+			if (! swap) src = _pipe.ReadBytesZeroCopy(bytes);
+
+			if (src == nullptr) {
+				void* buffer = _parser.AcquireArrayBuffer(type, static_cast<uint32_t>(size));
+				if (buffer == nullptr) buffer = AllocateMemory(bytes);
+				ReadFromPipe(_pipe, buffer, bytes);
+				if (swap) SwapPrimativeArrayByteOrder(buffer, buffer, element_bytes, static_cast<uint32_t>(size));
+				src = buffer;
+			}
+
+			_parser.OnPrimativeTensor(type, rank, shape, src);
+		}
+
+		void ReadStringTableEntry() {
+			ReadFromPipe(_pipe, &header.string_table_v1.entry, sizeof(header.string_table_v1.entry));
+			const uint32_t entry = header.string_table_v1.entry;
+
+			if (header.secondary_id == STID_DEFINE) {
+				ReadFromPipe(_pipe, &header.string_table_v1.length, sizeof(header.string_table_v1.length));
+				if (_string_table.size() <= entry) _string_table.resize(entry + 1u);
+
+				// The string keeps its capacity when the entry is replaced, so entries stop allocating once they have held a long enough string
+				std::pmr::string& str = _string_table[entry];
+				str.resize(header.string_table_v1.length);
+				ReadFromPipe(_pipe, &str[0u], header.string_table_v1.length);
+				_parser.OnPrimativeString(str.c_str(), static_cast<uint32_t>(str.size()));
+
+			} else if (header.secondary_id == STID_REFERENCE) {
+				ANVIL_CONTRACT(entry < _string_table.size(), "String table entry has not been defined");
+				const std::pmr::string& str = _string_table[entry];
+				_parser.OnPrimativeString(str.c_str(), static_cast<uint32_t>(str.size()));
+
+			} else {
+				throw std::runtime_error("ReadHelper::ReadStringTableEntry : String subtype was not char");
+			}
+		}
+
+		void ReadSparseArray() {
+			const uint32_t id = header.secondary_id;
+			ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Unknown secondary type ID");
+			const uint32_t size = header.sparse_array_v1.size;
+			const uint32_t count = header.sparse_array_v1.count;
+			const uint32_t encoding = header.sparse_array_v1.encoding;
+			ANVIL_CONTRACT(count <= size, "Sparse array contains more values than its size");
+			ANVIL_CONTRACT(encoding == SPARSE_INDICES || encoding == SPARSE_BITMAP, "Unknown sparse array encoding");
+
+			// The indices, values and bitmap are stored one after another in the buffer, each starting on an 8 byte boundary
+			const uint32_t element_bytes = g_secondary_type_sizes[id];
+			const uint64_t index_bytes = (static_cast<uint64_t>(count) * sizeof(uint32_t) + 7u) & ~static_cast<uint64_t>(7u);
+			const uint64_t value_bytes = (static_cast<uint64_t>(count) * element_bytes + 7u) & ~static_cast<uint64_t>(7u);
+			const uint64_t bitmap_bytes = encoding == SPARSE_BITMAP ? (static_cast<uint64_t>(size) + 7u) / 8u : 0u;
+			ANVIL_CONTRACT(index_bytes + value_bytes + bitmap_bytes <= UINT32_MAX, "Sparse array is too large");
+			uint8_t* const buffer = static_cast<uint8_t*>(AllocateMemory(static_cast<uint32_t>(index_bytes + value_bytes + bitmap_bytes)));
+			uint32_t* const indices = reinterpret_cast<uint32_t*>(buffer);
+			void* const values = buffer + index_bytes;
+
+			// Read the indices
+			if (encoding == SPARSE_BITMAP) {
+				uint8_t* const bitmap = buffer + index_bytes + value_bytes;
+				ReadFromPipe(_pipe, bitmap, static_cast<uint32_t>(bitmap_bytes));
+				ANVIL_CONTRACT(BitmapToIndices(bitmap, size, indices, count) == count, "Sparse array bitmap does not match the number of values");
+			} else {
+				ReadFromPipe(_pipe, indices, count * sizeof(uint32_t));
+				if (_swap_byte_order) SwapPrimativeArrayByteOrder(indices, indices, sizeof(uint32_t), count);
+
+				// Parsers are allowed to rely on the indices being valid
+				uint32_t next = 0u;
+				for (uint32_t i = 0u; i < count; ++i) {
+					ANVIL_CONTRACT(indices[i] >= next && indices[i] < size, "Sparse array indices are out of order or out of range");
+					next = indices[i] + 1u;
+				}
+			}
+
+			// Read the values
+			ReadFromPipe(_pipe, values, count * element_bytes);
+			if (_swap_byte_order && element_bytes > 1u) SwapPrimativeArrayByteOrder(values, values, element_bytes, count);
+
+			_parser.OnPrimativeSparseArray(g_sid_2_object_type[id], size, indices, values, count);
+		}
+
+		void ReadBitPackedArray() {
+			const uint32_t id = header.secondary_id;
+			ANVIL_CONTRACT(id == SID_U32 || id == SID_S32 || id == SID_U64 || id == SID_S64, "Bit packed arrays only support 32 and 64-bit integers");
+			const Type type = g_sid_2_object_type[id];
+			const uint32_t size = header.bit_packed_array_v1.size;
+			const uint32_t packed_bytes = header.bit_packed_array_v1.bytes;
+			const uint64_t bytes = static_cast<uint64_t>(g_secondary_type_sizes[id]) * size;
+			ANVIL_CONTRACT(bytes <= UINT32_MAX, "Bit packed array is too large");
+
+			// The packed blocks are used in the pipe's memory if they don't need to be modified
+			const void* src = nullptr;
+			if (! _swap_byte_order) src = _pipe.ReadBytesZeroCopy(packed_bytes);
+
+			// Unpack directly into the parser's memory if it provides some, otherwise the values are stored before the packed blocks
+			void* buffer = _parser.AcquireArrayBuffer(type, size);
+			if (src == nullptr) {
+				const uint64_t value_bytes = buffer == nullptr ? (bytes + 7u) & ~static_cast<uint64_t>(7u) : 0u;
+				ANVIL_CONTRACT(value_bytes + packed_bytes <= UINT32_MAX, "Bit packed array is too large");
+				uint8_t* const packed = static_cast<uint8_t*>(AllocateMemory(static_cast<uint32_t>(value_bytes + packed_bytes))) + value_bytes;
+				if (buffer == nullptr) buffer = packed - value_bytes;
+				ReadFromPipe(_pipe, packed, packed_bytes);
+				if (_swap_byte_order) SwapBitPackedByteOrder(packed, packed_bytes, type, size);
+				src = packed;
+			} else if (buffer == nullptr) {
+				buffer = AllocateMemory(static_cast<uint32_t>(bytes));
+			}
+
+			BitUnpackIntegers(src, packed_bytes, type, size, buffer);
+			(_parser.*g_primative_array_callbacks[id])(buffer, size);
+		}
+
+		void ReadXORArray() {
+			const uint32_t id = header.secondary_id;
+			ANVIL_CONTRACT(id == SID_F32 || id == SID_F64, "XOR compressed arrays only support 32 and 64-bit floating point values");
+			const Type type = g_sid_2_object_type[id];
+			const uint32_t size = header.xor_array_v1.size;
+			const uint32_t words = header.xor_array_v1.words;
+			const uint64_t bytes = static_cast<uint64_t>(g_secondary_type_sizes[id]) * size;
+			const uint64_t word_bytes = static_cast<uint64_t>(words) * sizeof(uint64_t);
+			ANVIL_CONTRACT(bytes <= UINT32_MAX && word_bytes <= UINT32_MAX, "XOR compressed array is too large");
+
+			// The compressed words are used in the pipe's memory if they don't need to be modified
+			const void* src = nullptr;
+			if (! _swap_byte_order) src = _pipe.ReadBytesZeroCopy(static_cast<uint32_t>(word_bytes));
+
+			// Decompress directly into the parser's memory if it provides some, otherwise the values are stored before the compressed words
+			void* buffer = _parser.AcquireArrayBuffer(type, size);
+			if (src == nullptr) {
+				const uint64_t value_bytes = buffer == nullptr ? (bytes + 7u) & ~static_cast<uint64_t>(7u) : 0u;
+				ANVIL_CONTRACT(value_bytes + word_bytes <= UINT32_MAX, "XOR compressed array is too large");
+				uint8_t* const compressed = static_cast<uint8_t*>(AllocateMemory(static_cast<uint32_t>(value_bytes + word_bytes))) + value_bytes;
+				if (buffer == nullptr) buffer = compressed - value_bytes;
+				ReadFromPipe(_pipe, compressed, static_cast<uint32_t>(word_bytes));
+				if (_swap_byte_order) SwapPrimativeArrayByteOrder(compressed, compressed, sizeof(uint64_t), words);
+				src = compressed;
+			} else if (buffer == nullptr) {
+				buffer = AllocateMemory(static_cast<uint32_t>(bytes));
+			}
+
+			XORDecompressFloats(src, words, type, size, buffer);
+			(_parser.*g_primative_array_callbacks[id])(buffer, size);
+		}
 	public:
 		ValueHeader header;
 
-		ReadHelper(InputPipe& pipe, Parser& parser, Version version, const bool swap_byte_order) :
+		ReadHelper(InputPipe& pipe, Parser& parser, std::pmr::vector<uint64_t>& buffer, std::pmr::vector<std::pmr::string>& string_table, std::pmr::vector<std::pmr::vector<ComponentID>>& shapes, Version version, const bool swap_byte_order) :
 			_pipe(pipe),
 			_parser(parser),
-			_mem(nullptr),
-			_mem_bytes(0u),
+			_buffer(buffer),
+			_string_table(string_table),
+			_shapes(shapes),
 			_swap_byte_order(swap_byte_order)
 		{}
 
-		~ReadHelper() {
-			if (_mem) operator delete(_mem);
-		}
-
 		void Read() {
 			// Continue with read
 			ReadFromPipe(_pipe, &header.id_union, 1u);
@@ -858,6 +1826,13 @@ namespace anvil { namespace BytePipe {
 		_pipe(pipe)
 	{}
 
+	Reader::Reader(InputPipe& pipe, std::pmr::memory_resource* resource) :
+		_pipe(pipe),
+		_buffer(resource),
+		_string_table(resource),
+		_shapes(resource)
+	{}
+
 	Reader::~Reader() {
 
 	}
@@ -892,15 +1867,24 @@ namespace anvil { namespace BytePipe {
 
 
 		// Select correct reader for pipe version
-		ReadHelper helper(_pipe, dst, static_cast<Version>(header_v1.version), swap_byte_order);
+		// Each pipe has its own string table, the strings are cleared without releasing their memory
+		for (std::pmr::string& str : _string_table) str.clear();
+		for (std::pmr::vector<ComponentID>& shape : _shapes) shape.clear();
+
+		ReadHelper helper(_pipe, dst, _buffer, _string_table, _shapes, static_cast<Version>(header_v1.version), swap_byte_order);
 		helper.Read();
 	}
 
 	// ValueParser
 
-	ValueParser::ValueParser() {
-		
-	}
+	ValueParser::ValueParser() :
+		ValueParser(std::pmr::get_default_resource())
+	{}
+
+	ValueParser::ValueParser(std::pmr::memory_resource* resource) :
+		_resource(resource),
+		_value_stack(resource)
+	{}
 
 	ValueParser::~ValueParser() {
 		
@@ -921,23 +1905,25 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void ValueParser::OnArrayBegin(const uint32_t size) {
-		Value& val = NextValue();
-		val.SetArray();
-		_value_stack.push_back(&val);
+		_value_stack.emplace_back();
+		Container& container = _value_stack.back();
+		container.value.SetArray(_resource);
+		container.id = _component_id;
 	}
 
 	void ValueParser::OnArrayEnd() {
-		_value_stack.pop_back();
+		EndContainer();
 	}
 
 	void ValueParser::OnObjectBegin(const uint32_t component_count) {
-		Value& val = NextValue();
-		val.SetObject();
-		_value_stack.push_back(&val);
+		_value_stack.emplace_back();
+		Container& container = _value_stack.back();
+		container.value.SetObject(_resource);
+		container.id = _component_id;
 	}
 
 	void ValueParser::OnObjectEnd() {
-		_value_stack.pop_back();
+		EndContainer();
 	}
 
 	void ValueParser::OnComponentID(const ComponentID id) {
@@ -949,101 +1935,117 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void ValueParser::OnNull() {
-		NextValue().SetNull();
+		AddValue(Value());
 	}
 
 	void ValueParser::OnPrimativeF64(const double value) {
-		NextValue().SetF64(value);
+		Value tmp;
+		tmp.SetF64(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeString(const char* value, const uint32_t length) {
-		// Zero terminate string
-		char* str = static_cast<char*>(operator new(length + 1));
-		memcpy(str, value, length);
-		str[length] = '\0';
-
-		try {
-			Value& val = NextValue();
-			val.SetString(str);
-		} catch (...) {
-			operator delete(str);
-			std::rethrow_exception(std::current_exception());
-		}
-		operator delete(str);
+		Value tmp;
+		tmp.SetString(value, length, _resource);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeC8(const char value) {
-		NextValue().SetC8(value);
+		Value tmp;
+		tmp.SetC8(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeU64(const uint64_t value) {
-		NextValue().SetU64(value);
+		Value tmp;
+		tmp.SetU64(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeS64(const int64_t value) {
-		NextValue().SetS64(value);
+		Value tmp;
+		tmp.SetS64(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeF32(const float value) {
-		NextValue().SetF32(value);
+		Value tmp;
+		tmp.SetF32(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeU8(const uint8_t value) {
-		NextValue().SetU8(value);
+		Value tmp;
+		tmp.SetU8(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeU16(const uint16_t value) {
-		NextValue().SetU16(value);
+		Value tmp;
+		tmp.SetU16(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeU32(const uint32_t value) {
-		NextValue().SetU32(value);
+		Value tmp;
+		tmp.SetU32(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeS8(const int8_t value) {
-		NextValue().SetS8(value);
+		Value tmp;
+		tmp.SetS8(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeS16(const int16_t value) {
-		NextValue().SetS16(value);
+		Value tmp;
+		tmp.SetS16(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeS32(const int32_t value) {
-		NextValue().SetS32(value);
+		Value tmp;
+		tmp.SetS32(value);
+		AddValue(std::move(tmp));
 	}
 
 	void ValueParser::OnPrimativeF16(const half value) {
-		NextValue().SetF16(value);
+		Value tmp;
+		tmp.SetF16(value);
+		AddValue(std::move(tmp));
 	}
 
-	void ValueParser::OnPrimativeBool(const bool value) {
-		NextValue().SetBool(value);
+	void ValueParser::OnPrimativeArrayF16(const half* src, const uint32_t size) {
+		// Keep the values as 16-bit floating point instead of converting them
+		OnArrayBegin(size);
+		for (uint32_t i = 0u; i < size; ++i) OnPrimativeF16(src[i]);
+		OnArrayEnd();
 	}
 
-	Value& ValueParser::CurrentValue() {
-		return _value_stack.empty() ? _root : *_value_stack.back();
+	void ValueParser::OnPrimativeBool(const bool value) {
+		Value tmp;
+		tmp.SetBool(value);
+		AddValue(std::move(tmp));
 	}
 
-	Value& ValueParser::NextValue() {
-		Value& val = CurrentValue();
-		switch (val.GetType()) {
-		case TYPE_ARRAY:
-			{
-				Value tmp;
-				val.AddValue(std::move(tmp));
-				return val.GetValue(val.GetSize() - 1);
-			}
-			break;
-		case TYPE_OBJECT:
-			{
-				Value tmp;
-				val.AddValue(_component_id, std::move(tmp));
-				return val.GetValue(_component_id);
-			}
-			break;
-		default:
-			return val;
+	void ValueParser::AddValue(Value&& value) {
+		if (_value_stack.empty()) {
+			_root = std::move(value);
+			return;
 		}
+
+		// The value is complete when it is added, so the parent's cached size is updated correctly
+		Value& parent = _value_stack.back().value;
+		if (parent.GetType() == TYPE_ARRAY) parent.AddValue(std::move(value));
+		else parent.AddValue(_component_id, std::move(value));
+	}
+
+	void ValueParser::EndContainer() {
+		Value tmp(std::move(_value_stack.back().value));
+		_component_id = _value_stack.back().id;
+		_value_stack.pop_back();
+		AddValue(std::move(tmp));
 	}
 
 	// Parser
@@ -1052,8 +2054,8 @@ namespace anvil { namespace BytePipe {
 		switch (value.GetType()) {
 		case TYPE_STRING:
 			{
-				const char* str = const_cast<Value&>(value).GetString();
-				OnPrimativeString(str, strlen(str));
+				const char* str = value.GetString();
+				OnPrimativeString(str, static_cast<uint32_t>(value.GetSize()));
 			}
 			break;
 		case TYPE_ARRAY:
@@ -1061,7 +2063,7 @@ namespace anvil { namespace BytePipe {
 				const size_t size = value.GetSize();
 				OnArrayBegin(size);
 				for (size_t i = 0u; i < size; ++i) {
-					OnValue(const_cast<Value&>(value).GetValue(i));
+					OnValue(value.GetValue(i));
 				}
 				OnArrayEnd();
 			}
@@ -1070,10 +2072,10 @@ namespace anvil { namespace BytePipe {
 			{
 				const size_t size = value.GetSize();
 				OnObjectBegin(size);
-				for (size_t i = 0u; i < size; ++i) {
-					const ComponentID id = value.GetComponentID(i);
-					OnComponentID(id);
-					OnValue(const_cast<Value&>(value).GetValue(id));
+				const Value::ComponentIterator end = value.GetComponentsEnd();
+				for (Value::ComponentIterator i = value.GetComponentsBegin(); i != end; ++i) {
+					OnComponentID(i->first);
+					OnValue(i->second);
 				}
 				OnObjectEnd();
 			}
@@ -1084,10 +2086,122 @@ namespace anvil { namespace BytePipe {
 		}
 	}
 
+	void Parser::OnPrimativeArrayF16(const half* src, const uint32_t size) {
+		if (_f16_buffer.size() < size) _f16_buffer.resize(size);
+		HalfToFloat(src, _f16_buffer.data(), size);
+		OnPrimativeArrayF32(_f16_buffer.data(), size);
+	}
+
 	void Parser::OnValue(const PrimativeValue& value) {
 		const SecondaryID id = g_object_type_2_sid[value.type];
 		ANVIL_CONTRACT(id <= SID_B, "PrimativeCallbackHelper : Unknown primative type");
 		g_primative_callbacks[id](*this, value);
 	}
 
+	void Parser::OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src) {
+		const SecondaryID id = g_object_type_2_sid[type];
+		ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Parser::OnPrimativeTensor : Unknown primative type");
+		const uint32_t element_bytes = g_secondary_type_sizes[id];
+
+		// A tensor with no dimensions is a single value
+		if (rank == 0u) {
+			PrimativeValue value(type, 0u);
+			memcpy(&value.u64, src, element_bytes);
+			OnValue(value);
+			return;
+		}
+
+		// The last dimension is output as an array
+		if (rank == 1u) {
+			(this->*g_primative_array_callbacks[id])(src, shape[0u]);
+			return;
+		}
+
+		// Output each slice of the first dimension as a nested array
+		uint64_t slice_bytes = element_bytes;
+		for (uint32_t i = 1u; i < rank; ++i) slice_bytes *= shape[i];
+
+		OnArrayBegin(shape[0u]);
+		for (uint32_t i = 0u; i < shape[0u]; ++i) {
+			OnPrimativeTensor(type, rank - 1u, shape + 1u, static_cast<const uint8_t*>(src) + slice_bytes * i);
+		}
+		OnArrayEnd();
+	}
+
+	void Parser::OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns) {
+		OnArrayBegin(rows);
+		for (uint32_t r = 0u; r < rows; ++r) {
+			OnObjectBegin(column_count);
+			for (uint32_t i = 0u; i < column_count; ++i) {
+				const SecondaryID id = g_object_type_2_sid[types[i]];
+				ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Parser::OnColumnarArray : Unknown primative type");
+				const uint32_t element_bytes = g_secondary_type_sizes[id];
+
+				PrimativeValue value(types[i], 0u);
+				memcpy(&value.u64, static_cast<const uint8_t*>(columns[i]) + static_cast<size_t>(r) * element_bytes, element_bytes);
+				OnComponentID(component_ids[i]);
+				OnValue(value);
+			}
+			OnObjectEnd();
+		}
+		OnArrayEnd();
+	}
+
+	void Parser::OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count) {
+		const SecondaryID id = g_object_type_2_sid[type];
+		ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Parser::OnPrimativeSparseArray : Unknown primative type");
+		const uint32_t element_bytes = g_secondary_type_sizes[id];
+
+		// Expand the values into the dense array
+		void* dst = AcquireArrayBuffer(type, size);
+		if (dst == nullptr) {
+			const size_t words = (static_cast<size_t>(size) * element_bytes) / sizeof(uint64_t) + 1u;
+			if (_sparse_buffer.size() < words) _sparse_buffer.resize(words);
+			dst = _sparse_buffer.data();
+		}
+		ScatterSparseValues(indices, values, element_bytes, count, dst, size);
+
+		(this->*g_primative_array_callbacks[id])(dst, size);
+	}
+
+	void Parser::OnPrimativeTensorStrided(const Type type, const uint32_t rank, const uint32_t* shape, const ptrdiff_t* strides, const void* src) {
+		const SecondaryID id = g_object_type_2_sid[type];
+		ANVIL_CONTRACT(id != SID_NULL && id <= SID_B, "Parser::OnPrimativeTensorStrided : Unknown primative type");
+		const uint32_t element_bytes = g_secondary_type_sizes[id];
+
+		// Check if the values are already contiguous
+		uint64_t size = 1u;
+		bool contiguous = true;
+		for (uint32_t i = rank; i > 0u; --i) {
+			if (shape[i - 1u] > 1u && strides[i - 1u] != static_cast<ptrdiff_t>(size * element_bytes)) contiguous = false;
+			size *= shape[i - 1u];
+		}
+
+		if (contiguous) {
+			OnPrimativeTensor(type, rank, shape, src);
+			return;
+		}
+
+		// Copy the values into a contiguous buffer, iterating over the index of each dimension
+		std::vector<uint64_t> buffer(static_cast<size_t>((size * element_bytes) / sizeof(uint64_t) + 1u));
+		std::vector<uint32_t> index(rank, 0u);
+		uint8_t* dst = reinterpret_cast<uint8_t*>(buffer.data());
+		const uint8_t* value = static_cast<const uint8_t*>(src);
+		for (uint64_t i = 0u; i < size; ++i) {
+			memcpy(dst, value, element_bytes);
+			dst += element_bytes;
+
+			// Move to the next index
+			for (uint32_t d = rank; d > 0u; --d) {
+				const uint32_t j = d - 1u;
+				value += strides[j];
+				if (++index[j] < shape[j]) break;
+				value -= strides[j] * static_cast<ptrdiff_t>(shape[j]);
+				index[j] = 0u;
+			}
+		}
+
+		OnPrimativeTensor(type, rank, shape, buffer.data());
+	}
+
 }}
\ No newline at end of file
@@ -0,0 +1,438 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/byte-pipe/BytePipeBase64.hpp"
+
+#if ANVIL_BYTEPIPE_SSSE3 || ANVIL_BYTEPIPE_AVX2
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	static ANVIL_CONSTEXPR const char g_hex_alphabet[17] = "0123456789ABCDEF";
+	static ANVIL_CONSTEXPR const char g_base64_alphabet[65] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	enum : uint32_t {
+		INVALID_CHARACTER = 255u
+	};
+
+	static inline uint32_t DecodeHexCharacter(const char c) {
+		if (c >= '0' && c <= '9') return static_cast<uint32_t>(c - '0');
+		if (c >= 'A' && c <= 'F') return static_cast<uint32_t>(c - 'A') + 10u;
+		if (c >= 'a' && c <= 'f') return static_cast<uint32_t>(c - 'a') + 10u;
+		return INVALID_CHARACTER;
+	}
+
+	static inline uint32_t DecodeBase64Character(const char c) {
+		if (c >= 'A' && c <= 'Z') return static_cast<uint32_t>(c - 'A');
+		if (c >= 'a' && c <= 'z') return static_cast<uint32_t>(c - 'a') + 26u;
+		if (c >= '0' && c <= '9') return static_cast<uint32_t>(c - '0') + 52u;
+		if (c == '+') return 62u;
+		if (c == '/') return 63u;
+		return INVALID_CHARACTER;
+	}
+
+	// SIMD kernels, each one processes as many whole blocks as it can and returns the number of bytes or characters consumed
+
+#if ANVIL_BYTEPIPE_SSSE3 || ANVIL_BYTEPIPE_AVX2
+	// Convert 16 bytes into 32 hexidecimal characters
+	static inline void EncodeHexSSSE3(const __m128i in, __m128i& out_lo, __m128i& out_hi) {
+		const __m128i alphabet = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g_hex_alphabet));
+		const __m128i mask = _mm_set1_epi8(15);
+		const __m128i hi = _mm_shuffle_epi8(alphabet, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+		const __m128i lo = _mm_shuffle_epi8(alphabet, _mm_and_si128(in, mask));
+		out_lo = _mm_unpacklo_epi8(hi, lo);
+		out_hi = _mm_unpackhi_epi8(hi, lo);
+	}
+
+	// Convert 16 hexidecimal characters into nybbles, returns false if a character is invalid
+	static inline bool DecodeHexCharactersSSSE3(const __m128i in, __m128i& out) {
+		const __m128i digit = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+		const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+		const __m128i letter = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+		out = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+		return _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) == 0xFFFF;
+	}
+
+	// Combine pairs of nybbles into bytes, the result is in the low 8 bits of each 16 bit word
+	static inline __m128i CombineNybblesSSSE3(const __m128i nybbles) {
+		return _mm_maddubs_epi16(nybbles, _mm_set1_epi16(0x0110));
+	}
+
+	// Convert 12 bytes (loaded as 16) into 16 base64 characters
+	static inline __m128i EncodeBase64SSSE3(__m128i in) {
+		// Move each group of 3 bytes into a 32 bit word, then move each 6 bit index into its own byte
+		in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+		const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+		const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+		const __m128i indices = _mm_or_si128(t0, t1);
+
+		// Find the offset from each index to its character
+		__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+		const __m128i offsets = _mm_setr_epi8(
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+		);
+		return _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+	}
+
+	// Convert 16 base64 characters into 6 bit values, returns false if a character is invalid or padding
+	static inline bool DecodeBase64CharactersSSSE3(const __m128i in, __m128i& out) {
+		const __m128i hi_nybbles = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(15));
+		const __m128i lo_nybbles = _mm_and_si128(in, _mm_set1_epi8(15));
+
+		// Each character is valid if its high and low nybbles do not share a bit in these tables
+		const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo_nybbles), _mm_shuffle_epi8(lut_hi, hi_nybbles));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xFFFF) return false;
+
+		const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i is_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+		out = _mm_add_epi8(in, _mm_shuffle_epi8(lut_roll, _mm_add_epi8(is_slash, hi_nybbles)));
+		return true;
+	}
+
+	// Pack 16 6 bit values into 12 bytes, stored in the low bytes of the result
+	static inline __m128i PackBase64SSSE3(const __m128i values) {
+		const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		const __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+		return _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	}
+#endif
+
+	static size_t EncodeHexSIMD(const uint8_t* src, const size_t bytes, char* dst) {
+		size_t i = 0u;
+#if ANVIL_BYTEPIPE_AVX2
+		for (; i + 32u <= bytes; i += 32u) {
+			const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i alphabet = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(g_hex_alphabet)));
+			const __m256i mask = _mm256_set1_epi8(15);
+			const __m256i hi = _mm256_shuffle_epi8(alphabet, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+			const __m256i lo = _mm256_shuffle_epi8(alphabet, _mm256_and_si256(in, mask));
+
+			// Unpacking works within each 128 bit lane, so the lanes need to be reordered
+			const __m256i a = _mm256_unpacklo_epi8(hi, lo);
+			const __m256i b = _mm256_unpackhi_epi8(hi, lo);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2u), _mm256_permute2x128_si256(a, b, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2u + 32u), _mm256_permute2x128_si256(a, b, 0x31));
+		}
+#endif
+#if ANVIL_BYTEPIPE_SSSE3
+		for (; i + 16u <= bytes; i += 16u) {
+			__m128i lo, hi;
+			EncodeHexSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), lo, hi);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2u), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2u + 16u), hi);
+		}
+#endif
+		return i;
+	}
+
+	static size_t DecodeHexSIMD(const char* src, const size_t chars, uint8_t* dst) {
+		size_t i = 0u;
+#if ANVIL_BYTEPIPE_SSSE3
+		for (; i + 32u <= chars; i += 32u) {
+			__m128i a, b;
+			if (! DecodeHexCharactersSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), a)) break;
+			if (! DecodeHexCharactersSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16u)), b)) break;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 2u), _mm_packus_epi16(CombineNybblesSSSE3(a), CombineNybblesSSSE3(b)));
+		}
+#endif
+		return i;
+	}
+
+	static size_t EncodeBase64SIMD(const uint8_t* src, const size_t bytes, char* dst) {
+		size_t i = 0u;
+		size_t o = 0u;
+#if ANVIL_BYTEPIPE_AVX2
+		// Each lane loads 16 bytes but only uses 12 of them, so 4 extra bytes must be readable
+		for (; i + 28u <= bytes; i += 24u, o += 32u) {
+			const __m128i lo = EncodeBase64SSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+			const __m128i hi = EncodeBase64SSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12u)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + o), _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1));
+		}
+#endif
+#if ANVIL_BYTEPIPE_SSSE3
+		for (; i + 16u <= bytes; i += 12u, o += 16u) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), EncodeBase64SSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+		}
+#endif
+		return i;
+	}
+
+	static size_t DecodeBase64SIMD(const char* src, const size_t chars, uint8_t* dst) {
+		size_t i = 0u;
+		size_t o = 0u;
+#if ANVIL_BYTEPIPE_AVX2
+		// Each block writes 32 bytes but only 24 are used, so only process blocks that leave space after them
+		for (; i + 48u <= chars; i += 32u, o += 24u) {
+			__m128i a, b;
+			if (! DecodeBase64CharactersSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), a)) break;
+			if (! DecodeBase64CharactersSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16u)), b)) break;
+			const __m256i packed = _mm256_inserti128_si256(_mm256_castsi128_si256(PackBase64SSSE3(a)), PackBase64SSSE3(b), 1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + o), _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7)));
+		}
+#endif
+#if ANVIL_BYTEPIPE_SSSE3
+		// Each block writes 16 bytes but only 12 are used
+		for (; i + 24u <= chars; i += 16u, o += 12u) {
+			__m128i values;
+			if (! DecodeBase64CharactersSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), values)) break;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), PackBase64SSSE3(values));
+		}
+#endif
+		return i;
+	}
+
+	// Hexidecimal
+
+	size_t EncodeHex(const void* src, const size_t bytes, char* dst) {
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+
+		for (size_t i = EncodeHexSIMD(src8, bytes, dst); i < bytes; ++i) {
+			dst[i * 2u] = g_hex_alphabet[src8[i] >> 4u];
+			dst[i * 2u + 1u] = g_hex_alphabet[src8[i] & 15u];
+		}
+
+		return bytes * 2u;
+	}
+
+	size_t DecodeHex(const char* src, const size_t chars, void* dst) {
+		if ((chars & 1u) != 0u) throw std::runtime_error("DecodeHex : Number of characters is not divisible by 2");
+		uint8_t* const dst8 = static_cast<uint8_t*>(dst);
+
+		for (size_t i = DecodeHexSIMD(src, chars, dst8); i < chars; i += 2u) {
+			const uint32_t hi = DecodeHexCharacter(src[i]);
+			const uint32_t lo = DecodeHexCharacter(src[i + 1u]);
+			if (hi == INVALID_CHARACTER || lo == INVALID_CHARACTER) throw std::runtime_error("DecodeHex : Invalid hexidecimal character");
+			dst8[i / 2u] = static_cast<uint8_t>((hi << 4u) | lo);
+		}
+
+		return chars / 2u;
+	}
+
+	// Base64
+
+	size_t EncodeBase64(const void* src, const size_t bytes, char* dst) {
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+
+		size_t i = EncodeBase64SIMD(src8, bytes, dst);
+		char* out = dst + (i / 3u) * 4u;
+
+		for (; i + 3u <= bytes; i += 3u) {
+			const uint32_t group = (static_cast<uint32_t>(src8[i]) << 16u) | (static_cast<uint32_t>(src8[i + 1u]) << 8u) | static_cast<uint32_t>(src8[i + 2u]);
+			out[0u] = g_base64_alphabet[group >> 18u];
+			out[1u] = g_base64_alphabet[(group >> 12u) & 63u];
+			out[2u] = g_base64_alphabet[(group >> 6u) & 63u];
+			out[3u] = g_base64_alphabet[group & 63u];
+			out += 4u;
+		}
+
+		// Pad the last group
+		const size_t remaining = bytes - i;
+		if (remaining > 0u) {
+			uint32_t group = static_cast<uint32_t>(src8[i]) << 16u;
+			if (remaining == 2u) group |= static_cast<uint32_t>(src8[i + 1u]) << 8u;
+			out[0u] = g_base64_alphabet[group >> 18u];
+			out[1u] = g_base64_alphabet[(group >> 12u) & 63u];
+			out[2u] = remaining == 2u ? g_base64_alphabet[(group >> 6u) & 63u] : '=';
+			out[3u] = '=';
+			out += 4u;
+		}
+
+		return out - dst;
+	}
+
+	size_t DecodeBase64(const char* src, const size_t chars, void* dst) {
+		if ((chars & 3u) != 0u) throw std::runtime_error("DecodeBase64 : Number of characters is not divisible by 4");
+		uint8_t* const dst8 = static_cast<uint8_t*>(dst);
+		uint8_t* out = dst8;
+
+		size_t i = 0u;
+		while (i < chars) {
+			// Decode as much as possible with SIMD, it stops at padding or invalid characters
+			const size_t simd_chars = DecodeBase64SIMD(src + i, chars - i, out);
+			i += simd_chars;
+			out += (simd_chars / 4u) * 3u;
+
+			// Decode groups until the next SIMD block can start
+			const size_t end = chars - i > 64u ? i + 64u : chars;
+			for (; i < end; i += 4u) {
+				const uint32_t a = DecodeBase64Character(src[i]);
+				const uint32_t b = DecodeBase64Character(src[i + 1u]);
+				if (a == INVALID_CHARACTER || b == INVALID_CHARACTER) throw std::runtime_error("DecodeBase64 : Invalid base64 character");
+
+				if (src[i + 3u] == '=') {
+					// Padded group
+					*out++ = static_cast<uint8_t>((a << 2u) | (b >> 4u));
+					if (src[i + 2u] != '=') {
+						const uint32_t c = DecodeBase64Character(src[i + 2u]);
+						if (c == INVALID_CHARACTER) throw std::runtime_error("DecodeBase64 : Invalid base64 character");
+						*out++ = static_cast<uint8_t>((b << 4u) | (c >> 2u));
+					}
+				} else {
+					const uint32_t c = DecodeBase64Character(src[i + 2u]);
+					const uint32_t d = DecodeBase64Character(src[i + 3u]);
+					if (c == INVALID_CHARACTER || d == INVALID_CHARACTER) throw std::runtime_error("DecodeBase64 : Invalid base64 character");
+					out[0u] = static_cast<uint8_t>((a << 2u) | (b >> 4u));
+					out[1u] = static_cast<uint8_t>((b << 4u) | (c >> 2u));
+					out[2u] = static_cast<uint8_t>((c << 6u) | d);
+					out += 3u;
+				}
+			}
+		}
+
+		return out - dst8;
+	}
+
+	// Base64EncoderPipe
+
+	Base64EncoderPipe::Base64EncoderPipe(OutputPipe& downstream_pipe) :
+		_downstream_pipe(downstream_pipe),
+		_buffer_size(0u),
+		_remainder_size(0u)
+	{}
+
+	Base64EncoderPipe::~Base64EncoderPipe() {
+		_Flush();
+	}
+
+	void Base64EncoderPipe::FlushBuffer() {
+		if (_buffer_size == 0u) return;
+		const uint32_t bytes_written = _downstream_pipe.WriteBytes(_buffer, _buffer_size);
+		if (bytes_written != _buffer_size) throw std::runtime_error("Base64EncoderPipe::FlushBuffer : Failed to write to downstream pipe");
+		_buffer_size = 0u;
+	}
+
+	void Base64EncoderPipe::_Flush() {
+		// Pad the incomplete group
+		if (_remainder_size > 0u) {
+			if (BUFFER_SIZE - _buffer_size < 4u) FlushBuffer();
+			_buffer_size += static_cast<uint32_t>(EncodeBase64(_remainder, _remainder_size, _buffer + _buffer_size));
+			_remainder_size = 0u;
+		}
+		FlushBuffer();
+	}
+
+	uint32_t Base64EncoderPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		uint32_t remaining = bytes;
+
+		// Complete the group that was started by the last write
+		if (_remainder_size > 0u) {
+			while (_remainder_size < 3u && remaining > 0u) {
+				_remainder[_remainder_size++] = *src8++;
+				--remaining;
+			}
+			if (_remainder_size < 3u) return bytes;
+
+			if (BUFFER_SIZE - _buffer_size < 4u) FlushBuffer();
+			_buffer_size += static_cast<uint32_t>(EncodeBase64(_remainder, 3u, _buffer + _buffer_size));
+			_remainder_size = 0u;
+		}
+
+		// Encode whole groups into the buffer
+		uint32_t whole_groups = (remaining / 3u) * 3u;
+		remaining -= whole_groups;
+		while (whole_groups > 0u) {
+			uint32_t bytes_to_encode = ((BUFFER_SIZE - _buffer_size) / 4u) * 3u;
+			if (bytes_to_encode == 0u) {
+				FlushBuffer();
+				continue;
+			}
+			if (bytes_to_encode > whole_groups) bytes_to_encode = whole_groups;
+
+			_buffer_size += static_cast<uint32_t>(EncodeBase64(src8, bytes_to_encode, _buffer + _buffer_size));
+			src8 += bytes_to_encode;
+			whole_groups -= bytes_to_encode;
+		}
+
+		// Hold on to the bytes that don't make a whole group
+		memcpy(_remainder, src8, remaining);
+		_remainder_size = remaining;
+
+		return bytes;
+	}
+
+	void Base64EncoderPipe::Flush() {
+		_Flush();
+		_downstream_pipe.Flush();
+	}
+
+	// Base64DecoderPipe
+
+	Base64DecoderPipe::Base64DecoderPipe(InputPipe& downstream_pipe) :
+		_downstream_pipe(downstream_pipe),
+		_encoded_size(0u),
+		_decoded_size(0u),
+		_decoded_offset(0u),
+		_end_of_stream(false)
+	{}
+
+	Base64DecoderPipe::~Base64DecoderPipe() {
+
+	}
+
+	uint32_t Base64DecoderPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		uint8_t* dst8 = static_cast<uint8_t*>(dst);
+		uint32_t remaining = bytes;
+
+		while (remaining > 0u) {
+			// Copy data that has already been decoded
+			if (_decoded_offset < _decoded_size) {
+				uint32_t bytes_to_copy = _decoded_size - _decoded_offset;
+				if (bytes_to_copy > remaining) bytes_to_copy = remaining;
+				memcpy(dst8, _decoded + _decoded_offset, bytes_to_copy);
+				_decoded_offset += bytes_to_copy;
+				dst8 += bytes_to_copy;
+				remaining -= bytes_to_copy;
+				continue;
+			}
+
+			if (_end_of_stream) break;
+
+			// Read the next block of characters
+			const uint32_t bytes_to_read = ENCODED_BUFFER_SIZE - _encoded_size;
+			const uint32_t bytes_read = _downstream_pipe.ReadBytes(_encoded + _encoded_size, bytes_to_read);
+			_encoded_size += bytes_read;
+			if (bytes_read < bytes_to_read) {
+				_end_of_stream = true;
+				if ((_encoded_size & 3u) != 0u) throw std::runtime_error("Base64DecoderPipe::ReadBytes : Stream ended in the middle of a group");
+			}
+
+			// Decode whole groups, straight into the caller's memory if it is large enough
+			const uint32_t chars = _encoded_size & ~3u;
+			if (remaining >= GetBase64DecodedLength(chars)) {
+				const uint32_t decoded = static_cast<uint32_t>(DecodeBase64(_encoded, chars, dst8));
+				dst8 += decoded;
+				remaining -= decoded;
+			} else {
+				_decoded_size = static_cast<uint32_t>(DecodeBase64(_encoded, chars, _decoded));
+				_decoded_offset = 0u;
+			}
+
+			// Keep the incomplete group for the next read
+			_encoded_size -= chars;
+			memmove(_encoded, _encoded + chars, _encoded_size);
+		}
+
+		return bytes - remaining;
+	}
+
+}}
@@ -0,0 +1,436 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include "anvil/byte-pipe/BytePipeBitPack.hpp"
+#include "anvil/byte-pipe/BytePipeEndian.hpp"
+
+#if ANVIL_BYTEPIPE_SSE2
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static ANVIL_CONSTEXPR const uint32_t g_bitpack_block_size = 128u;
+		static ANVIL_CONSTEXPR const uint32_t g_bitpack_delta_flag = 128u;	//!< Set in the first byte of delta blocks
+
+		static inline uint32_t CountLeadingZeros32(const uint32_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse(&index, bits);
+			return 31u - static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_clz(bits));
+#endif
+		}
+
+		static inline uint32_t CountLeadingZeros64(const uint64_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse64(&index, bits);
+			return 63u - static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_clzll(bits));
+#endif
+		}
+
+		// Returns the number of bits needed to store a value
+		template<class T>
+		static inline uint32_t GetBitWidth(const T bits) {
+			if (bits == 0u) return 0u;
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return 32u - CountLeadingZeros32(static_cast<uint32_t>(bits));
+			} else {
+				return 64u - CountLeadingZeros64(static_cast<uint64_t>(bits));
+			}
+		}
+
+		template<class T>
+		static inline T GetBitMask(const uint32_t width) {
+			return width >= sizeof(T) * 8u ? static_cast<T>(~static_cast<T>(0u)) : static_cast<T>((static_cast<T>(1u) << width) - 1u);
+		}
+
+		// Returns the number of words that a block of packed values uses
+		template<class T>
+		static inline uint32_t GetWordCount(const uint32_t count, const uint32_t width) {
+			return (count * width + (sizeof(T) * 8u - 1u)) / (sizeof(T) * 8u);
+		}
+
+		static uint32_t GetElementBytes(const Type type) {
+			switch (type) {
+			case TYPE_U32:
+			case TYPE_S32:
+				return 4u;
+			case TYPE_U64:
+			case TYPE_S64:
+				return 8u;
+			default:
+				throw std::runtime_error("Bit packed arrays only support 32 and 64-bit integers");
+			}
+		}
+
+		template<class T, bool SIGNED>
+		static inline bool IsLess(const T a, const T b) {
+			typedef typename std::make_signed<T>::type S;
+			if ANVIL_CONSTEXPR (SIGNED) {
+				return static_cast<S>(a) < static_cast<S>(b);
+			} else {
+				return a < b;
+			}
+		}
+
+		// Reduces a block to the values that will be packed, returns the first byte of the block
+		template<class T, bool SIGNED>
+		static uint32_t PrepareBlock(const T* src, const uint32_t count, T* packed, T& base, T& delta_min) {
+			// Frame of reference
+			T min = src[0u];
+			for (uint32_t i = 1u; i < count; ++i) if (IsLess<T, SIGNED>(src[i], min)) min = src[i];
+			T reference_bits = 0u;
+			for (uint32_t i = 0u; i < count; ++i) reference_bits |= static_cast<T>(src[i] - min);
+
+			// Delta, differences are compared as signed values so that values which go down as well as up stay small
+			T min_difference = 0u;
+			if (count > 1u) {
+				min_difference = static_cast<T>(src[1u] - src[0u]);
+				for (uint32_t i = 2u; i < count; ++i) {
+					const T difference = static_cast<T>(src[i] - src[i - 1u]);
+					if (IsLess<T, true>(difference, min_difference)) min_difference = difference;
+				}
+			}
+			T delta_bits = 0u;
+			for (uint32_t i = 1u; i < count; ++i) delta_bits |= static_cast<T>(src[i] - src[i - 1u] - min_difference);
+
+			// Delta blocks write an extra value in their header
+			const uint32_t reference_width = GetBitWidth<T>(reference_bits);
+			const uint32_t delta_width = GetBitWidth<T>(delta_bits);
+			if (GetWordCount<T>(count, delta_width) + 1u < GetWordCount<T>(count, reference_width)) {
+				// The first value is stored relative to the value before it, so that it packs to 0
+				base = static_cast<T>(src[0u] - min_difference);
+				delta_min = min_difference;
+				packed[0u] = 0u;
+				for (uint32_t i = 1u; i < count; ++i) packed[i] = static_cast<T>(src[i] - src[i - 1u] - min_difference);
+				return delta_width | g_bitpack_delta_flag;
+			}
+
+			base = min;
+			delta_min = 0u;
+			for (uint32_t i = 0u; i < count; ++i) packed[i] = static_cast<T>(src[i] - min);
+			return reference_width;
+		}
+
+		// Values are interleaved between lanes, a lane count of 1 packs the values one after another
+		template<class T>
+		static void PackValues(const T* values, const uint32_t count, const uint32_t width, const uint32_t lanes, uint8_t* dst) {
+			if (width == 0u) return;
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			T words[g_bitpack_block_size];
+			const uint32_t word_count = GetWordCount<T>(count, width);
+			memset(words, 0, word_count * sizeof(T));
+			for (uint32_t i = 0u; i < count; ++i) {
+				const uint32_t lane = i % lanes;
+				const uint32_t bit = (i / lanes) * width;
+				const uint32_t word = (bit / bits) * lanes + lane;
+				const uint32_t shift = bit % bits;
+				words[word] |= static_cast<T>(values[i] << shift);
+				if (shift + width > bits) words[word + lanes] |= static_cast<T>(values[i] >> (bits - shift));
+			}
+			memcpy(dst, words, word_count * sizeof(T));
+		}
+
+		template<class T>
+		static void UnpackValues(const uint8_t* src, const uint32_t count, const uint32_t width, const uint32_t lanes, T* values) {
+			if (width == 0u) {
+				memset(values, 0, count * sizeof(T));
+				return;
+			}
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			T words[g_bitpack_block_size];
+			memcpy(words, src, GetWordCount<T>(count, width) * sizeof(T));
+			const T mask = GetBitMask<T>(width);
+			for (uint32_t i = 0u; i < count; ++i) {
+				const uint32_t lane = i % lanes;
+				const uint32_t bit = (i / lanes) * width;
+				const uint32_t word = (bit / bits) * lanes + lane;
+				const uint32_t shift = bit % bits;
+				T value = words[word] >> shift;
+				if (shift + width > bits) value |= static_cast<T>(words[word + lanes] << (bits - shift));
+				values[i] = value & mask;
+			}
+		}
+
+		template<class T>
+		static void DecodeValues(T* values, const uint32_t count, const T base, const bool delta, const T delta_min) {
+			if (delta) {
+				T previous = base;
+				for (uint32_t i = 0u; i < count; ++i) {
+					previous += static_cast<T>(values[i] + delta_min);
+					values[i] = previous;
+				}
+			} else {
+				for (uint32_t i = 0u; i < count; ++i) values[i] += base;
+			}
+		}
+
+#if ANVIL_BYTEPIPE_SSE2
+		template<class T>
+		static inline __m128i ShiftLeft(const __m128i value, const uint32_t shift) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return _mm_sll_epi32(value, _mm_cvtsi32_si128(static_cast<int>(shift)));
+			} else {
+				return _mm_sll_epi64(value, _mm_cvtsi32_si128(static_cast<int>(shift)));
+			}
+		}
+
+		template<class T>
+		static inline __m128i ShiftRight(const __m128i value, const uint32_t shift) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return _mm_srl_epi32(value, _mm_cvtsi32_si128(static_cast<int>(shift)));
+			} else {
+				return _mm_srl_epi64(value, _mm_cvtsi32_si128(static_cast<int>(shift)));
+			}
+		}
+
+		template<class T>
+		static inline __m128i Add(const __m128i a, const __m128i b) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return _mm_add_epi32(a, b);
+			} else {
+				return _mm_add_epi64(a, b);
+			}
+		}
+
+		template<class T>
+		static inline __m128i Broadcast(const T value) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return _mm_set1_epi32(static_cast<int>(value));
+			} else {
+				return _mm_set1_epi64x(static_cast<long long>(value));
+			}
+		}
+
+		// Adds each value to the values after it, previous contains the last value of the previous vector in every lane
+		template<class T>
+		static inline __m128i PrefixSum(__m128i values, const __m128i previous) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+				values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+			} else {
+				values = _mm_add_epi64(values, _mm_slli_si128(values, 8));
+			}
+			return Add<T>(values, previous);
+		}
+
+		template<class T>
+		static inline __m128i BroadcastLast(const __m128i values) {
+			if ANVIL_CONSTEXPR (sizeof(T) == 4u) {
+				return _mm_shuffle_epi32(values, _MM_SHUFFLE(3, 3, 3, 3));
+			} else {
+				return _mm_unpackhi_epi64(values, values);
+			}
+		}
+
+		// Each vector contains one value from every lane, so the values that share a word are packed at the same time
+		template<class T>
+		static void PackBlockSSE2(const T* values, const uint32_t width, uint8_t* dst) {
+			if (width == 0u) return;
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			ANVIL_CONSTEXPR const uint32_t lanes = 16u / sizeof(T);
+			__m128i words[64u];
+			for (uint32_t i = 0u; i < width; ++i) words[i] = _mm_setzero_si128();
+			for (uint32_t i = 0u; i < g_bitpack_block_size / lanes; ++i) {
+				const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * lanes));
+				const uint32_t bit = i * width;
+				const uint32_t word = bit / bits;
+				const uint32_t shift = bit % bits;
+				words[word] = _mm_or_si128(words[word], ShiftLeft<T>(value, shift));
+				if (shift + width > bits) words[word + 1u] = _mm_or_si128(words[word + 1u], ShiftRight<T>(value, bits - shift));
+			}
+			for (uint32_t i = 0u; i < width; ++i) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst) + i, words[i]);
+		}
+
+		// Unpacks and decodes a full block in one pass, so the values are only written to memory once
+		template<class T>
+		static void UnpackBlockSSE2(const uint8_t* src, const uint32_t width, const T base, const bool delta, const T delta_min, T* dst) {
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			ANVIL_CONSTEXPR const uint32_t lanes = 16u / sizeof(T);
+			const __m128i* const words = reinterpret_cast<const __m128i*>(src);
+			const __m128i mask = Broadcast<T>(GetBitMask<T>(width));
+			const __m128i offset = Broadcast<T>(delta ? delta_min : base);
+			__m128i previous = Broadcast<T>(base);
+			for (uint32_t i = 0u; i < g_bitpack_block_size / lanes; ++i) {
+				__m128i value = _mm_setzero_si128();
+				if (width > 0u) {
+					const uint32_t bit = i * width;
+					const uint32_t word = bit / bits;
+					const uint32_t shift = bit % bits;
+					value = ShiftRight<T>(_mm_loadu_si128(words + word), shift);
+					if (shift + width > bits) value = _mm_or_si128(value, ShiftLeft<T>(_mm_loadu_si128(words + word + 1u), bits - shift));
+					value = _mm_and_si128(value, mask);
+				}
+				value = Add<T>(value, offset);
+				if (delta) {
+					value = PrefixSum<T>(value, previous);
+					previous = BroadcastLast<T>(value);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * lanes), value);
+			}
+		}
+#endif
+
+		template<class T, bool SIGNED>
+		static uint64_t BitPackIntegers(const T* src, const uint32_t size, uint8_t* dst) {
+			T packed[g_bitpack_block_size];
+			uint8_t* out = dst;
+			for (uint32_t i = 0u; i < size; i += g_bitpack_block_size) {
+				const uint32_t count = size - i < g_bitpack_block_size ? size - i : g_bitpack_block_size;
+				T base, delta_min;
+				const uint32_t mode = PrepareBlock<T, SIGNED>(src + i, count, packed, base, delta_min);
+				const uint32_t width = mode & ~g_bitpack_delta_flag;
+
+				// Write the block header
+				*out = static_cast<uint8_t>(mode);
+				++out;
+				memcpy(out, &base, sizeof(T));
+				out += sizeof(T);
+				if (mode & g_bitpack_delta_flag) {
+					memcpy(out, &delta_min, sizeof(T));
+					out += sizeof(T);
+				}
+
+				// Write the values
+				if (count == g_bitpack_block_size) {
+#if ANVIL_BYTEPIPE_SSE2
+					PackBlockSSE2<T>(packed, width, out);
+#else
+					PackValues<T>(packed, count, width, 16u / sizeof(T), out);
+#endif
+				} else {
+					PackValues<T>(packed, count, width, 1u, out);
+				}
+				out += GetWordCount<T>(count, width) * sizeof(T);
+			}
+			return static_cast<uint64_t>(out - dst);
+		}
+
+		// Checks the header of the block at src, returns the size of the block in bytes
+		template<class T>
+		static uint32_t GetBlockBytes(const uint8_t* src, const uint8_t* end, const uint32_t count) {
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			if (src >= end) throw std::runtime_error("Bit packed array is shorter than its size");
+			const uint32_t mode = *src;
+			const uint32_t width = mode & ~g_bitpack_delta_flag;
+			if (width > bits) throw std::runtime_error("Bit packed array contains a block that is too wide");
+			const uint32_t header_bytes = 1u + ((mode & g_bitpack_delta_flag) ? 2u : 1u) * static_cast<uint32_t>(sizeof(T));
+			const uint32_t block_bytes = header_bytes + GetWordCount<T>(count, width) * static_cast<uint32_t>(sizeof(T));
+			if (static_cast<size_t>(end - src) < block_bytes) throw std::runtime_error("Bit packed array is shorter than its size");
+			return block_bytes;
+		}
+
+		template<class T>
+		static void BitUnpackIntegers(const uint8_t* src, const uint32_t bytes, const uint32_t size, T* dst) {
+			const uint8_t* const end = src + bytes;
+			for (uint32_t i = 0u; i < size; i += g_bitpack_block_size) {
+				const uint32_t count = size - i < g_bitpack_block_size ? size - i : g_bitpack_block_size;
+				const uint32_t block_bytes = GetBlockBytes<T>(src, end, count);
+
+				// Read the block header
+				const uint32_t mode = *src;
+				const uint32_t width = mode & ~g_bitpack_delta_flag;
+				const bool delta = (mode & g_bitpack_delta_flag) != 0u;
+				T base, delta_min = 0u;
+				memcpy(&base, src + 1u, sizeof(T));
+				if (delta) memcpy(&delta_min, src + 1u + sizeof(T), sizeof(T));
+				const uint8_t* const words = src + 1u + (delta ? 2u : 1u) * sizeof(T);
+
+				// Read the values
+				if (count == g_bitpack_block_size) {
+#if ANVIL_BYTEPIPE_SSE2
+					UnpackBlockSSE2<T>(words, width, base, delta, delta_min, dst + i);
+#else
+					UnpackValues<T>(words, count, width, 16u / sizeof(T), dst + i);
+					DecodeValues<T>(dst + i, count, base, delta, delta_min);
+#endif
+				} else {
+					UnpackValues<T>(words, count, width, 1u, dst + i);
+					DecodeValues<T>(dst + i, count, base, delta, delta_min);
+				}
+				src += block_bytes;
+			}
+			if (src != end) throw std::runtime_error("Bit packed array is longer than its size");
+		}
+
+		template<class T>
+		static void SwapBitPackedByteOrder(uint8_t* data, const uint32_t bytes, const uint32_t size) {
+			const uint8_t* const end = data + bytes;
+			for (uint32_t i = 0u; i < size; i += g_bitpack_block_size) {
+				const uint32_t count = size - i < g_bitpack_block_size ? size - i : g_bitpack_block_size;
+				const uint32_t block_bytes = GetBlockBytes<T>(data, end, count);
+
+				// Everything after the first byte is a value or a word
+				for (uint32_t j = 1u; j < block_bytes; j += sizeof(T)) {
+					T word;
+					memcpy(&word, data + j, sizeof(T));
+					word = SwapByteOrder(word);
+					memcpy(data + j, &word, sizeof(T));
+				}
+				data += block_bytes;
+			}
+			if (data != end) throw std::runtime_error("Bit packed array is longer than its size");
+		}
+	}
+
+	uint64_t GetMaxBitPackedBytes(const Type type, const uint32_t size) {
+		const uint64_t element_bytes = detail::GetElementBytes(type);
+		const uint64_t blocks = (static_cast<uint64_t>(size) + detail::g_bitpack_block_size - 1u) / detail::g_bitpack_block_size;
+		return blocks * (1u + element_bytes * 2u) + static_cast<uint64_t>(size) * element_bytes;
+	}
+
+	uint64_t BitPackIntegers(const void* src, const Type type, const uint32_t size, void* dst) {
+		switch (type) {
+		case TYPE_U32:
+			return detail::BitPackIntegers<uint32_t, false>(static_cast<const uint32_t*>(src), size, static_cast<uint8_t*>(dst));
+		case TYPE_S32:
+			return detail::BitPackIntegers<uint32_t, true>(static_cast<const uint32_t*>(src), size, static_cast<uint8_t*>(dst));
+		case TYPE_U64:
+			return detail::BitPackIntegers<uint64_t, false>(static_cast<const uint64_t*>(src), size, static_cast<uint8_t*>(dst));
+		case TYPE_S64:
+			return detail::BitPackIntegers<uint64_t, true>(static_cast<const uint64_t*>(src), size, static_cast<uint8_t*>(dst));
+		default:
+			detail::GetElementBytes(type);
+			return 0u;
+		}
+	}
+
+	void BitUnpackIntegers(const void* src, const uint32_t bytes, const Type type, const uint32_t size, void* dst) {
+		// Signed values are decoded in the same way as unsigned ones
+		if (detail::GetElementBytes(type) == 4u) {
+			detail::BitUnpackIntegers<uint32_t>(static_cast<const uint8_t*>(src), bytes, size, static_cast<uint32_t*>(dst));
+		} else {
+			detail::BitUnpackIntegers<uint64_t>(static_cast<const uint8_t*>(src), bytes, size, static_cast<uint64_t*>(dst));
+		}
+	}
+
+	void SwapBitPackedByteOrder(void* data, const uint32_t bytes, const Type type, const uint32_t size) {
+		if (detail::GetElementBytes(type) == 4u) {
+			detail::SwapBitPackedByteOrder<uint32_t>(static_cast<uint8_t*>(data), bytes, size);
+		} else {
+			detail::SwapBitPackedByteOrder<uint64_t>(static_cast<uint8_t*>(data), bytes, size);
+		}
+	}
+
+}}
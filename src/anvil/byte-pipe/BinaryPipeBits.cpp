@@ -66,6 +66,16 @@ namespace anvil { namespace BytePipe {
 		}
 	}
 
+	uint8_t* BitOutputStream::Flush() {
+		if (_buffered_bits > 0u) {
+			*_out = static_cast<uint8_t>(_buffer << (8u - _buffered_bits));
+			++_out;
+			_buffer = 0u;
+			_buffered_bits = 0u;
+		}
+		return _out;
+	}
+
 	// BitInputStream
 
 	void BitInputStream::NextByte() {
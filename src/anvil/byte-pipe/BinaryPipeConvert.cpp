@@ -0,0 +1,586 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include "anvil/byte-pipe/BytePipeConvert.hpp"
+
+#if ANVIL_BYTEPIPE_AVX2
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static constexpr size_t CONVERT_CHUNK_SIZE = 256u;	//!< The number of values converted at a time when going through an intermediate type
+
+		// Scalar conversion of one value
+
+		template<class S, class D>
+		static inline D ConvertValue(const S value) {
+			typedef std::numeric_limits<D> Limits;
+
+			if ANVIL_CONSTEXPR (std::is_floating_point<D>::value) {
+				return static_cast<D>(value);
+
+			} else if ANVIL_CONSTEXPR (std::is_floating_point<S>::value) {
+				// Round to nearest and saturate, NaN becomes 0
+				if (value != value) return 0;
+				const S rounded = std::nearbyint(value);
+				if (rounded <= static_cast<S>(Limits::min())) return Limits::min();
+				if (rounded >= static_cast<S>(Limits::max())) return Limits::max();
+				return static_cast<D>(rounded);
+
+			} else if ANVIL_CONSTEXPR (std::is_signed<S>::value) {
+				const int64_t tmp = static_cast<int64_t>(value);
+				if (tmp < static_cast<int64_t>(Limits::min())) return Limits::min();
+				if (tmp > 0 && static_cast<uint64_t>(tmp) > static_cast<uint64_t>(Limits::max())) return Limits::max();
+				return static_cast<D>(value);
+
+			} else {
+				const uint64_t tmp = static_cast<uint64_t>(value);
+				if (tmp > static_cast<uint64_t>(Limits::max())) return Limits::max();
+				return static_cast<D>(value);
+			}
+		}
+
+		// SIMD conversions, each one converts as many values as it can and returns the number converted
+
+		template<class S, class D>
+		static inline size_t ConvertArraySIMD(const S*, D*, const size_t) {
+			return 0u;
+		}
+
+#if ANVIL_BYTEPIPE_AVX2
+		// Integers and floats to F64, 4 values at a time
+
+		static inline uint32_t Load32(const void* src) {
+			uint32_t tmp;
+			memcpy(&tmp, src, sizeof(uint32_t));
+			return tmp;
+		}
+
+		static size_t ConvertArraySIMD(const uint8_t* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(Load32(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int8_t* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(Load32(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const uint16_t* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int16_t* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int32_t* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const uint32_t* src, double* dst, const size_t count) {
+			// Flip the sign bit so that the value can be converted as a signed integer, then add the offset back
+			const __m128i sign = _mm_set1_epi32(INT32_MIN);
+			const __m256d offset = _mm256_set1_pd(2147483648.0);
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) {
+				const __m128i tmp = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), sign);
+				_mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_cvtepi32_pd(tmp), offset));
+			}
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const float* src, double* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm256_storeu_pd(dst + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+			return i;
+		}
+
+		// Integers and doubles to F32, 8 values at a time
+
+		static size_t ConvertArraySIMD(const uint8_t* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int8_t* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const uint16_t* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int16_t* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int32_t* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const double* src, float* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+			return i;
+		}
+
+		// Floating point to S32 with saturation, NaN becomes 0
+
+		static size_t ConvertArraySIMD(const double* src, int32_t* dst, const size_t count) {
+			const __m256d min = _mm256_set1_pd(static_cast<double>(INT32_MIN));
+			const __m256d max = _mm256_set1_pd(static_cast<double>(INT32_MAX));
+			size_t i = 0u;
+			for (; i + 4u <= count; i += 4u) {
+				__m256d tmp = _mm256_loadu_pd(src + i);
+				tmp = _mm256_and_pd(tmp, _mm256_cmp_pd(tmp, tmp, _CMP_ORD_Q));
+				tmp = _mm256_min_pd(_mm256_max_pd(tmp, min), max);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtpd_epi32(tmp));
+			}
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const float* src, int32_t* dst, const size_t count) {
+			// INT32_MAX can't be stored as a float, so values that are too large are replaced after conversion
+			const __m256 min = _mm256_set1_ps(static_cast<float>(INT32_MIN));
+			const __m256 too_large = _mm256_set1_ps(2147483648.f);
+			const __m256i max = _mm256_set1_epi32(INT32_MAX);
+			size_t i = 0u;
+			for (; i + 8u <= count; i += 8u) {
+				__m256 tmp = _mm256_loadu_ps(src + i);
+				tmp = _mm256_and_ps(tmp, _mm256_cmp_ps(tmp, tmp, _CMP_ORD_Q));
+				tmp = _mm256_max_ps(tmp, min);
+				const __m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(tmp, too_large, _CMP_GE_OQ));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(_mm256_cvtps_epi32(tmp), max, overflow));
+			}
+			return i;
+		}
+
+		// Narrowing integers with saturation, packing works within 128 bit lanes so the result is reordered
+
+		static size_t ConvertArraySIMD(const int32_t* src, int16_t* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 16u <= count; i += 16u) {
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8u));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8));
+			}
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int32_t* src, uint16_t* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 16u <= count; i += 16u) {
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8u));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8));
+			}
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int16_t* src, int8_t* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 32u <= count; i += 32u) {
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16u));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xD8));
+			}
+			return i;
+		}
+
+		static size_t ConvertArraySIMD(const int16_t* src, uint8_t* dst, const size_t count) {
+			size_t i = 0u;
+			for (; i + 32u <= count; i += 32u) {
+				const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+				const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16u));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+			}
+			return i;
+		}
+#endif
+
+		// Convert an array of any numeric type
+
+		template<class S, class D>
+		static void ConvertArray(const S* src, D* dst, const size_t count) {
+			if ANVIL_CONSTEXPR (std::is_same<S, D>::value) {
+				memcpy(dst, src, count * sizeof(S));
+
+			} else if ANVIL_CONSTEXPR (std::is_same<S, half>::value) {
+				// Convert to float first
+				float tmp[CONVERT_CHUNK_SIZE];
+				for (size_t i = 0u; i < count; i += CONVERT_CHUNK_SIZE) {
+					const size_t n = count - i < CONVERT_CHUNK_SIZE ? count - i : CONVERT_CHUNK_SIZE;
+					HalfToFloat(reinterpret_cast<const half*>(src) + i, tmp, n);
+					ConvertArray<float, D>(tmp, dst + i, n);
+				}
+
+			} else if ANVIL_CONSTEXPR (std::is_same<D, half>::value) {
+				if ANVIL_CONSTEXPR (std::is_same<S, double>::value) {
+					// Avoid rounding twice
+					for (size_t i = 0u; i < count; ++i) reinterpret_cast<half*>(dst)[i] = DoubleToHalf(static_cast<double>(src[i]));
+				} else {
+					// Convert to float first
+					float tmp[CONVERT_CHUNK_SIZE];
+					for (size_t i = 0u; i < count; i += CONVERT_CHUNK_SIZE) {
+						const size_t n = count - i < CONVERT_CHUNK_SIZE ? count - i : CONVERT_CHUNK_SIZE;
+						ConvertArray<S, float>(src + i, tmp, n);
+						FloatToHalf(tmp, reinterpret_cast<half*>(dst) + i, n);
+					}
+				}
+
+			} else {
+				size_t i = ConvertArraySIMD(src, dst, count);
+				for (; i < count; ++i) dst[i] = ConvertValue<S, D>(src[i]);
+			}
+		}
+
+		typedef void(*ConvertFunction)(const void* src, void* dst, const size_t count);
+
+		template<class S, class D>
+		static void ConvertArrayHelper(const void* src, void* dst, const size_t count) {
+			ConvertArray<S, D>(static_cast<const S*>(src), static_cast<D*>(dst), count);
+		}
+
+#define ANVIL_CONVERT_ROW(S) {\
+	&ConvertArrayHelper<S, uint8_t>, &ConvertArrayHelper<S, uint16_t>, &ConvertArrayHelper<S, uint32_t>, &ConvertArrayHelper<S, uint64_t>,\
+	&ConvertArrayHelper<S, int8_t>, &ConvertArrayHelper<S, int16_t>, &ConvertArrayHelper<S, int32_t>, &ConvertArrayHelper<S, int64_t>,\
+	&ConvertArrayHelper<S, half>, &ConvertArrayHelper<S, float>, &ConvertArrayHelper<S, double>\
+}
+
+		// Indexed by [source type - TYPE_U8][destination type - TYPE_U8]
+		static const ConvertFunction g_convert_functions[11u][11u] = {
+			ANVIL_CONVERT_ROW(uint8_t),
+			ANVIL_CONVERT_ROW(uint16_t),
+			ANVIL_CONVERT_ROW(uint32_t),
+			ANVIL_CONVERT_ROW(uint64_t),
+			ANVIL_CONVERT_ROW(int8_t),
+			ANVIL_CONVERT_ROW(int16_t),
+			ANVIL_CONVERT_ROW(int32_t),
+			ANVIL_CONVERT_ROW(int64_t),
+			ANVIL_CONVERT_ROW(half),
+			ANVIL_CONVERT_ROW(float),
+			ANVIL_CONVERT_ROW(double)
+		};
+
+#undef ANVIL_CONVERT_ROW
+
+		static inline bool IsNumericType(const Type type) {
+			return type >= TYPE_U8 && type <= TYPE_F64;
+		}
+	}
+
+	void ConvertPrimativeArray(const void* src, const Type src_type, void* dst, const Type dst_type, const size_t count) {
+		if (! (detail::IsNumericType(src_type) && detail::IsNumericType(dst_type))) throw std::runtime_error("ConvertPrimativeArray : Only numeric types can be converted");
+		detail::g_convert_functions[src_type - TYPE_U8][dst_type - TYPE_U8](src, dst, count);
+	}
+
+	// PrimativeArrayConverter
+
+	PrimativeArrayConverter::PrimativeArrayConverter(Parser& downstream, const Type type) :
+		_downstream(downstream),
+		_type(type)
+	{
+		if (! detail::IsNumericType(type)) throw std::runtime_error("PrimativeArrayConverter::PrimativeArrayConverter : Arrays can only be converted to a numeric type");
+	}
+
+	PrimativeArrayConverter::~PrimativeArrayConverter() {
+
+	}
+
+	template<class T>
+	void PrimativeArrayConverter::ConvertArray(const T* src, const uint32_t size) {
+		const Type src_type = GetTypeID<T>();
+		if (src_type == _type) {
+			_downstream.OnPrimativeArray(src, size);
+			return;
+		}
+
+		// Convert into the scratch buffer, which is only reallocated when a larger array is seen
+		// Every numeric type fits into one 64-bit word
+		if (_buffer.size() < size) _buffer.resize(size);
+		void* const dst = _buffer.data();
+		ConvertPrimativeArray(src, src_type, dst, _type, size);
+
+		switch (_type) {
+		case TYPE_U8:
+			_downstream.OnPrimativeArrayU8(static_cast<const uint8_t*>(dst), size);
+			break;
+		case TYPE_U16:
+			_downstream.OnPrimativeArrayU16(static_cast<const uint16_t*>(dst), size);
+			break;
+		case TYPE_U32:
+			_downstream.OnPrimativeArrayU32(static_cast<const uint32_t*>(dst), size);
+			break;
+		case TYPE_U64:
+			_downstream.OnPrimativeArrayU64(static_cast<const uint64_t*>(dst), size);
+			break;
+		case TYPE_S8:
+			_downstream.OnPrimativeArrayS8(static_cast<const int8_t*>(dst), size);
+			break;
+		case TYPE_S16:
+			_downstream.OnPrimativeArrayS16(static_cast<const int16_t*>(dst), size);
+			break;
+		case TYPE_S32:
+			_downstream.OnPrimativeArrayS32(static_cast<const int32_t*>(dst), size);
+			break;
+		case TYPE_S64:
+			_downstream.OnPrimativeArrayS64(static_cast<const int64_t*>(dst), size);
+			break;
+		case TYPE_F16:
+			_downstream.OnPrimativeArrayF16(static_cast<const half*>(dst), size);
+			break;
+		case TYPE_F32:
+			_downstream.OnPrimativeArrayF32(static_cast<const float*>(dst), size);
+			break;
+		default:
+			_downstream.OnPrimativeArrayF64(static_cast<const double*>(dst), size);
+			break;
+		}
+	}
+
+	void* PrimativeArrayConverter::AcquireArrayBuffer(const Type type, const uint32_t count) {
+		// Only arrays that are forwarded without conversion can use the downstream parser's memory
+		if (type == _type || ! detail::IsNumericType(type)) return _downstream.AcquireArrayBuffer(type, count);
+		return nullptr;
+	}
+
+	void PrimativeArrayConverter::OnPipeOpen() {
+		_downstream.OnPipeOpen();
+	}
+
+	void PrimativeArrayConverter::OnPipeClose() {
+		_downstream.OnPipeClose();
+	}
+
+	void PrimativeArrayConverter::OnArrayBegin(const uint32_t size) {
+		_downstream.OnArrayBegin(size);
+	}
+
+	void PrimativeArrayConverter::OnArrayEnd() {
+		_downstream.OnArrayEnd();
+	}
+
+	void PrimativeArrayConverter::OnObjectBegin(const uint32_t component_count) {
+		_downstream.OnObjectBegin(component_count);
+	}
+
+	void PrimativeArrayConverter::OnObjectEnd() {
+		_downstream.OnObjectEnd();
+	}
+
+	void PrimativeArrayConverter::OnComponentID(const ComponentID id) {
+		_downstream.OnComponentID(id);
+	}
+
+	void PrimativeArrayConverter::OnObjectShape(const uint32_t shape, const ComponentID* component_ids, const uint32_t component_count) {
+		_downstream.OnObjectShape(shape, component_ids, component_count);
+	}
+
+	void PrimativeArrayConverter::OnShapedObjectBegin(const uint32_t shape, const uint32_t component_count) {
+		_downstream.OnShapedObjectBegin(shape, component_count);
+	}
+
+	void PrimativeArrayConverter::OnUserPOD(const uint32_t type, const uint32_t bytes, const void* data) {
+		_downstream.OnUserPOD(type, bytes, data);
+	}
+
+	void PrimativeArrayConverter::OnUserPODArray(const uint32_t type, const uint32_t bytes, const void* src, const uint32_t size) {
+		_downstream.OnUserPODArray(type, bytes, src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeTensor(const Type type, const uint32_t rank, const uint32_t* shape, const void* src) {
+		if (type == _type || ! detail::IsNumericType(type)) {
+			_downstream.OnPrimativeTensor(type, rank, shape, src);
+			return;
+		}
+
+		// Convert all of the values in one pass
+		size_t size = 1u;
+		for (uint32_t i = 0u; i < rank; ++i) size *= shape[i];
+		if (_buffer.size() < size) _buffer.resize(size);
+		ConvertPrimativeArray(src, type, _buffer.data(), _type, size);
+		_downstream.OnPrimativeTensor(_type, rank, shape, _buffer.data());
+	}
+
+	void PrimativeArrayConverter::OnPrimativeSparseArray(const Type type, const uint32_t size, const uint32_t* indices, const void* values, const uint32_t count) {
+		if (type == _type || ! detail::IsNumericType(type)) {
+			_downstream.OnPrimativeSparseArray(type, size, indices, values, count);
+			return;
+		}
+
+		// Only the values that are listed need to be converted
+		if (_buffer.size() < count) _buffer.resize(count);
+		ConvertPrimativeArray(values, type, _buffer.data(), _type, count);
+		_downstream.OnPrimativeSparseArray(_type, size, indices, _buffer.data(), count);
+	}
+
+	void PrimativeArrayConverter::OnColumnarArray(const uint32_t rows, const uint32_t column_count, const ComponentID* component_ids, const Type* types, const void* const* columns) {
+		// Convert each numeric column into its own part of the scratch buffer
+		_column_types.assign(types, types + column_count);
+		_columns.assign(columns, columns + column_count);
+		size_t converted = 0u;
+		for (uint32_t i = 0u; i < column_count; ++i) if (types[i] != _type && detail::IsNumericType(types[i])) ++converted;
+		if (_buffer.size() < converted * rows) _buffer.resize(converted * rows);
+
+		uint64_t* dst = _buffer.data();
+		for (uint32_t i = 0u; i < column_count; ++i) {
+			if (types[i] == _type || ! detail::IsNumericType(types[i])) continue;
+			ConvertPrimativeArray(columns[i], types[i], dst, _type, rows);
+			_column_types[i] = _type;
+			_columns[i] = dst;
+			dst += rows;
+		}
+
+		_downstream.OnColumnarArray(rows, column_count, component_ids, _column_types.data(), _columns.data());
+	}
+
+	void PrimativeArrayConverter::OnNull() {
+		_downstream.OnNull();
+	}
+
+	void PrimativeArrayConverter::OnPrimativeF64(const double value) {
+		_downstream.OnPrimativeF64(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeString(const char* value, const uint32_t length) {
+		_downstream.OnPrimativeString(value, length);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeBool(const bool value) {
+		_downstream.OnPrimativeBool(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeC8(const char value) {
+		_downstream.OnPrimativeC8(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeU64(const uint64_t value) {
+		_downstream.OnPrimativeU64(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeS64(const int64_t value) {
+		_downstream.OnPrimativeS64(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeF32(const float value) {
+		_downstream.OnPrimativeF32(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeU8(const uint8_t value) {
+		_downstream.OnPrimativeU8(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeU16(const uint16_t value) {
+		_downstream.OnPrimativeU16(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeU32(const uint32_t value) {
+		_downstream.OnPrimativeU32(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeS8(const int8_t value) {
+		_downstream.OnPrimativeS8(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeS16(const int16_t value) {
+		_downstream.OnPrimativeS16(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeS32(const int32_t value) {
+		_downstream.OnPrimativeS32(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeF16(const half value) {
+		_downstream.OnPrimativeF16(value);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayU8(const uint8_t* src, const uint32_t size) {
+		ConvertArray<uint8_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayU16(const uint16_t* src, const uint32_t size) {
+		ConvertArray<uint16_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayU32(const uint32_t* src, const uint32_t size) {
+		ConvertArray<uint32_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayU64(const uint64_t* src, const uint32_t size) {
+		ConvertArray<uint64_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayS8(const int8_t* src, const uint32_t size) {
+		ConvertArray<int8_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayS16(const int16_t* src, const uint32_t size) {
+		ConvertArray<int16_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayS32(const int32_t* src, const uint32_t size) {
+		ConvertArray<int32_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayS64(const int64_t* src, const uint32_t size) {
+		ConvertArray<int64_t>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayF16(const half* src, const uint32_t size) {
+		ConvertArray<half>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayF32(const float* src, const uint32_t size) {
+		ConvertArray<float>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayF64(const double* src, const uint32_t size) {
+		ConvertArray<double>(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayC8(const char* src, const uint32_t size) {
+		_downstream.OnPrimativeArrayC8(src, size);
+	}
+
+	void PrimativeArrayConverter::OnPrimativeArrayBool(const bool* src, const uint32_t size) {
+		_downstream.OnPrimativeArrayBool(src, size);
+	}
+
+}}
@@ -0,0 +1,356 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include <functional>
+#include <queue>
+#include "anvil/byte-pipe/BytePipeHuffman.hpp"
+#include "anvil/byte-pipe/BytePipeBits.hpp"
+#include "anvil/byte-pipe/BytePipeEndian.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static ANVIL_CONSTEXPR const uint32_t g_huffman_table_size = 1u << HuffmanEncoderPipe::MAX_CODE_LENGTH;
+		static ANVIL_CONSTEXPR const uint32_t g_huffman_length_bytes = 128u;	//!< 4 bits for each of the 256 byte values
+		static ANVIL_CONSTEXPR const uint32_t g_huffman_slack = 8u;			//!< Zero bytes after the codes so that the decoder can always read 8 bytes
+		static ANVIL_CONSTEXPR const uint32_t g_huffman_raw_flag = 1u << 31u;
+
+		static inline uint32_t ReadLittleEndian32(const uint8_t* src) {
+			return static_cast<uint32_t>(src[0u]) | (static_cast<uint32_t>(src[1u]) << 8u) | (static_cast<uint32_t>(src[2u]) << 16u) | (static_cast<uint32_t>(src[3u]) << 24u);
+		}
+
+		static inline void WriteLittleEndian32(uint8_t* dst, const uint32_t value) {
+			dst[0u] = static_cast<uint8_t>(value);
+			dst[1u] = static_cast<uint8_t>(value >> 8u);
+			dst[2u] = static_cast<uint8_t>(value >> 16u);
+			dst[3u] = static_cast<uint8_t>(value >> 24u);
+		}
+
+		static inline uint32_t GetMaxCompressedBytes(const uint32_t bytes) {
+			return g_huffman_length_bytes + static_cast<uint32_t>((static_cast<uint64_t>(bytes) * HuffmanEncoderPipe::MAX_CODE_LENGTH + 7u) / 8u);
+		}
+
+		// Returns the next MAX_CODE_LENGTH bits, starting from a bit offset
+		static inline uint32_t PeekBits(const uint8_t* src, const uint32_t bit) {
+			uint64_t word;
+			memcpy(&word, src + bit / 8u, sizeof(word));
+			if (GetEndianness() == ENDIAN_LITTLE) word = SwapByteOrder(word);
+			return static_cast<uint32_t>((word << (bit % 8u)) >> (64u - HuffmanEncoderPipe::MAX_CODE_LENGTH));
+		}
+
+		static void BuildHuffmanCodeLengths(const uint32_t* frequencies, uint8_t* lengths) {
+			typedef std::pair<uint64_t, uint32_t> Node;	// Frequency, node index
+			std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+			uint32_t parents[511u];
+			uint32_t node_count = 256u;
+
+			memset(lengths, 0, 256u);
+			for (uint32_t i = 0u; i < 256u; ++i) if (frequencies[i] > 0u) queue.push(Node(frequencies[i], i));
+
+			// A single byte value still needs a code
+			if (queue.size() == 1u) {
+				lengths[queue.top().second] = 1u;
+				return;
+			}
+
+			// Combine the two least frequent nodes until there is one tree
+			while (queue.size() > 1u) {
+				const Node a = queue.top();
+				queue.pop();
+				const Node b = queue.top();
+				queue.pop();
+				parents[a.second] = node_count;
+				parents[b.second] = node_count;
+				queue.push(Node(a.first + b.first, node_count));
+				++node_count;
+			}
+
+			// The length of a code is the depth of its byte in the tree
+			const uint32_t root = node_count - 1u;
+			for (uint32_t i = 0u; i < 256u; ++i) {
+				if (frequencies[i] == 0u) continue;
+				uint32_t length = 0u;
+				for (uint32_t node = i; node != root; node = parents[node]) ++length;
+				lengths[i] = static_cast<uint8_t>(length > 255u ? 255u : length);
+			}
+		}
+
+		static void BuildLengthLimitedCodeLengths(const uint32_t* histogram, uint8_t* lengths) {
+			uint32_t frequencies[256u];
+			memcpy(frequencies, histogram, sizeof(frequencies));
+			while (true) {
+				BuildHuffmanCodeLengths(frequencies, lengths);
+				uint32_t max_length = 0u;
+				for (uint32_t i = 0u; i < 256u; ++i) if (lengths[i] > max_length) max_length = lengths[i];
+				if (max_length <= HuffmanEncoderPipe::MAX_CODE_LENGTH) return;
+
+				// Flatten the distribution until the longest code fits, bytes that are used keep a frequency of at least 1
+				for (uint32_t i = 0u; i < 256u; ++i) if (frequencies[i] > 0u) frequencies[i] = (frequencies[i] >> 1u) | 1u;
+			}
+		}
+
+		// Returns false if the lengths do not describe a valid prefix code
+		static bool BuildCanonicalCodes(const uint8_t* lengths, uint16_t* codes) {
+			uint32_t length_count[HuffmanEncoderPipe::MAX_CODE_LENGTH + 1u] = {};
+			for (uint32_t i = 0u; i < 256u; ++i) ++length_count[lengths[i]];
+			length_count[0u] = 0u;
+
+			uint32_t next_code[HuffmanEncoderPipe::MAX_CODE_LENGTH + 1u];
+			uint32_t code = 0u;
+			for (uint32_t length = 1u; length <= HuffmanEncoderPipe::MAX_CODE_LENGTH; ++length) {
+				code = (code + length_count[length - 1u]) << 1u;
+				next_code[length] = code;
+				if (code + length_count[length] > (1u << length)) return false;
+			}
+
+			for (uint32_t i = 0u; i < 256u; ++i) if (lengths[i] > 0u) codes[i] = static_cast<uint16_t>(next_code[lengths[i]]++);
+			return true;
+		}
+	}
+
+	// HuffmanEncoderPipe
+
+	HuffmanEncoderPipe::HuffmanEncoderPipe(OutputPipe& output, const uint32_t block_size) :
+		_output(output),
+		_block_size(block_size),
+		_used_bytes(0u)
+	{
+		if (block_size == 0u || block_size > MAX_BLOCK_SIZE) throw std::runtime_error("HuffmanEncoderPipe::HuffmanEncoderPipe : Block size must be between 1 and MAX_BLOCK_SIZE");
+		_block.resize(block_size);
+		_compressed.resize(8u + detail::GetMaxCompressedBytes(block_size));
+	}
+
+	HuffmanEncoderPipe::~HuffmanEncoderPipe() {
+		if (_Flush()) _output.Flush();
+	}
+
+	uint32_t HuffmanEncoderPipe::CompressBlock() {
+		const uint8_t* const src = _block.data();
+		const uint32_t size = _used_bytes;
+
+		// Count the bytes in 4 histograms, so that repeated bytes do not wait for the previous count to be stored
+		uint32_t histograms[4u][256u] = {};
+		uint32_t i = 0u;
+		for (; i + 4u <= size; i += 4u) {
+			++histograms[0u][src[i]];
+			++histograms[1u][src[i + 1u]];
+			++histograms[2u][src[i + 2u]];
+			++histograms[3u][src[i + 3u]];
+		}
+		for (; i < size; ++i) ++histograms[0u][src[i]];
+		for (uint32_t j = 0u; j < 256u; ++j) histograms[0u][j] += histograms[1u][j] + histograms[2u][j] + histograms[3u][j];
+
+		uint8_t lengths[256u];
+		uint16_t codes[256u];
+		detail::BuildLengthLimitedCodeLengths(histograms[0u], lengths);
+		detail::BuildCanonicalCodes(lengths, codes);
+
+		// Return early if the codes would be larger than the block
+		uint64_t bits = 0u;
+		for (uint32_t j = 0u; j < 256u; ++j) bits += static_cast<uint64_t>(histograms[0u][j]) * lengths[j];
+		const uint64_t compressed_bytes = detail::g_huffman_length_bytes + (bits + 7u) / 8u;
+		if (compressed_bytes >= size) return static_cast<uint32_t>(compressed_bytes);
+
+		BitOutputStream stream(_compressed.data() + 8u);
+		for (uint32_t j = 0u; j < 256u; ++j) stream.WriteBits(lengths[j], 4u);
+		for (uint32_t j = 0u; j < size; ++j) stream.WriteBits(codes[src[j]], lengths[src[j]]);
+		return static_cast<uint32_t>(stream.Flush() - (_compressed.data() + 8u));
+	}
+
+	bool HuffmanEncoderPipe::_Flush() {
+		if (_used_bytes == 0u) return false;
+
+		// The header is written in front of the compressed block so that the block is written in one call
+		const uint32_t compressed_bytes = CompressBlock();
+		if (compressed_bytes >= _used_bytes) {
+			// Store the block without compression
+			uint8_t header[8u];
+			detail::WriteLittleEndian32(header, _used_bytes | detail::g_huffman_raw_flag);
+			detail::WriteLittleEndian32(header + 4u, _used_bytes);
+			_output.WriteBytes(header, 8u);
+			_output.WriteBytes(_block.data(), _used_bytes);
+		} else {
+			detail::WriteLittleEndian32(_compressed.data(), compressed_bytes);
+			detail::WriteLittleEndian32(_compressed.data() + 4u, _used_bytes);
+			_output.WriteBytes(_compressed.data(), compressed_bytes + 8u);
+		}
+
+		_used_bytes = 0u;
+		return true;
+	}
+
+	uint32_t HuffmanEncoderPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		uint32_t bytes_remaining = bytes;
+		while (bytes_remaining > 0u) {
+			uint32_t count = _block_size - _used_bytes;
+			if (count > bytes_remaining) count = bytes_remaining;
+			memcpy(_block.data() + _used_bytes, src8, count);
+			_used_bytes += count;
+			src8 += count;
+			bytes_remaining -= count;
+			if (_used_bytes == _block_size) _Flush();
+		}
+		return bytes;
+	}
+
+	void HuffmanEncoderPipe::Flush() {
+		if (_Flush()) _output.Flush();
+	}
+
+	// HuffmanDecoderPipe
+
+	HuffmanDecoderPipe::HuffmanDecoderPipe(InputPipe& input) :
+		_input(input),
+		_symbol_table(detail::g_huffman_table_size),
+		_multi_symbol_table(detail::g_huffman_table_size),
+		_block_bytes(0u),
+		_read_bytes(0u)
+	{}
+
+	HuffmanDecoderPipe::~HuffmanDecoderPipe() {
+
+	}
+
+	void HuffmanDecoderPipe::DecompressBlock(const uint32_t compressed_bytes) {
+		ANVIL_CONSTEXPR const uint32_t max_length = HuffmanEncoderPipe::MAX_CODE_LENGTH;
+		if (compressed_bytes < detail::g_huffman_length_bytes) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Block is too small to contain the code lengths");
+
+		// Rebuild the codes
+		uint8_t lengths[256u];
+		uint16_t codes[256u];
+		BitInputStream stream(_compressed.data());
+		for (uint32_t i = 0u; i < 256u; ++i) {
+			lengths[i] = static_cast<uint8_t>(stream.ReadBits(4u));
+			if (lengths[i] > max_length) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Code is longer than MAX_CODE_LENGTH");
+		}
+		if (! detail::BuildCanonicalCodes(lengths, codes)) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Code lengths are not valid");
+
+		// Each index of the table starts with the code it contains, indices that do not start with a code are 0
+		uint16_t* const symbol_table = _symbol_table.data();
+		memset(symbol_table, 0, detail::g_huffman_table_size * sizeof(uint16_t));
+		for (uint32_t i = 0u; i < 256u; ++i) {
+			if (lengths[i] == 0u) continue;
+			const uint32_t first = static_cast<uint32_t>(codes[i]) << (max_length - lengths[i]);
+			const uint32_t last = first + (1u << (max_length - lengths[i]));
+			for (uint32_t j = first; j < last; ++j) symbol_table[j] = static_cast<uint16_t>(i | (lengths[i] << 8u));
+		}
+
+		// Find up to 3 codes in each index, bits after the end of the index are zero so later codes must fit completely
+		uint32_t* const multi_symbol_table = _multi_symbol_table.data();
+		for (uint32_t i = 0u; i < detail::g_huffman_table_size; ++i) {
+			uint32_t entry = 0u;
+			uint32_t count = 0u;
+			uint32_t bits = 0u;
+			while (count < 3u) {
+				const uint32_t symbol = symbol_table[((i << bits) & (detail::g_huffman_table_size - 1u))];
+				const uint32_t length = symbol >> 8u;
+				if (length == 0u || bits + length > max_length) break;
+				entry |= (symbol & 255u) << (count * 8u);
+				bits += length;
+				++count;
+			}
+			multi_symbol_table[i] = entry | (count << 24u) | (bits << 26u);
+		}
+
+		// Decode the bytes
+		const uint8_t* const src = _compressed.data() + detail::g_huffman_length_bytes;
+		const uint32_t src_bits = (compressed_bytes - detail::g_huffman_length_bytes) * 8u;
+		uint8_t* out = _block.data();
+		uint8_t* const out_end = out + _block_bytes;
+		uint32_t bit = 0u;
+
+		while (out_end - out >= 3 && bit <= src_bits) {
+			const uint32_t entry = multi_symbol_table[detail::PeekBits(src, bit)];
+			const uint32_t count = (entry >> 24u) & 3u;
+			if (count == 0u) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Block contains an invalid code");
+			out[0u] = static_cast<uint8_t>(entry);
+			out[1u] = static_cast<uint8_t>(entry >> 8u);
+			out[2u] = static_cast<uint8_t>(entry >> 16u);
+			out += count;
+			bit += entry >> 26u;
+		}
+
+		while (out < out_end && bit <= src_bits) {
+			const uint32_t symbol = symbol_table[detail::PeekBits(src, bit)];
+			if (symbol == 0u) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Block contains an invalid code");
+			*out = static_cast<uint8_t>(symbol);
+			++out;
+			bit += symbol >> 8u;
+		}
+
+		if (bit > src_bits || out != out_end) throw std::runtime_error("HuffmanDecoderPipe::DecompressBlock : Block ends in the middle of a code");
+	}
+
+	bool HuffmanDecoderPipe::ReadNextBlock() {
+		uint8_t header[8u];
+		const uint32_t bytes_read = _input.ReadBytes(header, 8u);
+		if (bytes_read == 0u) return false;
+		if (bytes_read != 8u) throw std::runtime_error("HuffmanDecoderPipe::ReadNextBlock : Failed to read block header");
+
+		const uint32_t stored_bytes = detail::ReadLittleEndian32(header) & ~detail::g_huffman_raw_flag;
+		const bool raw = (detail::ReadLittleEndian32(header) & detail::g_huffman_raw_flag) != 0u;
+		const uint32_t block_bytes = detail::ReadLittleEndian32(header + 4u);
+		if (block_bytes > HuffmanEncoderPipe::MAX_BLOCK_SIZE) throw std::runtime_error("HuffmanDecoderPipe::ReadNextBlock : Block is larger than MAX_BLOCK_SIZE");
+		if (raw ? stored_bytes != block_bytes : stored_bytes > detail::GetMaxCompressedBytes(block_bytes)) throw std::runtime_error("HuffmanDecoderPipe::ReadNextBlock : Block header is not valid");
+
+		// Buffers are only reallocated when a larger block is read
+		if (_block.size() < block_bytes) _block.resize(block_bytes);
+		_block_bytes = block_bytes;
+		_read_bytes = 0u;
+
+		if (raw) {
+			if (_input.ReadBytes(_block.data(), block_bytes) != block_bytes) throw std::runtime_error("HuffmanDecoderPipe::ReadNextBlock : Failed to read block");
+		} else {
+			if (_compressed.size() < stored_bytes + detail::g_huffman_slack) _compressed.resize(stored_bytes + detail::g_huffman_slack);
+			if (_input.ReadBytes(_compressed.data(), stored_bytes) != stored_bytes) throw std::runtime_error("HuffmanDecoderPipe::ReadNextBlock : Failed to read block");
+			memset(_compressed.data() + stored_bytes, 0, detail::g_huffman_slack);
+			DecompressBlock(stored_bytes);
+		}
+		return true;
+	}
+
+	uint32_t HuffmanDecoderPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		uint8_t* dst8 = static_cast<uint8_t*>(dst);
+		uint32_t bytes_remaining = bytes;
+		while (bytes_remaining > 0u) {
+			if (_read_bytes == _block_bytes) {
+				if (! ReadNextBlock()) break;
+				continue;
+			}
+
+			uint32_t count = _block_bytes - _read_bytes;
+			if (count > bytes_remaining) count = bytes_remaining;
+			memcpy(dst8, _block.data() + _read_bytes, count);
+			_read_bytes += count;
+			dst8 += count;
+			bytes_remaining -= count;
+		}
+		return bytes - bytes_remaining;
+	}
+
+	const void* HuffmanDecoderPipe::ReadBytesZeroCopy(const uint32_t bytes) {
+		if (_read_bytes == _block_bytes && bytes > 0u) {
+			if (! ReadNextBlock()) return nullptr;
+		}
+		if (bytes > _block_bytes - _read_bytes) return nullptr;
+		const void* const src = _block.data() + _read_bytes;
+		_read_bytes += bytes;
+		return src;
+	}
+
+}}
@@ -12,107 +12,347 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include "anvil/byte-pipe/BytePipeJSON.hpp"
+#include "anvil/byte-pipe/BytePipeBase64.hpp"
+
+#if ANVIL_BYTEPIPE_SSE2 || ANVIL_BYTEPIPE_AVX2
+	#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
 
 namespace anvil { namespace BytePipe {
 
-	static char ToHex(uint32_t nybble) {
-		return nybble <= 9 ?
-			'0' + nybble :
-			'A' + (nybble - 9);
+	// Number formatting
+
+	// Two characters for every number from 0 to 99, so that integers can be formatted two digits at a time
+	static ANVIL_CONSTEXPR const char g_digit_pairs[201] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	static char* FormatU64(uint64_t value, char* out) {
+		char tmp[20u];
+		char* i = tmp + 20u;
+
+		while (value >= 100u) {
+			const uint32_t pair = static_cast<uint32_t>(value % 100u) * 2u;
+			value /= 100u;
+			i -= 2u;
+			i[0u] = g_digit_pairs[pair];
+			i[1u] = g_digit_pairs[pair + 1u];
+		}
+
+		if (value < 10u) {
+			*--i = static_cast<char>('0' + value);
+		} else {
+			const uint32_t pair = static_cast<uint32_t>(value) * 2u;
+			i -= 2u;
+			i[0u] = g_digit_pairs[pair];
+			i[1u] = g_digit_pairs[pair + 1u];
+		}
+
+		const size_t length = (tmp + 20u) - i;
+		memcpy(out, i, length);
+		return out + length;
 	}
 
-	static inline void ToHex(uint32_t byte, char* out) {
-		out[0u] = ToHex(byte & 15u);
-		out[1u] = ToHex(byte >> 4u);
+	static char* FormatS64(const int64_t value, char* out) {
+		if (value < 0) {
+			*out = '-';
+			return FormatU64(0ull - static_cast<uint64_t>(value), out + 1u);
+		}
+		return FormatU64(static_cast<uint64_t>(value), out);
 	}
 
-	JsonWriter::JsonWriter() {
+	template<class T>
+	static char* FormatFloat(const T value, char* out) {
+		// JSON does not support NaN or infinity
+		if (! std::isfinite(value)) {
+			memcpy(out, "null", 4u);
+			return out + 4u;
+		}
+
+		// Shortest representation that will read back as the same value, without allocating memory
+		return std::to_chars(out, out + 32u, value).ptr;
+	}
 
+	template<class T>
+	static inline char* FormatNumber(const T value, char* out) {
+		if ANVIL_CONSTEXPR (std::is_floating_point<T>::value) {
+			return FormatFloat<T>(value, out);
+		} else if ANVIL_CONSTEXPR (std::is_signed<T>::value) {
+			return FormatS64(static_cast<int64_t>(value), out);
+		} else {
+			return FormatU64(static_cast<uint64_t>(value), out);
+		}
 	}
 
+	// JsonWriter
+
+	JsonWriter::JsonWriter() :
+		JsonWriter(std::pmr::get_default_resource())
+	{}
+
+	JsonWriter::JsonWriter(std::pmr::memory_resource* resource) :
+		_out(resource),
+		_pipe(nullptr),
+		_buffer_size(0u),
+		_separator_required(false),
+		_byte_array_format(BYTE_ARRAY_NUMBERS)
+	{}
+
+	JsonWriter::JsonWriter(OutputPipe& pipe) :
+		_pipe(&pipe),
+		_buffer_size(0u),
+		_separator_required(false),
+		_byte_array_format(BYTE_ARRAY_NUMBERS)
+	{}
+
 	JsonWriter::~JsonWriter() {
 
 	}
 
-	const std::string& JsonWriter::GetJSON() const {
-		if (_out.back() == ',') _out.pop_back();
+	const std::pmr::string& JsonWriter::GetJSON() const {
+		FlushBuffer();
 		return _out;
 	}
 
+	void JsonWriter::SetByteArrayFormat(const ByteArrayFormat format) {
+		_byte_array_format = format;
+	}
+
+	void JsonWriter::FlushBuffer() const {
+		if (_buffer_size == 0u) return;
+
+		if (_pipe) {
+			const uint32_t bytes_written = _pipe->WriteBytes(_buffer, _buffer_size);
+			if (bytes_written != _buffer_size) throw std::runtime_error("JsonWriter::FlushBuffer : Failed to write to pipe");
+		} else {
+			_out.append(_buffer, _buffer_size);
+		}
+		_buffer_size = 0u;
+	}
+
+	void JsonWriter::Write(const char* src, size_t bytes) {
+		while (bytes > 0u) {
+			if (_buffer_size == BUFFER_SIZE) FlushBuffer();
+
+			size_t bytes_to_copy = BUFFER_SIZE - _buffer_size;
+			if (bytes < bytes_to_copy) bytes_to_copy = bytes;
+
+			memcpy(_buffer + _buffer_size, src, bytes_to_copy);
+			_buffer_size += static_cast<uint32_t>(bytes_to_copy);
+			src += bytes_to_copy;
+			bytes -= bytes_to_copy;
+		}
+	}
+
+	char* JsonWriter::Reserve(const uint32_t bytes) {
+		if (BUFFER_SIZE - _buffer_size < bytes) FlushBuffer();
+		return _buffer + _buffer_size;
+	}
+
+	void JsonWriter::BeginValue() {
+		if (_separator_required) {
+			*Reserve(1u) = ',';
+			++_buffer_size;
+		}
+		_separator_required = true;
+	}
+
+	void JsonWriter::WriteHex(const void* src, size_t bytes) {
+		// Encode directly into the buffer, in blocks that fit
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		while (bytes > 0u) {
+			if (BUFFER_SIZE - _buffer_size < 2u) FlushBuffer();
+
+			size_t bytes_to_encode = (BUFFER_SIZE - _buffer_size) / 2u;
+			if (bytes_to_encode > bytes) bytes_to_encode = bytes;
+
+			_buffer_size += static_cast<uint32_t>(EncodeHex(src8, bytes_to_encode, _buffer + _buffer_size));
+			src8 += bytes_to_encode;
+			bytes -= bytes_to_encode;
+		}
+	}
+
+	void JsonWriter::WriteBase64(const void* src, size_t bytes) {
+		// Encode directly into the buffer, every block except the last is a multiple of 3 bytes so that there is no padding
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		while (bytes > 0u) {
+			if (BUFFER_SIZE - _buffer_size < 4u) FlushBuffer();
+
+			size_t bytes_to_encode = ((BUFFER_SIZE - _buffer_size) / 4u) * 3u;
+			if (bytes_to_encode > bytes) bytes_to_encode = bytes;
+
+			_buffer_size += static_cast<uint32_t>(EncodeBase64(src8, bytes_to_encode, _buffer + _buffer_size));
+			src8 += bytes_to_encode;
+			bytes -= bytes_to_encode;
+		}
+	}
+
+	template<class T>
+	void JsonWriter::WriteNumber(const T value) {
+		BeginValue();
+		char* const begin = Reserve(MAX_NUMBER_LENGTH);
+		_buffer_size += static_cast<uint32_t>(FormatNumber<T>(value, begin) - begin);
+	}
+
+	template<class T>
+	void JsonWriter::WriteNumberArray(const T* src, const uint32_t size) {
+		BeginValue();
+
+		*Reserve(1u) = '[';
+		++_buffer_size;
+
+		for (uint32_t i = 0u; i < size; ++i) {
+			char* const begin = Reserve(MAX_NUMBER_LENGTH + 1u);
+			char* end = begin;
+			if (i > 0u) *end++ = ',';
+			end = FormatNumber<T>(src[i], end);
+			_buffer_size += static_cast<uint32_t>(end - begin);
+		}
+
+		*Reserve(1u) = ']';
+		++_buffer_size;
+	}
+
 	// Inherited from Parser
 
 	void JsonWriter::OnPipeOpen() {
 		// Reset object state
 		_out.clear();
+		_buffer_size = 0u;
+		_separator_required = false;
 	}
 
 	void JsonWriter::OnPipeClose() {
-		// Do nothing
+		FlushBuffer();
+		if (_pipe) _pipe->Flush();
 	}
 
 	void JsonWriter::OnArrayBegin(const uint32_t size) {
-		_out += '[';
+		BeginValue();
+		Write("[", 1u);
+		_separator_required = false;
 	}
 
 	void JsonWriter::OnArrayEnd() {
-		if (_out.back() == ',') _out.pop_back();
-		_out += ']';
+		Write("]", 1u);
+		_separator_required = true;
 	}
 
 	void JsonWriter::OnObjectBegin(const uint32_t component_count) {
-		_out += '{';
+		BeginValue();
+		Write("{", 1u);
+		_separator_required = false;
 	}
 
 	void JsonWriter::OnObjectEnd() {
-		if (_out.back() == ',') _out.pop_back();
-		_out += '}';
+		Write("}", 1u);
+		_separator_required = true;
 	}
 
 	void JsonWriter::OnComponentID(const ComponentID id) {
-		_out += '"' + std::to_string(id) + "\":";
-	}
-
-	void JsonWriter::AddValue(const std::string& val) {
-		_out += val;
-		_out += ",";
-	}
+		// Write the key as "id":
+		BeginValue();
+		char* const begin = Reserve(MAX_NUMBER_LENGTH + 3u);
+		char* end = begin;
+		*end++ = '"';
+		end = FormatU64(id, end);
+		*end++ = '"';
+		*end++ = ':';
+		_buffer_size += static_cast<uint32_t>(end - begin);
 
-	void JsonWriter::AddValueC(const char* val) {
-		_out += val;
-		_out += ",";
+		// The value follows the key without a comma
+		_separator_required = false;
 	}
 
 	void JsonWriter::OnUserPOD(const uint32_t type, const uint32_t bytes, const void* data) {
 		// Format the POD as an object, a POD is identified by containg the member __ANVIL_POD with the value 123456789
-		std::string value = "{\"__ANVIL_POD\":123456789,\"type\":" + std::to_string(type) + ",\data\":\"";
+		BeginValue();
+		Write("{\"__ANVIL_POD\":123456789,\"type\":", 32u);
+		{
+			char* const begin = Reserve(MAX_NUMBER_LENGTH);
+			_buffer_size += static_cast<uint32_t>(FormatU64(type, begin) - begin);
+		}
+		Write(",\"data\":\"", 9u);
 
 		// Store the binary data as hexidecimal
-		char buffer[3u] = "??";
-		for (uint32_t i = 0u; i < bytes; ++i) {
-			ToHex(reinterpret_cast<const uint8_t*>(data)[i], buffer);
-			value += buffer;
-		}
-		value += "\"}";
-		
-		// Add the value
-		AddValue(value);
+		WriteHex(data, bytes);
+		Write("\"}", 2u);
 	}
 
 	void JsonWriter::OnNull() {
-		AddValueC("null");
+		BeginValue();
+		Write("null", 4u);
 	}
 
 	void JsonWriter::OnPrimativeF64(const double value) {
-		AddValue(std::to_string(value));
+		WriteNumber<double>(value);
 	}
 
 	void JsonWriter::OnPrimativeString(const char* value, const uint32_t length) {
-		AddValue(std::string(value, value + length));
+		BeginValue();
+		Write("\"", 1u);
+
+		// Copy runs of characters that don't need to be escaped in one call
+		const char* run = value;
+		const char* const end = value + length;
+		for (const char* i = value; i < end; ++i) {
+			const uint8_t c = static_cast<uint8_t>(*i);
+			if (c >= 32u && c != '"' && c != '\\') continue;
+
+			Write(run, i - run);
+			run = i + 1u;
+
+			char escape[6u] = { '\\', 'u', '0', '0', '?', '?' };
+			switch (c) {
+			case '"':
+			case '\\':
+				escape[1u] = static_cast<char>(c);
+				Write(escape, 2u);
+				break;
+			case '\n':
+				Write("\\n", 2u);
+				break;
+			case '\r':
+				Write("\\r", 2u);
+				break;
+			case '\t':
+				Write("\\t", 2u);
+				break;
+			default:
+				escape[4u] = "0123456789abcdef"[c >> 4u];
+				escape[5u] = "0123456789abcdef"[c & 15u];
+				Write(escape, 6u);
+				break;
+			}
+		}
+		Write(run, end - run);
+
+		Write("\"", 1u);
 	}
 
 	void JsonWriter::OnPrimativeBool(const bool value) {
-		AddValueC(value ? "true" : "false");
+		BeginValue();
+		if (value) {
+			Write("true", 4u);
+		} else {
+			Write("false", 5u);
+		}
 	}
 
 	void JsonWriter::OnPrimativeC8(const char value) {
@@ -120,39 +360,806 @@ namespace anvil { namespace BytePipe {
 	}
 
 	void JsonWriter::OnPrimativeU64(const uint64_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<uint64_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeS64(const int64_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<int64_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeF32(const float value) {
-		AddValue(std::to_string(value));
+		WriteNumber<float>(value);
 	}
 
 	void JsonWriter::OnPrimativeU8(const uint8_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<uint8_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeU16(const uint16_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<uint16_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeU32(const uint32_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<uint32_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeS8(const int8_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<int8_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeS16(const int16_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<int16_t>(value);
 	}
 
 	void JsonWriter::OnPrimativeS32(const int32_t value) {
-		AddValue(std::to_string(value));
+		WriteNumber<int32_t>(value);
+	}
+
+	void JsonWriter::OnPrimativeArrayU8(const uint8_t* src, const uint32_t size) {
+		if (_byte_array_format == BYTE_ARRAY_BASE64) {
+			// Format the bytes as an object, identified in the same way as a POD
+			BeginValue();
+			Write("{\"__ANVIL_BYTES\":123456789,\"data\":\"", 35u);
+			WriteBase64(src, size);
+			Write("\"}", 2u);
+		} else {
+			WriteNumberArray<uint8_t>(src, size);
+		}
+	}
+
+	void JsonWriter::OnPrimativeArrayU16(const uint16_t* src, const uint32_t size) {
+		WriteNumberArray<uint16_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayU32(const uint32_t* src, const uint32_t size) {
+		WriteNumberArray<uint32_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayU64(const uint64_t* src, const uint32_t size) {
+		WriteNumberArray<uint64_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayS8(const int8_t* src, const uint32_t size) {
+		WriteNumberArray<int8_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayS16(const int16_t* src, const uint32_t size) {
+		WriteNumberArray<int16_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayS32(const int32_t* src, const uint32_t size) {
+		WriteNumberArray<int32_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayS64(const int64_t* src, const uint32_t size) {
+		WriteNumberArray<int64_t>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayF32(const float* src, const uint32_t size) {
+		WriteNumberArray<float>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayF64(const double* src, const uint32_t size) {
+		WriteNumberArray<double>(src, size);
+	}
+
+	void JsonWriter::OnPrimativeArrayBool(const bool* src, const uint32_t size) {
+		BeginValue();
+		Write("[", 1u);
+		for (uint32_t i = 0u; i < size; ++i) {
+			if (i > 0u) Write(",", 1u);
+			if (src[i]) {
+				Write("true", 4u);
+			} else {
+				Write("false", 5u);
+			}
+		}
+		Write("]", 1u);
+	}
+
+	// JsonReader
+
+	namespace detail {
+		// Bitmasks that classify each character in a 64 byte block of JSON
+		struct JsonBlock {
+			uint64_t quote;			//!< "
+			uint64_t backslash;		//!< Backslash
+			uint64_t op;			//!< { } [ ] : ,
+			uint64_t whitespace;	//!< Space, tab, new line and carriage return
+		};
+
+		static inline uint32_t CountTrailingZeros(const uint64_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, bits);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+		}
+
+#if ANVIL_BYTEPIPE_AVX2
+		static inline uint64_t ClassifyMask(const __m256i lo, const __m256i hi, const char c) {
+			const __m256i mask = _mm256_set1_epi8(c);
+			const uint64_t a = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, mask)));
+			const uint64_t b = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, mask)));
+			return a | (b << 32ull);
+		}
+
+		static inline void ClassifyBlock(const char* src, JsonBlock& block) {
+			const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32u));
+
+			// Setting bit 5 maps [ to { and ] to }
+			const __m256i bit5 = _mm256_set1_epi8(0x20);
+			const __m256i lo_lower = _mm256_or_si256(lo, bit5);
+			const __m256i hi_lower = _mm256_or_si256(hi, bit5);
+
+			block.quote = ClassifyMask(lo, hi, '"');
+			block.backslash = ClassifyMask(lo, hi, '\\');
+			block.op = ClassifyMask(lo_lower, hi_lower, '{') | ClassifyMask(lo_lower, hi_lower, '}') | ClassifyMask(lo, hi, ':') | ClassifyMask(lo, hi, ',');
+			block.whitespace = ClassifyMask(lo, hi, ' ') | ClassifyMask(lo, hi, '\t') | ClassifyMask(lo, hi, '\n') | ClassifyMask(lo, hi, '\r');
+		}
+#elif ANVIL_BYTEPIPE_SSE2
+		static inline uint64_t ClassifyMask(const __m128i* v, const char c) {
+			const __m128i mask = _mm_set1_epi8(c);
+			const uint64_t a = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[0u], mask)));
+			const uint64_t b = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[1u], mask)));
+			const uint64_t c2 = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[2u], mask)));
+			const uint64_t d = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[3u], mask)));
+			return a | (b << 16ull) | (c2 << 32ull) | (d << 48ull);
+		}
+
+		static inline void ClassifyBlock(const char* src, JsonBlock& block) {
+			__m128i v[4u];
+			__m128i lower[4u];
+
+			// Setting bit 5 maps [ to { and ] to }
+			const __m128i bit5 = _mm_set1_epi8(0x20);
+			for (uint32_t i = 0u; i < 4u; ++i) {
+				v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 16u));
+				lower[i] = _mm_or_si128(v[i], bit5);
+			}
+
+			block.quote = ClassifyMask(v, '"');
+			block.backslash = ClassifyMask(v, '\\');
+			block.op = ClassifyMask(lower, '{') | ClassifyMask(lower, '}') | ClassifyMask(v, ':') | ClassifyMask(v, ',');
+			block.whitespace = ClassifyMask(v, ' ') | ClassifyMask(v, '\t') | ClassifyMask(v, '\n') | ClassifyMask(v, '\r');
+		}
+#else
+		static inline void ClassifyBlock(const char* src, JsonBlock& block) {
+			block.quote = 0u;
+			block.backslash = 0u;
+			block.op = 0u;
+			block.whitespace = 0u;
+			for (uint32_t i = 0u; i < 64u; ++i) {
+				const uint64_t bit = 1ull << i;
+				switch (src[i]) {
+				case '"':
+					block.quote |= bit;
+					break;
+				case '\\':
+					block.backslash |= bit;
+					break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',':
+					block.op |= bit;
+					break;
+				case ' ':
+				case '\t':
+				case '\n':
+				case '\r':
+					block.whitespace |= bit;
+					break;
+				}
+			}
+		}
+#endif
+
+		// Returns a mask of the characters that are escaped by an odd length sequence of backslashes
+		static inline uint64_t FindEscapedCharacters(const uint64_t backslash, uint64_t& prev_ends_odd_backslash) {
+			enum : uint64_t {
+				EVEN_BITS = 0x5555555555555555ull,
+				ODD_BITS = ~EVEN_BITS
+			};
+
+			const uint64_t start_edges = backslash & ~(backslash << 1ull);
+			const uint64_t even_start_mask = EVEN_BITS ^ prev_ends_odd_backslash;
+			const uint64_t even_starts = start_edges & even_start_mask;
+			const uint64_t odd_starts = start_edges & ~even_start_mask;
+			const uint64_t even_carries = backslash + even_starts;
+
+			uint64_t odd_carries = backslash + odd_starts;
+			const bool ends_odd_backslash = odd_carries < backslash;
+			odd_carries |= prev_ends_odd_backslash;
+			prev_ends_odd_backslash = ends_odd_backslash ? 1ull : 0ull;
+
+			const uint64_t even_carry_ends = even_carries & ~backslash;
+			const uint64_t odd_carry_ends = odd_carries & ~backslash;
+			return (even_carry_ends & ODD_BITS) | (odd_carry_ends & EVEN_BITS);
+		}
+
+		// Each bit is set if there are an odd number of set bits at or below it
+		static inline uint64_t PrefixXor(uint64_t bits) {
+			bits ^= bits << 1ull;
+			bits ^= bits << 2ull;
+			bits ^= bits << 4ull;
+			bits ^= bits << 8ull;
+			bits ^= bits << 16ull;
+			bits ^= bits << 32ull;
+			return bits;
+		}
+
+		static inline uint32_t FromHex(const char c) {
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'A' && c <= 'F') return (c - 'A') + 10;
+			if (c >= 'a' && c <= 'f') return (c - 'a') + 10;
+			throw std::runtime_error("JsonReader : Invalid hexidecimal character");
+		}
+
+		struct JsonNumber {
+			union {
+				uint64_t u64;
+				int64_t s64;
+				double f64;
+			};
+
+			enum : uint8_t {
+				NUMBER_UNSIGNED,
+				NUMBER_SIGNED,
+				NUMBER_FLOAT
+			} type;
+		};
+
+		// Information about an array or object that is calculated before the values are parsed
+		struct JsonContainer {
+			uint32_t size;			//!< The number of values in the array or object
+			bool numeric_array;		//!< True if the container is an array that only contains numbers
+		};
+	}
+
+	class JsonReadHelper {
+	private:
+		enum : uint32_t {
+			PADDING = 64u	//!< Extra bytes after the JSON so that the last block can be read without bounds checking
+		};
+
+		Parser& _parser;
+		std::vector<char> _json;
+		std::vector<uint32_t> _structurals;
+		std::vector<detail::JsonContainer> _containers;
+		std::vector<detail::JsonNumber> _numbers;
+		std::vector<uint64_t> _array_buffer;
+		std::vector<char> _string_buffer;
+		std::vector<uint8_t> _binary_buffer;
+		uint32_t _next_container;
+
+		inline char CharAt(const uint32_t structural) const {
+			return _json[_structurals[structural]];
+		}
+
+		void ReadAll(InputPipe& pipe) {
+			enum : uint32_t { CHUNK_SIZE = 65536u };
+
+			size_t length = 0u;
+			while (true) {
+				_json.resize(length + CHUNK_SIZE);
+				const uint32_t bytes_read = pipe.ReadBytes(_json.data() + length, CHUNK_SIZE);
+				length += bytes_read;
+				if (bytes_read < CHUNK_SIZE) break;
+			}
+
+			if (length > UINT32_MAX - PADDING) throw std::runtime_error("JsonReader::Read : JSON is too large");
+
+			// Pad the end with whitespace up to the next block
+			const size_t padded_length = ((length + PADDING - 1u) / PADDING) * PADDING + PADDING;
+			_json.resize(length);
+			_json.resize(padded_length, ' ');
+		}
+
+		// Stage 1 : Find the structural characters
+		void FindStructuralCharacters() {
+			const size_t length = _json.size() - PADDING;
+			const char* const json = _json.data();
+			_structurals.clear();
+			_structurals.reserve(length / 4u);
+
+			uint64_t prev_ends_odd_backslash = 0u;
+			uint64_t prev_in_string = 0u;
+			uint64_t prev_scalar = 0u;
+
+			for (size_t i = 0u; i < length; i += 64u) {
+				detail::JsonBlock block;
+				detail::ClassifyBlock(json + i, block);
+
+				// Find the quotes that start or end strings
+				const uint64_t escaped = detail::FindEscapedCharacters(block.backslash, prev_ends_odd_backslash);
+				const uint64_t quote = block.quote & ~escaped;
+				const uint64_t in_string = detail::PrefixXor(quote) ^ prev_in_string;
+				prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63ll);
+
+				// Find the first character of each scalar value (numbers, literals and strings)
+				const uint64_t scalar = ~(block.op | block.whitespace);
+				const uint64_t nonquote_scalar = scalar & ~quote;
+				const uint64_t follows_scalar = (nonquote_scalar << 1ull) | prev_scalar;
+				prev_scalar = nonquote_scalar >> 63ull;
+				const uint64_t scalar_start = scalar & ~follows_scalar;
+
+				// Remove anything inside of a string, except the opening quote
+				uint64_t structural = (block.op | scalar_start) & ~(in_string ^ quote);
+
+				while (structural != 0u) {
+					_structurals.push_back(static_cast<uint32_t>(i + detail::CountTrailingZeros(structural)));
+					structural &= structural - 1u;
+				}
+			}
+
+			if (prev_in_string) throw std::runtime_error("JsonReader::Read : Unterminated string");
+		}
+
+		// Stage 2a : Count the number of values in each array and object
+		void CountContainerSizes() {
+			struct Open {
+				uint32_t container;
+				uint32_t structural;
+				uint32_t commas;
+			};
+
+			std::vector<Open> stack;
+			_containers.clear();
+			_next_container = 0u;
+
+			const uint32_t count = static_cast<uint32_t>(_structurals.size());
+			for (uint32_t i = 0u; i < count; ++i) {
+				const char c = CharAt(i);
+				switch (c) {
+				case '{':
+				case '[':
+					if (! stack.empty()) _containers[stack.back().container].numeric_array = false;
+					stack.push_back({ static_cast<uint32_t>(_containers.size()), i, 0u });
+					_containers.push_back({ 0u, c == '[' });
+					break;
+				case '}':
+				case ']':
+					{
+						if (stack.empty()) throw std::runtime_error("JsonReader::Read : Unexpected end of array or object");
+						const Open& open = stack.back();
+						if ((CharAt(open.structural) == '{') != (c == '}')) throw std::runtime_error("JsonReader::Read : Mismatched brackets");
+						_containers[open.container].size = open.structural + 1u == i ? 0u : open.commas + 1u;
+						stack.pop_back();
+					}
+					break;
+				case ',':
+					if (! stack.empty()) ++stack.back().commas;
+					break;
+				case ':':
+					break;
+				default:
+					if (! (stack.empty() || c == '-' || (c >= '0' && c <= '9'))) _containers[stack.back().container].numeric_array = false;
+					break;
+				}
+			}
+
+			if (! stack.empty()) throw std::runtime_error("JsonReader::Read : Unterminated array or object");
+		}
+
+		// Stage 2b : Parse the values
+
+		//! Numbers and literals must be followed by whitespace, a separator or the end of the JSON, which is padded with whitespace
+		static inline bool IsValueEnd(const char c) {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ']' || c == '}';
+		}
+
+		uint32_t ParseNumber(const uint32_t structural, detail::JsonNumber& number) {
+			const char* const begin = _json.data() + _structurals[structural];
+			const char* i = begin;
+
+			const bool negative = *i == '-';
+			if (negative) ++i;
+			if (*i < '0' || *i > '9') throw std::runtime_error("JsonReader::Read : Invalid value");
+			if (*i == '0' && i[1] >= '0' && i[1] <= '9') throw std::runtime_error("JsonReader::Read : Invalid number");
+
+			// Fast path for integers
+			uint64_t value = 0u;
+			bool overflow = false;
+			while (*i >= '0' && *i <= '9') {
+				const uint64_t digit = static_cast<uint64_t>(*i - '0');
+				if (value > (UINT64_MAX - digit) / 10u) overflow = true;
+				value = value * 10u + digit;
+				++i;
+			}
+
+			const bool is_float = *i == '.' || *i == 'e' || *i == 'E';
+			if (! (is_float || IsValueEnd(*i))) throw std::runtime_error("JsonReader::Read : Invalid number");
+			if (! (is_float || overflow) && (! negative || value <= static_cast<uint64_t>(INT64_MAX) + 1u)) {
+				if (negative) {
+					number.s64 = static_cast<int64_t>(0ull - value);
+					number.type = value == 0u ? detail::JsonNumber::NUMBER_UNSIGNED : detail::JsonNumber::NUMBER_SIGNED;
+				} else {
+					number.u64 = value;
+					number.type = detail::JsonNumber::NUMBER_UNSIGNED;
+				}
+				return structural + 1u;
+			}
+
+			// Check the fraction and exponent, from_chars also accepts forms that JSON does not (eg. "1." or "1e")
+			if (*i == '.') {
+				++i;
+				if (*i < '0' || *i > '9') throw std::runtime_error("JsonReader::Read : Invalid number");
+				while (*i >= '0' && *i <= '9') ++i;
+			}
+			if (*i == 'e' || *i == 'E') {
+				++i;
+				if (*i == '+' || *i == '-') ++i;
+				if (*i < '0' || *i > '9') throw std::runtime_error("JsonReader::Read : Invalid number");
+				while (*i >= '0' && *i <= '9') ++i;
+			}
+
+			// Floating point or an integer that is too large
+			const std::from_chars_result result = std::from_chars(begin, i, number.f64);
+			if (result.ec != std::errc() || result.ptr != i || ! IsValueEnd(*i)) throw std::runtime_error("JsonReader::Read : Invalid number");
+			number.type = detail::JsonNumber::NUMBER_FLOAT;
+			return structural + 1u;
+		}
+
+		void OutputNumber(const detail::JsonNumber& number) {
+			switch (number.type) {
+			case detail::JsonNumber::NUMBER_UNSIGNED:
+				if (number.u64 <= UINT8_MAX) _parser.OnPrimativeU8(static_cast<uint8_t>(number.u64));
+				else if (number.u64 <= UINT16_MAX) _parser.OnPrimativeU16(static_cast<uint16_t>(number.u64));
+				else if (number.u64 <= UINT32_MAX) _parser.OnPrimativeU32(static_cast<uint32_t>(number.u64));
+				else _parser.OnPrimativeU64(number.u64);
+				break;
+			case detail::JsonNumber::NUMBER_SIGNED:
+				if (number.s64 >= INT8_MIN) _parser.OnPrimativeS8(static_cast<int8_t>(number.s64));
+				else if (number.s64 >= INT16_MIN) _parser.OnPrimativeS16(static_cast<int16_t>(number.s64));
+				else if (number.s64 >= INT32_MIN) _parser.OnPrimativeS32(static_cast<int32_t>(number.s64));
+				else _parser.OnPrimativeS64(number.s64);
+				break;
+			default:
+				_parser.OnPrimativeF64(number.f64);
+				break;
+			}
+		}
+
+		template<class T>
+		void OutputNumberArray(const uint32_t size) {
+			// Convert directly into the parser's memory if it provides some
+			T* dst = static_cast<T*>(_parser.AcquireArrayBuffer(GetTypeID<T>(), size));
+			if (dst == nullptr) {
+				_array_buffer.resize((size * sizeof(T) + sizeof(uint64_t) - 1u) / sizeof(uint64_t));
+				dst = reinterpret_cast<T*>(_array_buffer.data());
+			}
+			const detail::JsonNumber* const src = _numbers.data();
+
+			for (uint32_t i = 0u; i < size; ++i) {
+				switch (src[i].type) {
+				case detail::JsonNumber::NUMBER_UNSIGNED:
+					dst[i] = static_cast<T>(src[i].u64);
+					break;
+				case detail::JsonNumber::NUMBER_SIGNED:
+					dst[i] = static_cast<T>(src[i].s64);
+					break;
+				default:
+					dst[i] = static_cast<T>(src[i].f64);
+					break;
+				}
+			}
+
+			_parser.OnPrimativeArray(dst, size);
+		}
+
+		uint32_t ParseNumericArray(uint32_t structural, const uint32_t size) {
+			// Parse all of the numbers and find the range of values
+			_numbers.resize(size);
+			uint64_t max_unsigned = 0u;
+			int64_t min_signed = 0;
+			bool is_float = false;
+
+			for (uint32_t i = 0u; i < size; ++i) {
+				if (i > 0u) {
+					if (CharAt(structural) != ',') throw std::runtime_error("JsonReader::Read : Expected ','");
+					++structural;
+				}
+
+				detail::JsonNumber& number = _numbers[i];
+				structural = ParseNumber(structural, number);
+				switch (number.type) {
+				case detail::JsonNumber::NUMBER_UNSIGNED:
+					if (number.u64 > max_unsigned) max_unsigned = number.u64;
+					break;
+				case detail::JsonNumber::NUMBER_SIGNED:
+					if (number.s64 < min_signed) min_signed = number.s64;
+					break;
+				default:
+					is_float = true;
+					break;
+				}
+			}
+
+			// Output the smallest type that can represent all of the values
+			if (is_float || (min_signed < 0 && max_unsigned > static_cast<uint64_t>(INT64_MAX))) {
+				for (detail::JsonNumber& i : _numbers) {
+					if (i.type == detail::JsonNumber::NUMBER_UNSIGNED) i.f64 = static_cast<double>(i.u64);
+					else if (i.type == detail::JsonNumber::NUMBER_SIGNED) i.f64 = static_cast<double>(i.s64);
+					i.type = detail::JsonNumber::NUMBER_FLOAT;
+				}
+				OutputNumberArray<double>(size);
+			} else if (min_signed < 0) {
+				if (min_signed >= INT8_MIN && max_unsigned <= static_cast<uint64_t>(INT8_MAX)) OutputNumberArray<int8_t>(size);
+				else if (min_signed >= INT16_MIN && max_unsigned <= static_cast<uint64_t>(INT16_MAX)) OutputNumberArray<int16_t>(size);
+				else if (min_signed >= INT32_MIN && max_unsigned <= static_cast<uint64_t>(INT32_MAX)) OutputNumberArray<int32_t>(size);
+				else OutputNumberArray<int64_t>(size);
+			} else {
+				if (max_unsigned <= UINT8_MAX) OutputNumberArray<uint8_t>(size);
+				else if (max_unsigned <= UINT16_MAX) OutputNumberArray<uint16_t>(size);
+				else if (max_unsigned <= UINT32_MAX) OutputNumberArray<uint32_t>(size);
+				else OutputNumberArray<uint64_t>(size);
+			}
+
+			return structural;
+		}
+
+		// Unescape a string into _string_buffer, returns the index of the next structural character
+		uint32_t ParseString(const uint32_t structural) {
+			// Keys and binary data are expected to be strings, but the JSON may have anything there
+			if (structural >= _structurals.size() || CharAt(structural) != '"') throw std::runtime_error("JsonReader::Read : Expected a string");
+
+			const char* i = _json.data() + _structurals[structural] + 1u;
+			const char* const end = _json.data() + _json.size() - PADDING;
+			_string_buffer.clear();
+
+			while (true) {
+				// Copy characters up to the next quote or escape sequence
+				const char* run = i;
+				while (i < end && *i != '"' && *i != '\\') ++i;
+				if (i >= end) throw std::runtime_error("JsonReader::Read : Unterminated string");
+				_string_buffer.insert(_string_buffer.end(), run, i);
+
+				if (*i == '"') break;
+
+				// Escape sequence, \u reads at most 10 characters ahead which stays inside of the padding
+				++i;
+				switch (*i) {
+				case '"':
+				case '\\':
+				case '/':
+					_string_buffer.push_back(*i);
+					break;
+				case 'b':
+					_string_buffer.push_back('\b');
+					break;
+				case 'f':
+					_string_buffer.push_back('\f');
+					break;
+				case 'n':
+					_string_buffer.push_back('\n');
+					break;
+				case 'r':
+					_string_buffer.push_back('\r');
+					break;
+				case 't':
+					_string_buffer.push_back('\t');
+					break;
+				case 'u':
+					{
+						uint32_t code_point = 0u;
+						for (uint32_t j = 1u; j <= 4u; ++j) code_point = (code_point << 4u) | detail::FromHex(i[j]);
+						i += 4u;
+
+						// Combine UTF-16 surrogate pairs
+						if (code_point >= 0xD800u && code_point <= 0xDBFFu && i[1u] == '\\' && i[2u] == 'u') {
+							uint32_t low = 0u;
+							for (uint32_t j = 3u; j <= 6u; ++j) low = (low << 4u) | detail::FromHex(i[j]);
+							if (low >= 0xDC00u && low <= 0xDFFFu) {
+								code_point = 0x10000u + ((code_point - 0xD800u) << 10u) + (low - 0xDC00u);
+								i += 6u;
+							}
+						}
+
+						// Encode as UTF-8
+						if (code_point < 0x80u) {
+							_string_buffer.push_back(static_cast<char>(code_point));
+						} else if (code_point < 0x800u) {
+							_string_buffer.push_back(static_cast<char>(0xC0u | (code_point >> 6u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | (code_point & 63u)));
+						} else if (code_point < 0x10000u) {
+							_string_buffer.push_back(static_cast<char>(0xE0u | (code_point >> 12u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | ((code_point >> 6u) & 63u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | (code_point & 63u)));
+						} else {
+							_string_buffer.push_back(static_cast<char>(0xF0u | (code_point >> 18u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | ((code_point >> 12u) & 63u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | ((code_point >> 6u) & 63u)));
+							_string_buffer.push_back(static_cast<char>(0x80u | (code_point & 63u)));
+						}
+					}
+					break;
+				default:
+					throw std::runtime_error("JsonReader::Read : Invalid escape sequence");
+				}
+				++i;
+			}
+
+			return structural + 1u;
+		}
+
+		uint32_t ExpectCharacter(const uint32_t structural, const char c) {
+			if (structural >= _structurals.size() || CharAt(structural) != c) {
+				throw std::runtime_error(std::string("JsonReader::Read : Expected '") + c + "'");
+			}
+			return structural + 1u;
+		}
+
+		bool IsKey(const uint32_t structural, const char* key, const size_t length) const {
+			const char* const str = _json.data() + _structurals[structural];
+			return str[0u] == '"' && memcmp(str + 1u, key, length) == 0 && str[length + 1u] == '"';
+		}
+
+		// Parse a user POD or byte array, the binary data is stored as a hexidecimal or base64 string
+		uint32_t ParseBinaryObject(uint32_t structural, const uint32_t size, const bool is_pod) {
+			uint32_t type = 0u;
+			_binary_buffer.clear();
+
+			for (uint32_t i = 0u; i < size; ++i) {
+				if (i > 0u) structural = ExpectCharacter(structural, ',');
+				const uint32_t key = structural;
+				structural = ExpectCharacter(ParseString(structural), ':');
+
+				if (is_pod && IsKey(key, "type", 4u)) {
+					detail::JsonNumber number;
+					structural = ParseNumber(structural, number);
+					if (number.type != detail::JsonNumber::NUMBER_UNSIGNED || number.u64 > UINT32_MAX) throw std::runtime_error("JsonReader::Read : Invalid POD type");
+					type = static_cast<uint32_t>(number.u64);
+				} else if (IsKey(key, "data", 4u)) {
+					structural = ParseString(structural);
+					const size_t length = _string_buffer.size();
+					if (is_pod) {
+						_binary_buffer.resize(length / 2u);
+						DecodeHex(_string_buffer.data(), length, _binary_buffer.data());
+					} else {
+						_binary_buffer.resize(GetBase64DecodedLength(length));
+						_binary_buffer.resize(DecodeBase64(_string_buffer.data(), length, _binary_buffer.data()));
+					}
+				} else {
+					// __ANVIL_POD or __ANVIL_BYTES marker
+					structural = ParseValue(structural, false);
+				}
+			}
+
+			const uint32_t bytes = static_cast<uint32_t>(_binary_buffer.size());
+			if (is_pod) {
+				_parser.OnUserPOD(type, bytes, _binary_buffer.data());
+			} else {
+				_parser.OnPrimativeArrayU8(_binary_buffer.data(), bytes);
+			}
+			return ExpectCharacter(structural, '}');
+		}
+
+		uint32_t ParseObject(uint32_t structural) {
+			const uint32_t size = _containers[_next_container++].size;
+			++structural;
+
+			// Check for user PODs and byte arrays written by JsonWriter
+			if (size > 0u && IsKey(structural, "__ANVIL_POD", 11u)) return ParseBinaryObject(structural, size, true);
+			if (size > 0u && IsKey(structural, "__ANVIL_BYTES", 13u)) return ParseBinaryObject(structural, size, false);
+
+			_parser.OnObjectBegin(size);
+			for (uint32_t i = 0u; i < size; ++i) {
+				if (i > 0u) structural = ExpectCharacter(structural, ',');
+
+				// Keys must be component IDs
+				structural = ExpectCharacter(ParseString(structural), ':');
+				const char* const key = _string_buffer.data();
+				const size_t key_length = _string_buffer.size();
+				ComponentID id = 0u;
+				const std::from_chars_result result = std::from_chars(key, key + key_length, id);
+				if (key_length == 0u || result.ec != std::errc() || result.ptr != key + key_length) throw std::runtime_error("JsonReader::Read : Object key is not a component ID");
+
+				_parser.OnComponentID(id);
+				structural = ParseValue(structural, true);
+			}
+			_parser.OnObjectEnd();
+
+			return ExpectCharacter(structural, '}');
+		}
+
+		uint32_t ParseArray(uint32_t structural) {
+			const detail::JsonContainer& container = _containers[_next_container++];
+			const uint32_t size = container.size;
+			++structural;
+
+			if (container.numeric_array && size > 0u) {
+				structural = ParseNumericArray(structural, size);
+			} else {
+				_parser.OnArrayBegin(size);
+				for (uint32_t i = 0u; i < size; ++i) {
+					if (i > 0u) structural = ExpectCharacter(structural, ',');
+					structural = ParseValue(structural, true);
+				}
+				_parser.OnArrayEnd();
+			}
+
+			return ExpectCharacter(structural, ']');
+		}
+
+		uint32_t ParseValue(const uint32_t structural, const bool output) {
+			if (structural >= _structurals.size()) throw std::runtime_error("JsonReader::Read : Expected a value");
+			const char* const str = _json.data() + _structurals[structural];
+
+			switch (*str) {
+			case '{':
+				return ParseObject(structural);
+			case '[':
+				return ParseArray(structural);
+			case '"':
+				{
+					const uint32_t next = ParseString(structural);
+					if (output) _parser.OnPrimativeString(_string_buffer.data(), static_cast<uint32_t>(_string_buffer.size()));
+					return next;
+				}
+			case 't':
+				if (memcmp(str, "true", 4u) != 0 || ! IsValueEnd(str[4u])) break;
+				if (output) _parser.OnPrimativeBool(true);
+				return structural + 1u;
+			case 'f':
+				if (memcmp(str, "false", 5u) != 0 || ! IsValueEnd(str[5u])) break;
+				if (output) _parser.OnPrimativeBool(false);
+				return structural + 1u;
+			case 'n':
+				if (memcmp(str, "null", 4u) != 0 || ! IsValueEnd(str[4u])) break;
+				if (output) _parser.OnNull();
+				return structural + 1u;
+			default:
+				{
+					detail::JsonNumber number;
+					const uint32_t next = ParseNumber(structural, number);
+					if (output) OutputNumber(number);
+					return next;
+				}
+			}
+
+			throw std::runtime_error("JsonReader::Read : Invalid value");
+		}
+
+	public:
+		JsonReadHelper(Parser& parser) :
+			_parser(parser),
+			_next_container(0u)
+		{}
+
+		void Read(InputPipe& pipe) {
+			ReadAll(pipe);
+			FindStructuralCharacters();
+			CountContainerSizes();
+
+			// JsonWriter separates top level values with commas
+			_parser.OnPipeOpen();
+			const uint32_t count = static_cast<uint32_t>(_structurals.size());
+			uint32_t structural = 0u;
+			while (structural < count) {
+				if (structural > 0u) structural = ExpectCharacter(structural, ',');
+				structural = ParseValue(structural, true);
+			}
+			_parser.OnPipeClose();
+		}
+	};
+
+	JsonReader::JsonReader(InputPipe& pipe) :
+		_pipe(pipe)
+	{}
+
+	JsonReader::~JsonReader() {
+
+	}
+
+	void JsonReader::Read(Parser& dst) {
+		JsonReadHelper helper(dst);
+		helper.Read(_pipe);
 	}
 
-}}
\ No newline at end of file
+}}
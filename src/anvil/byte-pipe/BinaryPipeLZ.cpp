@@ -0,0 +1,421 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/byte-pipe/BytePipeLZ.hpp"
+#include "anvil/byte-pipe/BytePipeEndian.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static ANVIL_CONSTEXPR const uint32_t g_lz_min_match = 4u;
+		static ANVIL_CONSTEXPR const uint32_t g_lz_last_literals = 5u;		//!< The number of bytes at the end of a block that are always literals
+		static ANVIL_CONSTEXPR const uint32_t g_lz_match_start_limit = 12u;	//!< Matches do not start in this many bytes at the end of a block
+		static ANVIL_CONSTEXPR const uint32_t g_lz_max_offset = 65535u;
+		static ANVIL_CONSTEXPR const uint32_t g_lz_hash_bits = 15u;
+		static ANVIL_CONSTEXPR const uint32_t g_lz_slack = 32u;				//!< Spare bytes after the decoder buffers for copies that overrun
+		static ANVIL_CONSTEXPR const uint32_t g_lz_raw_flag = 1u << 31u;
+
+		static inline uint32_t Read32(const uint8_t* src) {
+			uint32_t value;
+			memcpy(&value, src, sizeof(value));
+			return value;
+		}
+
+		static inline uint64_t Read64(const uint8_t* src) {
+			uint64_t value;
+			memcpy(&value, src, sizeof(value));
+			return value;
+		}
+
+		static inline uint32_t ReadLittleEndian32(const uint8_t* src) {
+			return static_cast<uint32_t>(src[0u]) | (static_cast<uint32_t>(src[1u]) << 8u) | (static_cast<uint32_t>(src[2u]) << 16u) | (static_cast<uint32_t>(src[3u]) << 24u);
+		}
+
+		static inline void WriteLittleEndian32(uint8_t* dst, const uint32_t value) {
+			dst[0u] = static_cast<uint8_t>(value);
+			dst[1u] = static_cast<uint8_t>(value >> 8u);
+			dst[2u] = static_cast<uint8_t>(value >> 16u);
+			dst[3u] = static_cast<uint8_t>(value >> 24u);
+		}
+
+		static inline uint32_t GetMaxCompressedBytes(const uint32_t bytes) {
+			return bytes + bytes / 255u + 16u;
+		}
+
+		static inline uint32_t Hash(const uint32_t value) {
+			return (value * 2654435761u) >> (32u - g_lz_hash_bits);
+		}
+
+		// Returns the index of the first byte that is different in two 8 byte blocks that are not equal
+		static inline uint32_t FirstDifferentByte(const uint64_t diff) {
+#ifdef _MSC_VER
+			unsigned long index;
+			if (GetEndianness() == ENDIAN_LITTLE) {
+				_BitScanForward64(&index, diff);
+				return static_cast<uint32_t>(index) / 8u;
+			} else {
+				_BitScanReverse64(&index, diff);
+				return (63u - static_cast<uint32_t>(index)) / 8u;
+			}
+#else
+			return static_cast<uint32_t>(GetEndianness() == ENDIAN_LITTLE ? __builtin_ctzll(diff) : __builtin_clzll(diff)) / 8u;
+#endif
+		}
+
+		// Returns the number of bytes that are the same, a is not read past limit
+		static inline uint32_t CountMatchingBytes(const uint8_t* a, const uint8_t* b, const uint8_t* const limit) {
+			const uint8_t* const start = a;
+			while (a + 8u <= limit) {
+				const uint64_t diff = Read64(a) ^ Read64(b);
+				if (diff != 0u) return static_cast<uint32_t>(a - start) + FirstDifferentByte(diff);
+				a += 8u;
+				b += 8u;
+			}
+			while (a < limit && *a == *b) {
+				++a;
+				++b;
+			}
+			return static_cast<uint32_t>(a - start);
+		}
+
+		static inline uint8_t* WriteLength(uint8_t* dst, uint32_t length) {
+			while (length >= 255u) {
+				*dst = 255u;
+				++dst;
+				length -= 255u;
+			}
+			*dst = static_cast<uint8_t>(length);
+			return dst + 1u;
+		}
+
+		static inline uint32_t ReadLength(const uint8_t*& src, const uint8_t* const end) {
+			uint32_t length = 0u;
+			uint32_t byte;
+			do {
+				if (src == end) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Block ends in the middle of a length");
+				byte = *src;
+				++src;
+				length += byte;
+				if (length > LZEncoderPipe::MAX_BLOCK_SIZE) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Length is larger than a block");
+			} while (byte == 255u);
+			return length;
+		}
+
+		// Writes a sequence, a match length of 0 writes the literals at the end of a block
+		static inline uint8_t* WriteSequence(uint8_t* dst, const uint8_t* literals, const uint32_t literal_count, const uint32_t offset, const uint32_t match_length) {
+			uint8_t* const token = dst;
+			++dst;
+
+			if (literal_count >= 15u) {
+				*token = 15u << 4u;
+				dst = WriteLength(dst, literal_count - 15u);
+			} else {
+				*token = static_cast<uint8_t>(literal_count << 4u);
+			}
+			memcpy(dst, literals, literal_count);
+			dst += literal_count;
+
+			if (match_length > 0u) {
+				dst[0u] = static_cast<uint8_t>(offset);
+				dst[1u] = static_cast<uint8_t>(offset >> 8u);
+				dst += 2u;
+
+				const uint32_t length = match_length - g_lz_min_match;
+				if (length >= 15u) {
+					*token |= 15u;
+					dst = WriteLength(dst, length - 15u);
+				} else {
+					*token |= static_cast<uint8_t>(length);
+				}
+			}
+			return dst;
+		}
+
+		// Copies 16 bytes at a time, up to 15 bytes after the end of src and dst are also copied
+		static inline void WildCopy16(uint8_t* dst, const uint8_t* src, const uint32_t bytes) {
+			uint8_t* const end = dst + bytes;
+			do {
+				memcpy(dst, src, 16u);
+				dst += 16u;
+				src += 16u;
+			} while (dst < end);
+		}
+
+		// Copies a match that may overlap the bytes being written, up to 15 bytes after the end of the match are also written
+		static inline void CopyMatch(uint8_t* dst, const uint32_t offset, const uint32_t bytes) {
+			const uint8_t* src = dst - offset;
+			uint8_t* const end = dst + bytes;
+			if (offset >= 16u) {
+				WildCopy16(dst, src, bytes);
+			} else if (offset >= 8u) {
+				do {
+					memcpy(dst, src, 8u);
+					dst += 8u;
+					src += 8u;
+				} while (dst < end);
+			} else {
+				// Repeat the pattern, each step is a whole number of patterns so every copy starts at the beginning of it
+				uint8_t pattern[16u];
+				for (uint32_t i = 0u; i < 16u; ++i) pattern[i] = src[i % offset];
+				const uint32_t step = (16u / offset) * offset;
+				do {
+					memcpy(dst, pattern, 16u);
+					dst += step;
+				} while (dst < end);
+			}
+		}
+	}
+
+	// LZEncoderPipe
+
+	LZEncoderPipe::LZEncoderPipe(OutputPipe& output, const uint32_t block_size, const uint32_t max_chain_length) :
+		_output(output),
+		_block_size(block_size),
+		_used_bytes(0u),
+		_max_chain_length(max_chain_length)
+	{
+		if (block_size == 0u || block_size > MAX_BLOCK_SIZE) throw std::runtime_error("LZEncoderPipe::LZEncoderPipe : Block size must be between 1 and MAX_BLOCK_SIZE");
+		if (max_chain_length == 0u) throw std::runtime_error("LZEncoderPipe::LZEncoderPipe : Chain length must be at least 1");
+		_block.resize(block_size);
+		_compressed.resize(8u + detail::GetMaxCompressedBytes(block_size));
+		_hash_table.resize(1u << detail::g_lz_hash_bits);
+		_chain_table.resize(detail::g_lz_max_offset + 1u);
+	}
+
+	LZEncoderPipe::~LZEncoderPipe() {
+		if (_Flush()) _output.Flush();
+	}
+
+	uint32_t LZEncoderPipe::CompressBlock() {
+		const uint8_t* const src = _block.data();
+		const uint8_t* const end = src + _used_bytes;
+		uint8_t* const dst = _compressed.data() + 8u;
+		uint8_t* out = dst;
+		const uint8_t* anchor = src;
+
+		if (_used_bytes > detail::g_lz_match_start_limit) {
+			const uint8_t* const match_start_limit = end - detail::g_lz_match_start_limit;
+			const uint8_t* const match_end_limit = end - detail::g_lz_last_literals;
+			uint32_t* const hash_table = _hash_table.data();
+			uint16_t* const chain_table = _chain_table.data();
+			memset(hash_table, 0, _hash_table.size() * sizeof(uint32_t));
+
+			// Link a position to the last position with the same hash
+			const auto Insert = [=](const uint32_t position, const uint32_t hash) {
+				const uint32_t previous = hash_table[hash];
+				const uint32_t distance = position + 1u - previous;
+				chain_table[position & detail::g_lz_max_offset] = previous == 0u || distance > detail::g_lz_max_offset ? 0u : static_cast<uint16_t>(distance);
+				hash_table[hash] = position + 1u;
+			};
+
+			const uint8_t* in = src;
+			while (in < match_start_limit) {
+				const uint32_t position = static_cast<uint32_t>(in - src);
+				const uint32_t hash = detail::Hash(detail::Read32(in));
+
+				// Check each earlier position with the same hash for the longest match
+				uint32_t best_length = 0u;
+				uint32_t best_offset = 0u;
+				uint32_t candidate = hash_table[hash];
+				for (uint32_t i = 0u; i < _max_chain_length && candidate != 0u; ++i) {
+					const uint32_t offset = position + 1u - candidate;
+					if (offset > detail::g_lz_max_offset) break;
+					const uint8_t* const match = in - offset;
+					// A match can only be longer than the best one if the byte after the best length is the same
+					if (match[best_length] == in[best_length] && detail::Read32(match) == detail::Read32(in)) {
+						const uint32_t length = detail::g_lz_min_match + detail::CountMatchingBytes(in + detail::g_lz_min_match, match + detail::g_lz_min_match, match_end_limit);
+						if (length > best_length) {
+							best_length = length;
+							best_offset = offset;
+						}
+					}
+					const uint16_t distance = chain_table[(candidate - 1u) & detail::g_lz_max_offset];
+					if (distance == 0u) break;
+					candidate -= distance;
+				}
+				Insert(position, hash);
+
+				if (best_length < detail::g_lz_min_match) {
+					// Search less often in data that is not compressing
+					in += 1u + (static_cast<uint32_t>(in - anchor) >> 6u);
+					continue;
+				}
+
+				out = detail::WriteSequence(out, anchor, static_cast<uint32_t>(in - anchor), best_offset, best_length);
+
+				// The positions inside the match can be matched by later sequences
+				const uint8_t* const match_end = in + best_length;
+				for (++in; in < match_end && in < match_start_limit; ++in) Insert(static_cast<uint32_t>(in - src), detail::Hash(detail::Read32(in)));
+				in = match_end;
+				anchor = in;
+			}
+		}
+
+		out = detail::WriteSequence(out, anchor, static_cast<uint32_t>(end - anchor), 0u, 0u);
+		return static_cast<uint32_t>(out - dst);
+	}
+
+	bool LZEncoderPipe::_Flush() {
+		if (_used_bytes == 0u) return false;
+
+		// The header is written in front of the compressed block so that the block is written in one call
+		uint32_t compressed_bytes = CompressBlock();
+		const uint8_t* block = _compressed.data();
+		if (compressed_bytes >= _used_bytes) {
+			// Store the block without compression
+			uint8_t header[8u];
+			detail::WriteLittleEndian32(header, _used_bytes | detail::g_lz_raw_flag);
+			detail::WriteLittleEndian32(header + 4u, _used_bytes);
+			_output.WriteBytes(header, 8u);
+			_output.WriteBytes(_block.data(), _used_bytes);
+		} else {
+			detail::WriteLittleEndian32(_compressed.data(), compressed_bytes);
+			detail::WriteLittleEndian32(_compressed.data() + 4u, _used_bytes);
+			_output.WriteBytes(block, compressed_bytes + 8u);
+		}
+
+		_used_bytes = 0u;
+		return true;
+	}
+
+	uint32_t LZEncoderPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		uint32_t bytes_remaining = bytes;
+		while (bytes_remaining > 0u) {
+			uint32_t count = _block_size - _used_bytes;
+			if (count > bytes_remaining) count = bytes_remaining;
+			memcpy(_block.data() + _used_bytes, src8, count);
+			_used_bytes += count;
+			src8 += count;
+			bytes_remaining -= count;
+			if (_used_bytes == _block_size) _Flush();
+		}
+		return bytes;
+	}
+
+	void LZEncoderPipe::Flush() {
+		if (_Flush()) _output.Flush();
+	}
+
+	// LZDecoderPipe
+
+	LZDecoderPipe::LZDecoderPipe(InputPipe& input) :
+		_input(input),
+		_block_bytes(0u),
+		_read_bytes(0u)
+	{}
+
+	LZDecoderPipe::~LZDecoderPipe() {
+
+	}
+
+	void LZDecoderPipe::DecompressBlock(const uint32_t compressed_bytes) {
+		const uint8_t* in = _compressed.data();
+		const uint8_t* const in_end = in + compressed_bytes;
+		uint8_t* const out_begin = _block.data();
+		uint8_t* out = out_begin;
+		uint8_t* const out_end = out_begin + _block_bytes;
+
+		while (true) {
+			if (in == in_end) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Block ends in the middle of a sequence");
+			const uint32_t token = *in;
+			++in;
+
+			// Copy the literals
+			uint32_t literal_count = token >> 4u;
+			if (literal_count == 15u) literal_count += detail::ReadLength(in, in_end);
+			if (literal_count > static_cast<size_t>(in_end - in) || literal_count > static_cast<size_t>(out_end - out)) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Literals are larger than the block");
+			detail::WildCopy16(out, in, literal_count);
+			in += literal_count;
+			out += literal_count;
+
+			// The last sequence only contains literals
+			if (in == in_end) break;
+
+			// Copy the match
+			if (in_end - in < 2) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Block ends in the middle of a sequence");
+			const uint32_t offset = static_cast<uint32_t>(in[0u]) | (static_cast<uint32_t>(in[1u]) << 8u);
+			in += 2u;
+			if (offset == 0u || offset > static_cast<size_t>(out - out_begin)) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Match starts before the block");
+			uint32_t match_length = token & 15u;
+			if (match_length == 15u) match_length += detail::ReadLength(in, in_end);
+			match_length += detail::g_lz_min_match;
+			if (match_length > static_cast<size_t>(out_end - out)) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Match is larger than the block");
+			detail::CopyMatch(out, offset, match_length);
+			out += match_length;
+		}
+
+		if (out != out_end) throw std::runtime_error("LZDecoderPipe::DecompressBlock : Block is smaller than its header");
+	}
+
+	bool LZDecoderPipe::ReadNextBlock() {
+		uint8_t header[8u];
+		const uint32_t bytes_read = _input.ReadBytes(header, 8u);
+		if (bytes_read == 0u) return false;
+		if (bytes_read != 8u) throw std::runtime_error("LZDecoderPipe::ReadNextBlock : Failed to read block header");
+
+		const uint32_t stored_bytes = detail::ReadLittleEndian32(header) & ~detail::g_lz_raw_flag;
+		const bool raw = (detail::ReadLittleEndian32(header) & detail::g_lz_raw_flag) != 0u;
+		const uint32_t block_bytes = detail::ReadLittleEndian32(header + 4u);
+		if (block_bytes > LZEncoderPipe::MAX_BLOCK_SIZE) throw std::runtime_error("LZDecoderPipe::ReadNextBlock : Block is larger than MAX_BLOCK_SIZE");
+		if (raw ? stored_bytes != block_bytes : stored_bytes > detail::GetMaxCompressedBytes(block_bytes)) throw std::runtime_error("LZDecoderPipe::ReadNextBlock : Block header is not valid");
+
+		// Buffers are only reallocated when a larger block is read
+		if (_block.size() < block_bytes + detail::g_lz_slack) _block.resize(block_bytes + detail::g_lz_slack);
+		_block_bytes = block_bytes;
+		_read_bytes = 0u;
+
+		if (raw) {
+			if (_input.ReadBytes(_block.data(), block_bytes) != block_bytes) throw std::runtime_error("LZDecoderPipe::ReadNextBlock : Failed to read block");
+		} else {
+			if (_compressed.size() < stored_bytes + detail::g_lz_slack) _compressed.resize(stored_bytes + detail::g_lz_slack);
+			if (_input.ReadBytes(_compressed.data(), stored_bytes) != stored_bytes) throw std::runtime_error("LZDecoderPipe::ReadNextBlock : Failed to read block");
+			DecompressBlock(stored_bytes);
+		}
+		return true;
+	}
+
+	uint32_t LZDecoderPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		uint8_t* dst8 = static_cast<uint8_t*>(dst);
+		uint32_t bytes_remaining = bytes;
+		while (bytes_remaining > 0u) {
+			if (_read_bytes == _block_bytes) {
+				if (! ReadNextBlock()) break;
+				continue;
+			}
+
+			uint32_t count = _block_bytes - _read_bytes;
+			if (count > bytes_remaining) count = bytes_remaining;
+			memcpy(dst8, _block.data() + _read_bytes, count);
+			_read_bytes += count;
+			dst8 += count;
+			bytes_remaining -= count;
+		}
+		return bytes - bytes_remaining;
+	}
+
+	const void* LZDecoderPipe::ReadBytesZeroCopy(const uint32_t bytes) {
+		if (_read_bytes == _block_bytes && bytes > 0u) {
+			if (! ReadNextBlock()) return nullptr;
+		}
+		if (bytes > _block_bytes - _read_bytes) return nullptr;
+		const void* const src = _block.data() + _read_bytes;
+		_read_bytes += bytes;
+		return src;
+	}
+
+}}
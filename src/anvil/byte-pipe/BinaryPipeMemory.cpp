@@ -0,0 +1,50 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include "anvil/byte-pipe/BytePipeMemory.hpp"
+
+namespace anvil { namespace BytePipe {
+	// MemoryInputPipe
+
+	MemoryInputPipe::MemoryInputPipe(const void* src, const size_t bytes) :
+		_src(static_cast<const uint8_t*>(src)),
+		_bytes_remaining(bytes)
+	{}
+
+	MemoryInputPipe::~MemoryInputPipe() {
+
+	}
+
+	size_t MemoryInputPipe::GetBytesRemaining() const {
+		return _bytes_remaining;
+	}
+
+	uint32_t MemoryInputPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		const uint32_t bytes_read = bytes < _bytes_remaining ? bytes : static_cast<uint32_t>(_bytes_remaining);
+		memcpy(dst, _src, bytes_read);
+		_src += bytes_read;
+		_bytes_remaining -= bytes_read;
+		return bytes_read;
+	}
+
+	const void* MemoryInputPipe::ReadBytesZeroCopy(const uint32_t bytes) {
+		if (bytes > _bytes_remaining) return nullptr;
+		const void* const src = _src;
+		_src += bytes;
+		_bytes_remaining -= bytes;
+		return src;
+	}
+
+}}
@@ -35,29 +35,32 @@ namespace anvil { namespace BytePipe {
 	// PacketInputPipe
 
 	PacketInputPipe::PacketInputPipe(InputPipe& downstream_pipe) :
-		_downstream_pipe(downstream_pipe)
+		_downstream_pipe(downstream_pipe),
+		_buffer_begin(0u),
+		_buffer_end(0u)
 	{}
 
 	PacketInputPipe::~PacketInputPipe() {
 
 	}
 
-	void PacketInputPipe::ReadNextPacket() {
+	bool PacketInputPipe::ReadPacketHeader(uint32_t& used_bytes, uint32_t& unused_bytes) {
 		// Read the packet header version
 		PacketHeader header;
 		uint32_t read = _downstream_pipe.ReadBytes(&header, 1u);
 
 		// Error checking
-		if (read != 1u) throw std::runtime_error("PacketInputPipe::ReadNextPacket : Failed to read packet version");
+		if (read == 0u) return false;
+		if (read != 1u) throw std::runtime_error("PacketInputPipe::ReadPacketHeader : Failed to read packet version");
 		uint32_t version = header.v1.packet_version;
 		if (version >= 3u) version = header.v3.packet_version; // Read the extended version number
-		if(header.v1.packet_version > 3u) throw std::runtime_error("PacketInputPipe::ReadNextPacket : Packet version is not supported");
+		if(header.v1.packet_version > 3u) throw std::runtime_error("PacketInputPipe::ReadPacketHeader : Packet version is not supported");
 
 		// Read the rest of the header
-		read = _downstream_pipe.ReadBytes(reinterpret_cast<uint8_t*>(&header) + 1u, g_header_sizes[header.v1.packet_version] - 1u);
+		const uint32_t header_size = g_header_sizes[header.v1.packet_version];
+		read = _downstream_pipe.ReadBytes(reinterpret_cast<uint8_t*>(&header) + 1u, header_size - 1u);
+		if (read != header_size - 1u) throw std::runtime_error("PacketInputPipe::ReadPacketHeader : Failed to read packet header");
 
-		// Allocate a temporary buffer for the data
-		uint32_t used_bytes;
 		uint32_t packet_size;
 		//! \bug Packets larger than UINT32_MAX will cause an integer overflow on the byte count
 
@@ -67,54 +70,81 @@ namespace anvil { namespace BytePipe {
 		} else if (version == 2u) {
 			used_bytes = header.v2.used_size;
 			packet_size = header.v2.packet_size;
-		} else if (version == 3u) {
-			used_bytes = header.v3.used_size;
-			packet_size = header.v3.packet_size;
+		} else {
+			used_bytes = static_cast<uint32_t>(header.v3.used_size);
+			packet_size = static_cast<uint32_t>(header.v3.packet_size);
 		}
 
 		used_bytes += 1u;
 		packet_size += 1u;
 
-		// Read the data into the buffer
-		const uint32_t unused_bytes = (packet_size - g_header_sizes[version]) - used_bytes;
-		uint8_t* tmp = static_cast<uint8_t*>(_alloca(used_bytes + unused_bytes));
-		read = _downstream_pipe.ReadBytes(tmp, used_bytes + unused_bytes);
-		if (read != used_bytes + unused_bytes) throw std::runtime_error("PacketInputPipe::ReadNextPacket : Failed reading used packet data");
+		if (packet_size < g_header_sizes[version] + used_bytes) throw std::runtime_error("PacketInputPipe::ReadPacketHeader : Packet header is not valid");
+		unused_bytes = (packet_size - g_header_sizes[version]) - used_bytes;
+		return true;
+	}
+
+	void PacketInputPipe::SkipUnusedBytes(const uint32_t bytes) {
+		if (bytes == 0u) return;
+		if (_downstream_pipe.ReadBytesZeroCopy(bytes) != nullptr) return;
 
-		// Copy the used data into the main buffer
-		for (uint32_t i = 0u; i < used_bytes; ++i) _buffer.push_back(tmp[i]); //! \todo This could be optimised
+		if (_buffer.size() < bytes) _buffer.resize(bytes);
+		if (_downstream_pipe.ReadBytes(_buffer.data(), bytes) != bytes) throw std::runtime_error("PacketInputPipe::SkipUnusedBytes : Failed reading unused packet data");
 	}
 
 	uint32_t PacketInputPipe::ReadBytes(void* dst, const uint32_t bytes) {
 		uint8_t* data = static_cast<uint8_t*>(dst);
 		uint32_t b = bytes;
 
-		//! \todo This could be optimised
 		while (b != 0u) {
-			if (_buffer.empty()) ReadNextPacket();
-
-			*data = _buffer.front();
-			_buffer.pop_front();
-
-			--b;
-			++data;
+			// Copy the bytes that are left in the current packet
+			if (_buffer_begin != _buffer_end) {
+				uint32_t bytes_to_copy = _buffer_end - _buffer_begin;
+				if (b < bytes_to_copy) bytes_to_copy = b;
+				memcpy(data, _buffer.data() + _buffer_begin, bytes_to_copy);
+				_buffer_begin += bytes_to_copy;
+				data += bytes_to_copy;
+				b -= bytes_to_copy;
+				continue;
+			}
+
+			uint32_t used_bytes, unused_bytes;
+			if (! ReadPacketHeader(used_bytes, unused_bytes)) break;
+
+			if (used_bytes <= b) {
+				// The whole payload is needed, so read it directly into the destination
+				if (_downstream_pipe.ReadBytes(data, used_bytes) != used_bytes) throw std::runtime_error("PacketInputPipe::ReadBytes : Failed reading used packet data");
+				SkipUnusedBytes(unused_bytes);
+				data += used_bytes;
+				b -= used_bytes;
+			} else {
+				// Read the payload into the buffer
+				const uint32_t payload_bytes = used_bytes + unused_bytes;
+				if (_buffer.size() < payload_bytes) _buffer.resize(payload_bytes);
+				if (_downstream_pipe.ReadBytes(_buffer.data(), payload_bytes) != payload_bytes) throw std::runtime_error("PacketInputPipe::ReadBytes : Failed reading used packet data");
+				_buffer_begin = 0u;
+				_buffer_end = used_bytes;
+			}
 		}
 
-		return bytes;
+		return bytes - b;
 	}
 
 	// PacketOutputPipe
 
-	PacketOutputPipe::PacketOutputPipe(OutputPipe& downstream_pipe, const size_t packet_size, const uint8_t default_word) :
+	PacketOutputPipe::PacketOutputPipe(OutputPipe& downstream_pipe, const size_t packet_size, const uint8_t default_word, const bool fixed_size) :
 		_downstream_pipe(downstream_pipe),
 		_buffer(nullptr),
 		_max_packet_size(0u),
 		_current_packet_size(0u),
-		_default_word(default_word)
+		_flush_threshold(0u),
+		_flush_deadline(std::chrono::steady_clock::duration::zero()),
+		_default_word(default_word),
+		_fixed_size(fixed_size)
 	{
 		uint32_t version = PacketVersionFromSize(packet_size);
 		uint32_t header_size = g_header_sizes[version];
 		_max_packet_size = packet_size - header_size;
+		_flush_threshold = _max_packet_size;
 		_buffer = new uint8_t[packet_size]; // _max_packet_size + header_size
 	}
 
@@ -135,8 +165,11 @@ namespace anvil { namespace BytePipe {
 		uint32_t b = bytes;
 
 		while (b != 0u) {
+			// Start timing the deadline from the first byte in the packet
+			if (_current_packet_size == 0u && _flush_deadline > std::chrono::steady_clock::duration::zero()) _packet_start_time = std::chrono::steady_clock::now();
+
 			// Copy to the packet buffer
-			uint32_t bytes_to_buffer = _max_packet_size - _current_packet_size;
+			uint32_t bytes_to_buffer = _flush_threshold - _current_packet_size;
 			if (b < bytes_to_buffer) bytes_to_buffer = b;
 
 			memcpy(payload + _current_packet_size, data, bytes_to_buffer);
@@ -146,9 +179,11 @@ namespace anvil { namespace BytePipe {
 			_current_packet_size += bytes_to_buffer;
 
 			// If the packet is ready then write it
-			if (_current_packet_size == _max_packet_size) _Flush();
+			if (_current_packet_size == _flush_threshold) _Flush();
 		}
 
+		Poll();
+
 		return bytes;
 	}
 
@@ -161,31 +196,34 @@ namespace anvil { namespace BytePipe {
 		PacketHeader& header = *reinterpret_cast<PacketHeader*>(_buffer);
 		uint8_t* payload = _buffer + header_size;
 
+		// Variable-size packets end after the used data
+		const size_t payload_size = _fixed_size ? _max_packet_size : _current_packet_size;
+
 		// 'Zero' unused data in the packet
-		memset(payload + _current_packet_size, _default_word, _max_packet_size - _current_packet_size);
+		memset(payload + _current_packet_size, _default_word, payload_size - _current_packet_size);
 
 		if (version == 1u) {
 			// Create the header
 			header.v1.packet_version = 1u;
 			header.v1.reseved = 0u;
 			header.v1.used_size = _current_packet_size - 1u;
-			header.v1.packet_size = (_max_packet_size + header_size) - 1u;
+			header.v1.packet_size = (payload_size + header_size) - 1u;
 		} else if (version == 2u) {
 			// Create the header
 			header.v2.packet_version = 2u;
 			header.v2.used_size = _current_packet_size - 1u;
-			header.v2.packet_size = (_max_packet_size + header_size) - 1u;
+			header.v2.packet_size = (payload_size + header_size) - 1u;
 		} else if (version == 3u) {
 			// Create the header
 			header.v3.packet_version = 3u;
 			header.v3.reseved = 0u;
 			header.v3.used_size = _current_packet_size - 1u;
-			header.v3.packet_size = (_max_packet_size + header_size) - 1u;
+			header.v3.packet_size = (payload_size + header_size) - 1u;
 		}
 
 		// Write the packet to the downstream pipe
 		//! \bug Packets larger than UINT32_MAX will cause an integer overflow on the byte count
-		_downstream_pipe.WriteBytes(_buffer, _max_packet_size + header_size);
+		_downstream_pipe.WriteBytes(_buffer, payload_size + header_size);
 
 		// Reset the state of this pipe
 		_current_packet_size = 0u;
@@ -196,4 +234,22 @@ namespace anvil { namespace BytePipe {
 		_downstream_pipe.Flush();
 	}
 
+	void PacketOutputPipe::SetFlushThreshold(const size_t bytes) {
+		_flush_threshold = bytes == 0u || bytes > _max_packet_size ? _max_packet_size : bytes;
+		if (_current_packet_size >= _flush_threshold) _Flush();
+	}
+
+	void PacketOutputPipe::SetFlushDeadline(const std::chrono::steady_clock::duration deadline) {
+		// The packet that is being written starts waiting now
+		if (_flush_deadline <= std::chrono::steady_clock::duration::zero()) _packet_start_time = std::chrono::steady_clock::now();
+		_flush_deadline = deadline;
+	}
+
+	bool PacketOutputPipe::Poll() {
+		if (_current_packet_size == 0u || _flush_deadline <= std::chrono::steady_clock::duration::zero()) return false;
+		if (std::chrono::steady_clock::now() - _packet_start_time < _flush_deadline) return false;
+		Flush();
+		return true;
+	}
+
 }}
\ No newline at end of file
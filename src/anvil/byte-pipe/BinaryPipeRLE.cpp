@@ -0,0 +1,547 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/byte-pipe/BytePipeRLE.hpp"
+
+#if ANVIL_BYTEPIPE_SSE2 || ANVIL_BYTEPIPE_AVX2
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static inline uint32_t CountTrailingZerosRLE(const uint32_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, bits);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(bits));
+#endif
+		}
+
+		static inline void CheckRLEWordBytes(const uint32_t word_bytes) {
+			if (!(word_bytes == 1u || word_bytes == 2u || word_bytes == 4u || word_bytes == 8u)) throw std::runtime_error("RLE only supports words of 1, 2, 4 or 8 bytes");
+		}
+
+		template<class T>
+		static uint32_t CountRepeatedWordsScalar(const uint8_t* src, const uint8_t* word, const uint32_t begin, const uint32_t count) {
+			T w, tmp;
+			memcpy(&w, word, sizeof(T));
+			uint32_t i = begin;
+			while (i < count) {
+				memcpy(&tmp, src + static_cast<size_t>(i) * sizeof(T), sizeof(T));
+				if (tmp != w) break;
+				++i;
+			}
+			return i;
+		}
+
+		template<class T>
+		static uint32_t FindRepeatedWordScalar(const uint8_t* src, const uint32_t begin, const uint32_t count) {
+			if (count < 2u) return count;
+			T prev, next;
+			memcpy(&prev, src + static_cast<size_t>(begin) * sizeof(T), sizeof(T));
+			for (uint32_t i = begin; i + 1u < count; ++i) {
+				memcpy(&next, src + static_cast<size_t>(i + 1u) * sizeof(T), sizeof(T));
+				if (next == prev) return i;
+				prev = next;
+			}
+			return count;
+		}
+
+#if ANVIL_BYTEPIPE_SSE2
+		static inline __m128i BroadcastWordSSE2(const uint8_t* word, const uint32_t word_bytes) {
+			switch (word_bytes) {
+			case 1u:
+				return _mm_set1_epi8(static_cast<char>(*word));
+			case 2u:
+				{
+					int16_t w;
+					memcpy(&w, word, 2u);
+					return _mm_set1_epi16(w);
+				}
+			case 4u:
+				{
+					int32_t w;
+					memcpy(&w, word, 4u);
+					return _mm_set1_epi32(w);
+				}
+			default:
+				{
+					int64_t w;
+					memcpy(&w, word, 8u);
+					return _mm_set1_epi64x(w);
+				}
+			}
+		}
+
+		// Returns a mask with one bit per byte of a 16 byte block, all of the bits for a word are set if it is equal to the word after it
+		static inline uint32_t RepeatedWordMaskSSE2(const uint8_t* src, const uint32_t word_bytes) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + word_bytes));
+			__m128i cmp;
+			switch (word_bytes) {
+			case 1u:
+				cmp = _mm_cmpeq_epi8(a, b);
+				break;
+			case 2u:
+				cmp = _mm_cmpeq_epi16(a, b);
+				break;
+			case 4u:
+				cmp = _mm_cmpeq_epi32(a, b);
+				break;
+			default:
+				// SSE2 has no 64-bit compare, a 64-bit word is equal if both of its 32-bit halves are
+				cmp = _mm_cmpeq_epi32(a, b);
+				cmp = _mm_and_si128(cmp, _mm_shuffle_epi32(cmp, _MM_SHUFFLE(2, 3, 0, 1)));
+				break;
+			}
+			return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+		}
+#endif
+
+		enum : uint32_t {
+			MAX_VARINT_BYTES = 10u,
+			ZERO_RLE_INPUT_BUFFER_SIZE = 65536u
+		};
+
+		static const uint8_t g_zero_bytes[8u] = { 0u, 0u, 0u, 0u, 0u, 0u, 0u, 0u };
+
+		static uint32_t WriteVarint(uint8_t* dst, uint64_t value) {
+			uint32_t bytes = 0u;
+			while (value >= 128u) {
+				dst[bytes++] = static_cast<uint8_t>(value | 128u);
+				value >>= 7u;
+			}
+			dst[bytes++] = static_cast<uint8_t>(value);
+			return bytes;
+		}
+
+		// Returns the index of the first zero byte, or count if there are none
+		static uint32_t FindZeroByte(const uint8_t* src, const uint32_t count) {
+			size_t i = 0u;
+#if ANVIL_BYTEPIPE_AVX2
+			const __m256i zero256 = _mm256_setzero_si256();
+			while (i + 64u <= count) {
+				const uint32_t m0 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), zero256)));
+				const uint32_t m1 = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32u)), zero256)));
+				if ((m0 | m1) != 0u) return static_cast<uint32_t>(i + (m0 != 0u ? CountTrailingZerosRLE(m0) : 32u + CountTrailingZerosRLE(m1)));
+				i += 64u;
+			}
+#endif
+#if ANVIL_BYTEPIPE_SSE2
+			const __m128i zero128 = _mm_setzero_si128();
+			while (i + 16u <= count) {
+				const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), zero128)));
+				if (mask != 0u) return static_cast<uint32_t>(i + CountTrailingZerosRLE(mask));
+				i += 16u;
+			}
+#else
+			// Skip 8 bytes at a time if none of them are zero
+			while (i + 8u <= count) {
+				uint64_t tmp;
+				memcpy(&tmp, src + i, 8u);
+				if (((tmp - 0x0101010101010101ull) & ~tmp & 0x8080808080808080ull) != 0u) break;
+				i += 8u;
+			}
+#endif
+			while (i < count && src[i] != 0u) ++i;
+			return static_cast<uint32_t>(i);
+		}
+
+#if ANVIL_BYTEPIPE_AVX2
+		// Returns a mask with one bit per byte of a 32 byte block, all of the bits for a word are set if it is equal to the word after it
+		static inline uint32_t RepeatedWordMaskAVX2(const uint8_t* src, const uint32_t word_bytes) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + word_bytes));
+			__m256i cmp;
+			switch (word_bytes) {
+			case 1u:
+				cmp = _mm256_cmpeq_epi8(a, b);
+				break;
+			case 2u:
+				cmp = _mm256_cmpeq_epi16(a, b);
+				break;
+			case 4u:
+				cmp = _mm256_cmpeq_epi32(a, b);
+				break;
+			default:
+				cmp = _mm256_cmpeq_epi64(a, b);
+				break;
+			}
+			return static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+		}
+#endif
+
+	}
+
+	uint32_t CountRepeatedWords(const void* src, const void* word, const uint32_t count, const uint32_t word_bytes) {
+		detail::CheckRLEWordBytes(word_bytes);
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+		const uint8_t* const word8 = static_cast<const uint8_t*>(word);
+		const size_t bytes = static_cast<size_t>(count) * word_bytes;
+		size_t i = 0u;
+
+#if ANVIL_BYTEPIPE_SSE2
+		// The loads start on a word boundary so every word in a block lines up with the broadcast word
+	#if ANVIL_BYTEPIPE_AVX2
+		const __m256i w256 = _mm256_broadcastsi128_si256(detail::BroadcastWordSSE2(word8, word_bytes));
+		while (i + 64u <= bytes) {
+			const __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src8 + i)), w256);
+			const __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src8 + i + 32u)), w256);
+			if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(a, b))) != 0xFFFFFFFFu) {
+				uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(a));
+				if (mask == 0xFFFFFFFFu) {
+					i += 32u;
+					mask = static_cast<uint32_t>(_mm256_movemask_epi8(b));
+				}
+				return static_cast<uint32_t>((i + detail::CountTrailingZerosRLE(~mask)) / word_bytes);
+			}
+			i += 64u;
+		}
+	#endif
+		const __m128i w128 = detail::BroadcastWordSSE2(word8, word_bytes);
+		while (i + 16u <= bytes) {
+			const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src8 + i)), w128)));
+			if (mask != 0xFFFFu) return static_cast<uint32_t>((i + detail::CountTrailingZerosRLE(~mask)) / word_bytes);
+			i += 16u;
+		}
+#endif
+
+		// Compare 8 bytes at a time, the scalar loop below finds the exact word that is different
+		uint64_t pattern;
+		for (uint32_t j = 0u; j < 8u; j += word_bytes) memcpy(reinterpret_cast<uint8_t*>(&pattern) + j, word8, word_bytes);
+		while (i + 8u <= bytes) {
+			uint64_t tmp;
+			memcpy(&tmp, src8 + i, 8u);
+			if (tmp != pattern) break;
+			i += 8u;
+		}
+
+		const uint32_t begin = static_cast<uint32_t>(i / word_bytes);
+		switch (word_bytes) {
+		case 1u:
+			return detail::CountRepeatedWordsScalar<uint8_t>(src8, word8, begin, count);
+		case 2u:
+			return detail::CountRepeatedWordsScalar<uint16_t>(src8, word8, begin, count);
+		case 4u:
+			return detail::CountRepeatedWordsScalar<uint32_t>(src8, word8, begin, count);
+		default:
+			return detail::CountRepeatedWordsScalar<uint64_t>(src8, word8, begin, count);
+		}
+	}
+
+	uint32_t FindRepeatedWord(const void* src, const uint32_t count, const uint32_t word_bytes) {
+		detail::CheckRLEWordBytes(word_bytes);
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+		const size_t bytes = static_cast<size_t>(count) * word_bytes;
+		size_t i = 0u;
+
+		// Each block is compared against the same block shifted by one word, so the loads must stay one word inside the array
+#if ANVIL_BYTEPIPE_AVX2
+		while (i + 64u + word_bytes <= bytes) {
+			uint32_t mask = detail::RepeatedWordMaskAVX2(src8 + i, word_bytes);
+			if (mask == 0u) {
+				mask = detail::RepeatedWordMaskAVX2(src8 + i + 32u, word_bytes);
+				if (mask == 0u) {
+					i += 64u;
+					continue;
+				}
+				i += 32u;
+			}
+			return static_cast<uint32_t>((i + detail::CountTrailingZerosRLE(mask)) / word_bytes);
+		}
+#endif
+#if ANVIL_BYTEPIPE_SSE2
+		while (i + 64u + word_bytes <= bytes) {
+			const uint32_t m0 = detail::RepeatedWordMaskSSE2(src8 + i, word_bytes);
+			const uint32_t m1 = detail::RepeatedWordMaskSSE2(src8 + i + 16u, word_bytes);
+			const uint32_t m2 = detail::RepeatedWordMaskSSE2(src8 + i + 32u, word_bytes);
+			const uint32_t m3 = detail::RepeatedWordMaskSSE2(src8 + i + 48u, word_bytes);
+			const uint64_t mask = static_cast<uint64_t>(m0) | (static_cast<uint64_t>(m1) << 16u) | (static_cast<uint64_t>(m2) << 32u) | (static_cast<uint64_t>(m3) << 48u);
+			if (mask != 0u) {
+				const uint32_t lo = static_cast<uint32_t>(mask);
+				const uint32_t offset = lo != 0u ? detail::CountTrailingZerosRLE(lo) : 32u + detail::CountTrailingZerosRLE(static_cast<uint32_t>(mask >> 32u));
+				return static_cast<uint32_t>((i + offset) / word_bytes);
+			}
+			i += 64u;
+		}
+		while (i + 16u + word_bytes <= bytes) {
+			const uint32_t mask = detail::RepeatedWordMaskSSE2(src8 + i, word_bytes);
+			if (mask != 0u) return static_cast<uint32_t>((i + detail::CountTrailingZerosRLE(mask)) / word_bytes);
+			i += 16u;
+		}
+#endif
+
+		const uint32_t begin = static_cast<uint32_t>(i / word_bytes);
+		switch (word_bytes) {
+		case 1u:
+			return detail::FindRepeatedWordScalar<uint8_t>(src8, begin, count);
+		case 2u:
+			return detail::FindRepeatedWordScalar<uint16_t>(src8, begin, count);
+		case 4u:
+			return detail::FindRepeatedWordScalar<uint32_t>(src8, begin, count);
+		default:
+			return detail::FindRepeatedWordScalar<uint64_t>(src8, begin, count);
+		}
+	}
+
+	void FillRepeatedWord(void* dst, const void* word, const uint32_t count, const uint32_t word_bytes) {
+		detail::CheckRLEWordBytes(word_bytes);
+		uint8_t* const dst8 = static_cast<uint8_t*>(dst);
+		const uint8_t* const word8 = static_cast<const uint8_t*>(word);
+		const size_t bytes = static_cast<size_t>(count) * word_bytes;
+		size_t i = 0u;
+
+#if ANVIL_BYTEPIPE_SSE2
+		const __m128i w128 = detail::BroadcastWordSSE2(word8, word_bytes);
+	#if ANVIL_BYTEPIPE_AVX2
+		const __m256i w256 = _mm256_broadcastsi128_si256(w128);
+		while (i + 64u <= bytes) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst8 + i), w256);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst8 + i + 32u), w256);
+			i += 64u;
+		}
+	#endif
+		while (i + 16u <= bytes) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst8 + i), w128);
+			i += 16u;
+		}
+
+		// The array size is a multiple of the word size, so the last 16 bytes line up with the broadcast word
+		if (i < bytes && bytes >= 16u) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst8 + bytes - 16u), w128);
+			return;
+		}
+#endif
+
+		uint64_t pattern;
+		for (uint32_t j = 0u; j < 8u; j += word_bytes) memcpy(reinterpret_cast<uint8_t*>(&pattern) + j, word8, word_bytes);
+		while (i + 8u <= bytes) {
+			memcpy(dst8 + i, &pattern, 8u);
+			i += 8u;
+		}
+		while (i < bytes) {
+			memcpy(dst8 + i, word8, word_bytes);
+			i += word_bytes;
+		}
+	}
+
+	// ZeroRLEEncoderPipe
+
+	ZeroRLEEncoderPipe::ZeroRLEEncoderPipe(OutputPipe& output) :
+		_output(output),
+		_buffer(detail::MAX_VARINT_BYTES + MAX_LITERAL_BYTES + detail::MAX_VARINT_BYTES),
+		_literal_bytes(0u),
+		_zero_bytes(0u)
+	{}
+
+	ZeroRLEEncoderPipe::~ZeroRLEEncoderPipe() {
+		if (_Flush()) _output.Flush();
+	}
+
+	void ZeroRLEEncoderPipe::WritePair() {
+		// The literal count is written in the space before the literals so that the pair is written with one call
+		uint8_t* const literals = _buffer.data() + detail::MAX_VARINT_BYTES;
+		uint8_t header[detail::MAX_VARINT_BYTES];
+		const uint32_t header_bytes = detail::WriteVarint(header, _literal_bytes);
+		uint8_t* const pair = literals - header_bytes;
+		memcpy(pair, header, header_bytes);
+		const uint32_t zero_count_bytes = detail::WriteVarint(literals + _literal_bytes, _zero_bytes);
+		_output.WriteBytes(pair, header_bytes + _literal_bytes + zero_count_bytes);
+
+		_literal_bytes = 0u;
+		_zero_bytes = 0u;
+	}
+
+	bool ZeroRLEEncoderPipe::_Flush() {
+		if (_literal_bytes == 0u && _zero_bytes == 0u) return false;
+		WritePair();
+		return true;
+	}
+
+	void ZeroRLEEncoderPipe::AppendLiterals(const uint8_t* src, uint32_t bytes) {
+		while (bytes > 0u) {
+			if (_literal_bytes == MAX_LITERAL_BYTES) WritePair();
+			uint32_t count = MAX_LITERAL_BYTES - _literal_bytes;
+			if (count > bytes) count = bytes;
+			memcpy(_buffer.data() + detail::MAX_VARINT_BYTES + _literal_bytes, src, count);
+			_literal_bytes += count;
+			src += count;
+			bytes -= count;
+		}
+	}
+
+	uint32_t ZeroRLEEncoderPipe::WriteBytes(const void* src, const uint32_t bytes) {
+		const uint8_t* src8 = static_cast<const uint8_t*>(src);
+		uint32_t bytes_remaining = bytes;
+
+		while (bytes_remaining > 0u) {
+			if (_zero_bytes > 0u) {
+				// Extend the current zero run
+				const uint32_t count = CountRepeatedWords(src8, detail::g_zero_bytes, bytes_remaining, 1u);
+				_zero_bytes += count;
+				src8 += count;
+				bytes_remaining -= count;
+				if (bytes_remaining == 0u) break;
+
+				// The run has ended, short runs are added to the literals
+				if (_zero_bytes >= MIN_ZERO_RUN) {
+					WritePair();
+				} else {
+					const uint32_t zeros = static_cast<uint32_t>(_zero_bytes);
+					_zero_bytes = 0u;
+					AppendLiterals(detail::g_zero_bytes, zeros);
+				}
+			}
+
+			// Find the next zero run that is long enough to end the literals, or reaches the end of the bytes
+			uint32_t literals = 0u;
+			uint32_t zeros = 0u;
+			while (literals < bytes_remaining) {
+				const uint32_t run_begin = literals + detail::FindZeroByte(src8 + literals, bytes_remaining - literals);
+				if (run_begin == bytes_remaining) {
+					literals = bytes_remaining;
+					break;
+				}
+
+				const uint32_t run_end = run_begin + CountRepeatedWords(src8 + run_begin, detail::g_zero_bytes, bytes_remaining - run_begin, 1u);
+				if (run_end - run_begin >= MIN_ZERO_RUN || run_end == bytes_remaining) {
+					literals = run_begin;
+					zeros = run_end - run_begin;
+					break;
+				}
+				literals = run_end;
+			}
+
+			AppendLiterals(src8, literals);
+			_zero_bytes = zeros;
+			src8 += literals + zeros;
+			bytes_remaining -= literals + zeros;
+		}
+
+		return bytes;
+	}
+
+	void ZeroRLEEncoderPipe::Flush() {
+		if (_Flush()) _output.Flush();
+	}
+
+	// ZeroRLEDecoderPipe
+
+	ZeroRLEDecoderPipe::ZeroRLEDecoderPipe(InputPipe& input) :
+		_input(input),
+		_buffer(detail::ZERO_RLE_INPUT_BUFFER_SIZE),
+		_buffer_begin(0u),
+		_buffer_end(0u),
+		_literal_bytes(0u),
+		_zero_bytes(0u),
+		_zero_count_pending(false)
+	{}
+
+	ZeroRLEDecoderPipe::~ZeroRLEDecoderPipe() {
+
+	}
+
+	bool ZeroRLEDecoderPipe::BufferBytes(const uint32_t bytes) {
+		if (_buffer_end - _buffer_begin >= bytes) return true;
+
+		// Move the bytes that have not been decoded yet to the start of the buffer
+		_buffer_end -= _buffer_begin;
+		memmove(_buffer.data(), _buffer.data() + _buffer_begin, _buffer_end);
+		_buffer_begin = 0u;
+
+		while (_buffer_end < bytes) {
+			const uint32_t bytes_read = _input.ReadBytes(_buffer.data() + _buffer_end, static_cast<uint32_t>(_buffer.size()) - _buffer_end);
+			if (bytes_read == 0u) return false;
+			_buffer_end += bytes_read;
+		}
+		return true;
+	}
+
+	bool ZeroRLEDecoderPipe::ReadVarint(uint64_t& value) {
+		// The input may end before MAX_VARINT_BYTES, the varint is checked as it is read
+		BufferBytes(detail::MAX_VARINT_BYTES);
+		if (_buffer_begin == _buffer_end) return false;
+
+		value = 0u;
+		for (uint32_t shift = 0u; shift < 64u; shift += 7u) {
+			if (_buffer_begin == _buffer_end) break;
+			const uint8_t byte = _buffer[_buffer_begin++];
+			value |= static_cast<uint64_t>(byte & 127u) << shift;
+			if ((byte & 128u) == 0u) return true;
+		}
+		throw std::runtime_error("ZeroRLEDecoderPipe::ReadVarint : Varint is not valid");
+	}
+
+	uint32_t ZeroRLEDecoderPipe::ReadLiterals(uint8_t* dst, uint32_t bytes) {
+		if (_buffer_begin == _buffer_end) {
+			// Large literals are read directly into the destination
+			if (bytes >= _buffer.size()) {
+				uint32_t bytes_remaining = bytes;
+				while (bytes_remaining > 0u) {
+					const uint32_t bytes_read = _input.ReadBytes(dst, bytes_remaining);
+					if (bytes_read == 0u) throw std::runtime_error("ZeroRLEDecoderPipe::ReadLiterals : Failed to read literals");
+					dst += bytes_read;
+					bytes_remaining -= bytes_read;
+				}
+				return bytes;
+			}
+
+			if (! BufferBytes(1u)) throw std::runtime_error("ZeroRLEDecoderPipe::ReadLiterals : Failed to read literals");
+		}
+
+		const uint32_t available = _buffer_end - _buffer_begin;
+		if (bytes > available) bytes = available;
+		memcpy(dst, _buffer.data() + _buffer_begin, bytes);
+		_buffer_begin += bytes;
+		return bytes;
+	}
+
+	uint32_t ZeroRLEDecoderPipe::ReadBytes(void* dst, const uint32_t bytes) {
+		uint8_t* dst8 = static_cast<uint8_t*>(dst);
+		uint32_t bytes_remaining = bytes;
+
+		while (bytes_remaining > 0u) {
+			uint32_t count;
+			if (_literal_bytes > 0u) {
+				count = ReadLiterals(dst8, _literal_bytes < bytes_remaining ? static_cast<uint32_t>(_literal_bytes) : bytes_remaining);
+				_literal_bytes -= count;
+			} else if (_zero_count_pending) {
+				if (! ReadVarint(_zero_bytes)) throw std::runtime_error("ZeroRLEDecoderPipe::ReadBytes : Failed to read zero count");
+				_zero_count_pending = false;
+				continue;
+			} else if (_zero_bytes > 0u) {
+				count = _zero_bytes < bytes_remaining ? static_cast<uint32_t>(_zero_bytes) : bytes_remaining;
+				memset(dst8, 0, count);
+				_zero_bytes -= count;
+			} else {
+				// Start the next pair
+				if (! ReadVarint(_literal_bytes)) break;
+				_zero_count_pending = true;
+				continue;
+			}
+
+			dst8 += count;
+			bytes_remaining -= count;
+		}
+
+		return bytes - bytes_remaining;
+	}
+
+}}
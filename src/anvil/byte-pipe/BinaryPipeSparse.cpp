@@ -0,0 +1,209 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/byte-pipe/BytePipeSparse.hpp"
+
+#if ANVIL_BYTEPIPE_AVX2
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static inline uint32_t CountTrailingZeros32(const uint32_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, bits);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(bits));
+#endif
+		}
+
+		static inline void CheckElementBytes(const uint32_t element_bytes) {
+			if (! (element_bytes == 1u || element_bytes == 2u || element_bytes == 4u || element_bytes == 8u)) throw std::runtime_error("Sparse arrays only support values of 1, 2, 4 or 8 bytes");
+		}
+
+#if ANVIL_BYTEPIPE_AVX2
+		// Returns a mask with one bit per byte of a 32 byte block, bits are set for each byte of a value that is zero
+		static inline uint32_t ZeroByteMask(const void* src, const uint32_t element_bytes) {
+			const __m256i values = _mm256_loadu_si256(static_cast<const __m256i*>(src));
+			const __m256i zero = _mm256_setzero_si256();
+			__m256i cmp;
+			switch (element_bytes) {
+			case 1u:
+				cmp = _mm256_cmpeq_epi8(values, zero);
+				break;
+			case 2u:
+				cmp = _mm256_cmpeq_epi16(values, zero);
+				break;
+			case 4u:
+				cmp = _mm256_cmpeq_epi32(values, zero);
+				break;
+			default:
+				cmp = _mm256_cmpeq_epi64(values, zero);
+				break;
+			}
+			return static_cast<uint32_t>(_mm256_movemask_epi8(cmp));
+		}
+#endif
+
+		template<class T>
+		static uint32_t CountNonZeroValues(const T* src, const uint32_t begin, const uint32_t size) {
+			uint32_t count = 0u;
+			for (uint32_t i = begin; i < size; ++i) if (src[i] != 0u) ++count;
+			return count;
+		}
+
+		template<class T>
+		static uint32_t GatherNonZeroValues(const T* src, const uint32_t begin, const uint32_t size, uint32_t* indices, T* values) {
+			uint32_t count = 0u;
+			for (uint32_t i = begin; i < size; ++i) {
+				if (src[i] != 0u) {
+					indices[count] = i;
+					values[count] = src[i];
+					++count;
+				}
+			}
+			return count;
+		}
+
+		template<class T>
+		static void ScatterSparseValues(const uint32_t* indices, const T* values, const uint32_t count, T* dst) {
+			for (uint32_t i = 0u; i < count; ++i) dst[indices[i]] = values[i];
+		}
+	}
+
+	uint32_t CountNonZeroValues(const void* src, const uint32_t element_bytes, const uint32_t size) {
+		detail::CheckElementBytes(element_bytes);
+		uint32_t count = 0u;
+		uint32_t i = 0u;
+
+#if ANVIL_BYTEPIPE_AVX2
+		// Count the zero values in each 32 byte block, every byte of a zero value sets a bit in the mask
+		const uint32_t values_per_block = 32u / element_bytes;
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+		for (; i + values_per_block <= size; i += values_per_block) {
+			const uint32_t zeros = static_cast<uint32_t>(_mm_popcnt_u32(detail::ZeroByteMask(src8 + static_cast<size_t>(i) * element_bytes, element_bytes))) / element_bytes;
+			count += values_per_block - zeros;
+		}
+#endif
+
+		switch (element_bytes) {
+		case 1u:
+			return count + detail::CountNonZeroValues(static_cast<const uint8_t*>(src), i, size);
+		case 2u:
+			return count + detail::CountNonZeroValues(static_cast<const uint16_t*>(src), i, size);
+		case 4u:
+			return count + detail::CountNonZeroValues(static_cast<const uint32_t*>(src), i, size);
+		default:
+			return count + detail::CountNonZeroValues(static_cast<const uint64_t*>(src), i, size);
+		}
+	}
+
+	uint32_t GatherNonZeroValues(const void* src, const uint32_t element_bytes, const uint32_t size, uint32_t* indices, void* values) {
+		detail::CheckElementBytes(element_bytes);
+		uint32_t count = 0u;
+		uint32_t i = 0u;
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+		uint8_t* const values8 = static_cast<uint8_t*>(values);
+
+#if ANVIL_BYTEPIPE_AVX2
+		// Blocks of zeros are skipped with one comparison, the values in other blocks are found from the mask
+		const uint32_t values_per_block = 32u / element_bytes;
+		const uint32_t value_mask = (1u << element_bytes) - 1u;
+		for (; i + values_per_block <= size; i += values_per_block) {
+			const uint8_t* const block = src8 + static_cast<size_t>(i) * element_bytes;
+			uint32_t non_zero = ~detail::ZeroByteMask(block, element_bytes);
+			while (non_zero != 0u) {
+				const uint32_t value = detail::CountTrailingZeros32(non_zero) / element_bytes;
+				non_zero &= ~(value_mask << (value * element_bytes));
+				indices[count] = i + value;
+				memcpy(values8 + static_cast<size_t>(count) * element_bytes, block + value * element_bytes, element_bytes);
+				++count;
+			}
+		}
+#endif
+
+		switch (element_bytes) {
+		case 1u:
+			return count + detail::GatherNonZeroValues(reinterpret_cast<const uint8_t*>(src8), i, size, indices + count, reinterpret_cast<uint8_t*>(values8) + count);
+		case 2u:
+			return count + detail::GatherNonZeroValues(reinterpret_cast<const uint16_t*>(src8), i, size, indices + count, reinterpret_cast<uint16_t*>(values8) + count);
+		case 4u:
+			return count + detail::GatherNonZeroValues(reinterpret_cast<const uint32_t*>(src8), i, size, indices + count, reinterpret_cast<uint32_t*>(values8) + count);
+		default:
+			return count + detail::GatherNonZeroValues(reinterpret_cast<const uint64_t*>(src8), i, size, indices + count, reinterpret_cast<uint64_t*>(values8) + count);
+		}
+	}
+
+	void ScatterSparseValues(const uint32_t* indices, const void* values, const uint32_t element_bytes, const uint32_t count, void* dst, const uint32_t size) {
+		detail::CheckElementBytes(element_bytes);
+
+		// memset is vectorised by the standard library, so the dense array is cleared at full memory bandwidth
+		memset(dst, 0, static_cast<size_t>(size) * element_bytes);
+
+		switch (element_bytes) {
+		case 1u:
+			detail::ScatterSparseValues(indices, static_cast<const uint8_t*>(values), count, static_cast<uint8_t*>(dst));
+			break;
+		case 2u:
+			detail::ScatterSparseValues(indices, static_cast<const uint16_t*>(values), count, static_cast<uint16_t*>(dst));
+			break;
+		case 4u:
+			detail::ScatterSparseValues(indices, static_cast<const uint32_t*>(values), count, static_cast<uint32_t*>(dst));
+			break;
+		default:
+			detail::ScatterSparseValues(indices, static_cast<const uint64_t*>(values), count, static_cast<uint64_t*>(dst));
+			break;
+		}
+	}
+
+	void IndicesToBitmap(const uint32_t* indices, const uint32_t count, uint8_t* bitmap, const uint32_t size) {
+		memset(bitmap, 0, (static_cast<size_t>(size) + 7u) / 8u);
+		for (uint32_t i = 0u; i < count; ++i) bitmap[indices[i] / 8u] |= static_cast<uint8_t>(1u << (indices[i] % 8u));
+	}
+
+	uint32_t BitmapToIndices(const uint8_t* bitmap, const uint32_t size, uint32_t* indices, const uint32_t max_count) {
+		const uint32_t bytes = static_cast<uint32_t>((static_cast<size_t>(size) + 7u) / 8u);
+		uint32_t count = 0u;
+		uint32_t i = 0u;
+
+		// Skip 8 bytes at a time while the bitmap is empty
+		for (; i < bytes; ++i) {
+			if (i % 8u == 0u && i + 8u <= bytes) {
+				uint64_t word;
+				memcpy(&word, bitmap + i, sizeof(word));
+				if (word == 0u) {
+					i += 7u;
+					continue;
+				}
+			}
+
+			uint32_t bits = bitmap[i];
+			if (i == bytes - 1u && size % 8u != 0u) bits &= (1u << (size % 8u)) - 1u;
+			while (bits != 0u) {
+				if (count < max_count) indices[count] = i * 8u + detail::CountTrailingZeros32(bits);
+				++count;
+				bits &= bits - 1u;
+			}
+		}
+
+		return count;
+	}
+
+}}
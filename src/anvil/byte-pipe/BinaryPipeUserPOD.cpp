@@ -0,0 +1,183 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include "anvil/byte-pipe/BytePipeUserPOD.hpp"
+#include "anvil/byte-pipe/BytePipeEndian.hpp"
+
+#if ANVIL_BYTEPIPE_SSSE3
+	#include <immintrin.h>
+#endif
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+		enum : uint32_t {
+			MAX_SHUFFLE_PHASES = 256u	//!< The largest number of 16 byte shuffle masks that a layout can use
+		};
+
+		struct UserPODField {
+			uint32_t offset;
+			uint32_t width;
+		};
+
+		struct UserPODLayout {
+			std::vector<uint8_t> field_widths;		//!< The widths that were registered
+			std::vector<UserPODField> swap_fields;	//!< The fields that are wider than 1 byte
+			std::vector<uint8_t> shuffle_masks;		//!< SSSE3 masks for each 16 byte block in the repeating pattern of an array, empty if they cannot be used
+			uint32_t bytes;
+		};
+
+		struct UserPODRegistry {
+			std::mutex lock;
+			std::map<uint32_t, UserPODLayout> layouts;
+		};
+
+		static UserPODRegistry& GetUserPODRegistry() {
+			static UserPODRegistry g_registry;
+			return g_registry;
+		}
+
+		static const UserPODLayout* FindUserPODLayout(const uint32_t type) {
+			UserPODRegistry& registry = GetUserPODRegistry();
+			std::lock_guard<std::mutex> lock(registry.lock);
+			const auto i = registry.layouts.find(type);
+			// Layouts are never removed, so the pointer stays valid after the lock is released
+			return i == registry.layouts.end() ? nullptr : &i->second;
+		}
+
+		static inline void SwapField(uint8_t* field, const uint32_t width) {
+			switch (width) {
+			case 2u:
+				{
+					uint16_t tmp;
+					memcpy(&tmp, field, sizeof(tmp));
+					tmp = SwapByteOrder(tmp);
+					memcpy(field, &tmp, sizeof(tmp));
+				}
+				break;
+			case 4u:
+				{
+					uint32_t tmp;
+					memcpy(&tmp, field, sizeof(tmp));
+					tmp = SwapByteOrder(tmp);
+					memcpy(field, &tmp, sizeof(tmp));
+				}
+				break;
+			case 8u:
+				{
+					uint64_t tmp;
+					memcpy(&tmp, field, sizeof(tmp));
+					tmp = SwapByteOrder(tmp);
+					memcpy(field, &tmp, sizeof(tmp));
+				}
+				break;
+			}
+		}
+
+		static void BuildShuffleMasks(UserPODLayout& layout, const bool aligned) {
+			// A field can only be swapped inside a 16 byte block if it doesn't cross the edge of the block,
+			// which is true when every field is aligned to its own width
+			if (! aligned || layout.swap_fields.empty()) return;
+
+			// The pattern of an array repeats every lcm(bytes, 16) bytes
+			const uint32_t phases = layout.bytes / std::gcd(layout.bytes, 16u);
+			if (phases > MAX_SHUFFLE_PHASES) return;
+
+			// The byte that is moved to each position in the POD
+			std::vector<uint32_t> source(layout.bytes);
+			for (uint32_t i = 0u; i < layout.bytes; ++i) source[i] = i;
+			for (const UserPODField& field : layout.swap_fields) {
+				for (uint32_t i = 0u; i < field.width; ++i) source[field.offset + i] = field.offset + field.width - 1u - i;
+			}
+
+			layout.shuffle_masks.resize(phases * 16u);
+			for (uint32_t i = 0u; i < phases * 16u; ++i) {
+				const uint32_t pod_offset = i % layout.bytes;
+				layout.shuffle_masks[i] = static_cast<uint8_t>((i % 16u) + source[pod_offset] - pod_offset);
+			}
+		}
+	}
+
+	void RegisterUserPOD(const uint32_t type, const uint32_t bytes, const uint8_t* field_widths, const uint32_t field_count) {
+		detail::UserPODLayout layout;
+		layout.bytes = bytes;
+		layout.field_widths.assign(field_widths, field_widths + field_count);
+
+		uint32_t offset = 0u;
+		bool aligned = true;
+		for (uint32_t i = 0u; i < field_count; ++i) {
+			const uint32_t width = field_widths[i];
+			if (! (width == 1u || width == 2u || width == 4u || width == 8u)) throw std::runtime_error("RegisterUserPOD : Field width must be 1, 2, 4 or 8 bytes");
+			if (width > 1u) {
+				layout.swap_fields.push_back({ offset, width });
+				if (offset % width != 0u || bytes % width != 0u) aligned = false;
+			}
+			offset += width;
+		}
+		if (offset != bytes) throw std::runtime_error("RegisterUserPOD : Field widths do not add up to the size of the POD");
+
+		detail::BuildShuffleMasks(layout, aligned);
+
+		detail::UserPODRegistry& registry = detail::GetUserPODRegistry();
+		std::lock_guard<std::mutex> lock(registry.lock);
+		const auto i = registry.layouts.find(type);
+		if (i == registry.layouts.end()) {
+			registry.layouts.emplace(type, std::move(layout));
+		} else if (i->second.bytes != bytes || i->second.field_widths != layout.field_widths) {
+			throw std::runtime_error("RegisterUserPOD : POD type is already registered with a different layout");
+		}
+	}
+
+	bool SwapUserPODByteOrder(const uint32_t type, const void* src, void* dst, const uint32_t bytes, const uint32_t count) {
+		const detail::UserPODLayout* const layout = detail::FindUserPODLayout(type);
+		if (layout == nullptr) return false;
+		if (layout->bytes != bytes) throw std::runtime_error("SwapUserPODByteOrder : POD size does not match the registered layout");
+
+		const uint8_t* const src8 = static_cast<const uint8_t*>(src);
+		uint8_t* const dst8 = static_cast<uint8_t*>(dst);
+		const size_t total = static_cast<size_t>(bytes) * count;
+		size_t done = 0u;
+
+#if ANVIL_BYTEPIPE_SSSE3
+		// Shuffle whole repetitions of the pattern, 16 bytes at a time
+		if (! layout->shuffle_masks.empty()) {
+			const uint8_t* const masks = layout->shuffle_masks.data();
+			const size_t period = layout->shuffle_masks.size();
+			const size_t end = (total / period) * period;
+			for (; done < end; done += period) {
+				for (size_t i = 0u; i < period; i += 16u) {
+					const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i));
+					const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src8 + done + i));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(dst8 + done + i), _mm_shuffle_epi8(values, mask));
+				}
+			}
+		}
+#endif
+
+		// Swap the remaining PODs one field at a time
+		if (src8 != dst8) memcpy(dst8 + done, src8 + done, total - done);
+		for (; done < total; done += bytes) {
+			for (const detail::UserPODField& field : layout->swap_fields) detail::SwapField(dst8 + done + field.offset, field.width);
+		}
+
+		return true;
+	}
+
+}}
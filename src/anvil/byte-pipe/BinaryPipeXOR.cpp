@@ -0,0 +1,261 @@
+//Copyright 2021 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include <stdexcept>
+#include "anvil/byte-pipe/BytePipeXOR.hpp"
+
+namespace anvil { namespace BytePipe {
+
+	namespace detail {
+
+		static inline uint32_t CountLeadingZeros(const uint32_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse(&index, bits);
+			return 31u - static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_clz(bits));
+#endif
+		}
+
+		static inline uint32_t CountLeadingZeros(const uint64_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanReverse64(&index, bits);
+			return 63u - static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_clzll(bits));
+#endif
+		}
+
+		static inline uint32_t CountTrailingZeros(const uint32_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward(&index, bits);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(bits));
+#endif
+		}
+
+		static inline uint32_t CountTrailingZeros(const uint64_t bits) {
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, bits);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+		}
+
+		// Bits are added to a 64-bit buffer from the most significant bit, the buffer is written when it is full
+		class BitWriter64 {
+		private:
+			uint64_t* _out;
+			uint64_t _buffer;
+			uint32_t _used;
+		public:
+			BitWriter64(uint64_t* out) :
+				_out(out),
+				_buffer(0u),
+				_used(0u)
+			{}
+
+			// count must be between 1 and 64, bits above count must be zero
+			inline void Write(const uint64_t bits, const uint32_t count) {
+				const uint32_t space = 64u - _used;
+				if (count < space) {
+					_buffer |= bits << (space - count);
+					_used += count;
+				} else {
+					const uint32_t remaining = count - space;
+					_buffer |= bits >> remaining;
+					*_out = _buffer;
+					++_out;
+					_buffer = remaining == 0u ? 0u : bits << (64u - remaining);
+					_used = remaining;
+				}
+			}
+
+			inline uint64_t* Flush() {
+				if (_used > 0u) {
+					*_out = _buffer;
+					++_out;
+					_buffer = 0u;
+					_used = 0u;
+				}
+				return _out;
+			}
+		};
+
+		class BitReader64 {
+		private:
+			const uint8_t* _in;
+			const uint8_t* const _end;
+			uint64_t _buffer;
+			uint32_t _available;
+
+			inline uint64_t NextWord() {
+				if (_in == _end) throw std::runtime_error("XOR compressed array is shorter than its size");
+				uint64_t word;
+				memcpy(&word, _in, sizeof(word));
+				_in += sizeof(word);
+				return word;
+			}
+		public:
+			BitReader64(const void* in, const uint32_t words) :
+				_in(static_cast<const uint8_t*>(in)),
+				_end(static_cast<const uint8_t*>(in) + static_cast<size_t>(words) * sizeof(uint64_t)),
+				_buffer(0u),
+				_available(0u)
+			{}
+
+			// count must be between 1 and 64
+			inline uint64_t Read(const uint32_t count) {
+				uint64_t value;
+				if (count <= _available) {
+					value = _buffer >> (64u - count);
+					_buffer = count == 64u ? 0u : _buffer << count;
+					_available -= count;
+				} else {
+					const uint32_t remaining = count - _available;
+					value = _available == 0u ? 0u : _buffer >> (64u - _available);
+					_buffer = NextWord();
+					value = (remaining == 64u ? 0u : value << remaining) | (_buffer >> (64u - remaining));
+					_buffer = remaining == 64u ? 0u : _buffer << remaining;
+					_available = 64u - remaining;
+				}
+				return value;
+			}
+
+			inline bool IsFinished() const {
+				return _in == _end;
+			}
+		};
+
+		static uint32_t GetElementBytes(const Type type) {
+			switch (type) {
+			case TYPE_F32:
+				return 4u;
+			case TYPE_F64:
+				return 8u;
+			default:
+				throw std::runtime_error("XOR compressed arrays only support 32 and 64-bit floating point values");
+			}
+		}
+
+		// T is an unsigned integer of the same size as the floating point type
+		template<class T>
+		static uint64_t XORCompressFloats(const T* src, const uint32_t size, uint64_t* dst) {
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			ANVIL_CONSTEXPR const uint32_t field_bits = sizeof(T) == 4u ? 5u : 6u;
+			if (size == 0u) return 0u;
+
+			BitWriter64 writer(dst);
+			writer.Write(src[0u], bits);
+
+			// The first window is empty so that the first value which changes defines a new window
+			T previous = src[0u];
+			uint32_t leading = bits;
+			uint32_t trailing = 0u;
+			for (uint32_t i = 1u; i < size; ++i) {
+				const T value = src[i];
+				const T x = value ^ previous;
+				previous = value;
+				if (x == 0u) {
+					writer.Write(0u, 1u);
+					continue;
+				}
+
+				const uint32_t new_leading = CountLeadingZeros(x);
+				const uint32_t new_trailing = CountTrailingZeros(x);
+				if (new_leading >= leading && new_trailing >= trailing) {
+					// Reuse the previous window
+					writer.Write(2u, 2u);
+					writer.Write(x >> trailing, bits - leading - trailing);
+				} else {
+					leading = new_leading;
+					trailing = new_trailing;
+					const uint32_t meaningful_bits = bits - leading - trailing;
+					writer.Write(3u, 2u);
+					writer.Write(leading, field_bits);
+					writer.Write(meaningful_bits - 1u, field_bits);
+					writer.Write(x >> trailing, meaningful_bits);
+				}
+			}
+
+			return static_cast<uint64_t>(writer.Flush() - dst);
+		}
+
+		template<class T>
+		static void XORDecompressFloats(const void* src, const uint32_t words, const uint32_t size, T* dst) {
+			ANVIL_CONSTEXPR const uint32_t bits = sizeof(T) * 8u;
+			ANVIL_CONSTEXPR const uint32_t field_bits = sizeof(T) == 4u ? 5u : 6u;
+
+			BitReader64 reader(src, words);
+			if (size > 0u) {
+				T previous = static_cast<T>(reader.Read(bits));
+				dst[0u] = previous;
+
+				uint32_t leading = bits;
+				uint32_t trailing = 0u;
+				for (uint32_t i = 1u; i < size; ++i) {
+					if (reader.Read(1u) != 0u) {
+						if (reader.Read(1u) != 0u) {
+							leading = static_cast<uint32_t>(reader.Read(field_bits));
+							const uint32_t meaningful_bits = static_cast<uint32_t>(reader.Read(field_bits)) + 1u;
+							if (leading + meaningful_bits > bits) throw std::runtime_error("XOR compressed array contains a window that is too wide");
+							trailing = bits - leading - meaningful_bits;
+						} else if (leading == bits) {
+							throw std::runtime_error("XOR compressed array uses a window before defining one");
+						}
+						previous ^= static_cast<T>(reader.Read(bits - leading - trailing) << trailing);
+					}
+					dst[i] = previous;
+				}
+			}
+
+			// The writer only adds bits to fill the last word
+			if (! reader.IsFinished()) throw std::runtime_error("XOR compressed array is longer than its size");
+		}
+	}
+
+	uint64_t GetMaxXORCompressedWords(const Type type, const uint32_t size) {
+		const uint64_t value_bits = detail::GetElementBytes(type) * 8u;
+		const uint64_t field_bits = value_bits == 32u ? 5u : 6u;
+		if (size == 0u) return 0u;
+
+		// The first value is written unchanged, the worst case for the others is a new window that uses every bit
+		const uint64_t bits = value_bits + (static_cast<uint64_t>(size) - 1u) * (2u + field_bits * 2u + value_bits);
+		return (bits + 63u) / 64u;
+	}
+
+	uint64_t XORCompressFloats(const void* src, const Type type, const uint32_t size, uint64_t* dst) {
+		if (detail::GetElementBytes(type) == 4u) {
+			return detail::XORCompressFloats<uint32_t>(static_cast<const uint32_t*>(src), size, dst);
+		} else {
+			return detail::XORCompressFloats<uint64_t>(static_cast<const uint64_t*>(src), size, dst);
+		}
+	}
+
+	void XORDecompressFloats(const void* src, const uint32_t words, const Type type, const uint32_t size, void* dst) {
+		if (detail::GetElementBytes(type) == 4u) {
+			detail::XORDecompressFloats<uint32_t>(src, words, size, static_cast<uint32_t*>(dst));
+		} else {
+			detail::XORDecompressFloats<uint64_t>(src, words, size, static_cast<uint64_t*>(dst));
+		}
+	}
+
+}}
@@ -12,8 +12,14 @@
 //See the License for the specific language governing permissions and
 //limitations under the License.
 
+#include <atomic>
+#include <cstring>
 #include "anvil/byte-pipe/BytePipeObjects.hpp"
 
+#if ANVIL_BYTEPIPE_F16C
+	#include <immintrin.h>
+#endif
+
 namespace anvil { namespace BytePipe {
 
 	static ANVIL_CONSTEXPR const uint8_t g_type_sizes[] = {
@@ -52,6 +58,152 @@ namespace anvil { namespace BytePipe {
 		return value;
 	}
 
+	// 16-bit floating point
+
+	namespace detail {
+		// Lookup tables for converting 16-bit floating point to 32-bit
+		// The float bits are mantissa[offset[h >> 10] + (h & 1023)] + exponent[h >> 10]
+		struct HalfTables {
+			uint32_t mantissa[2048u];
+			uint32_t exponent[64u];
+			uint16_t offset[64u];
+
+			HalfTables() {
+				// Subnormal halfs are normalised
+				mantissa[0u] = 0u;
+				for (uint32_t i = 1u; i < 1024u; ++i) {
+					uint32_t m = i << 13u;
+					uint32_t e = 0u;
+					while ((m & 0x00800000u) == 0u) {
+						e -= 0x00800000u;
+						m <<= 1u;
+					}
+					m &= ~0x00800000u;
+					e += 0x38800000u;
+					mantissa[i] = m | e;
+				}
+				for (uint32_t i = 1024u; i < 2048u; ++i) mantissa[i] = 0x38000000u + ((i - 1024u) << 13u);
+
+				// Infinity and NaN have the maximum exponent
+				exponent[0u] = 0u;
+				for (uint32_t i = 1u; i < 31u; ++i) exponent[i] = i << 23u;
+				exponent[31u] = 0x47800000u;
+				exponent[32u] = 0x80000000u;
+				for (uint32_t i = 33u; i < 63u; ++i) exponent[i] = 0x80000000u + ((i - 32u) << 23u);
+				exponent[63u] = 0xC7800000u;
+
+				for (uint32_t i = 0u; i < 64u; ++i) offset[i] = 1024u;
+				offset[0u] = 0u;
+				offset[32u] = 0u;
+			}
+		};
+
+		static const HalfTables& GetHalfTables() {
+			// Constructed on first use so that conversions work during static initialisation
+			static const HalfTables tables;
+			return tables;
+		}
+
+		static inline float BitsToFloat(const uint32_t bits) {
+			float value;
+			memcpy(&value, &bits, sizeof(float));
+			return value;
+		}
+
+		static inline uint32_t FloatToBits(const float value) {
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(float));
+			return bits;
+		}
+
+		// Round the low bits of a value to the nearest even
+		template<class T>
+		static inline T RoundShift(const T value, const uint32_t shift) {
+			const T result = value >> shift;
+			const T remainder = value & ((static_cast<T>(1u) << shift) - 1u);
+			const T halfway = static_cast<T>(1u) << (shift - 1u);
+			return remainder > halfway || (remainder == halfway && (result & 1u) != 0u) ? result + 1u : result;
+		}
+	}
+
+	float HalfToFloat(const half value) {
+		const uint32_t h = static_cast<uint32_t>(value);
+		const detail::HalfTables& t = detail::GetHalfTables();
+		uint32_t bits = t.mantissa[t.offset[h >> 10u] + (h & 1023u)] + t.exponent[h >> 10u];
+
+		// Make NaNs quiet, the same as F16C
+		if ((h & 0x7C00u) == 0x7C00u && (h & 0x03FFu) != 0u) bits |= 0x00400000u;
+
+		return detail::BitsToFloat(bits);
+	}
+
+	half FloatToHalf(const float value) {
+		const uint32_t bits = detail::FloatToBits(value);
+		const uint32_t sign = (bits >> 16u) & 0x8000u;
+		const uint32_t abs = bits & 0x7FFFFFFFu;
+
+		// Infinity and NaN, NaNs are made quiet but keep the top of their payload
+		if (abs >= 0x7F800000u) return static_cast<half>(sign | 0x7C00u | (abs > 0x7F800000u ? 0x0200u | ((abs >> 13u) & 0x03FFu) : 0u));
+
+		// 65520 and above round to infinity
+		if (abs >= 0x477FF000u) return static_cast<half>(sign | 0x7C00u);
+
+		// Normal values, rounding can carry into the exponent
+		if (abs >= 0x38800000u) return static_cast<half>(sign | detail::RoundShift<uint32_t>(abs - 0x38000000u, 13u));
+
+		// Values that round to 0
+		if (abs <= 0x33000000u) return static_cast<half>(sign);
+
+		// Subnormal values
+		const uint32_t exponent = abs >> 23u;
+		const uint32_t mantissa = (abs & 0x007FFFFFu) | 0x00800000u;
+		return static_cast<half>(sign | detail::RoundShift<uint32_t>(mantissa, 126u - exponent));
+	}
+
+	half DoubleToHalf(const double value) {
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(double));
+		const uint32_t sign = static_cast<uint32_t>(bits >> 48u) & 0x8000u;
+		const uint64_t abs = bits & 0x7FFFFFFFFFFFFFFFull;
+
+		// Infinity and NaN, NaNs are made quiet but keep the top of their payload
+		if (abs >= 0x7FF0000000000000ull) return static_cast<half>(sign | 0x7C00u | (abs > 0x7FF0000000000000ull ? 0x0200u | static_cast<uint32_t>((abs >> 42u) & 0x03FFu) : 0u));
+
+		// 65520 and above round to infinity
+		if (abs >= 0x40EFFE0000000000ull) return static_cast<half>(sign | 0x7C00u);
+
+		// Normal values, rounding can carry into the exponent
+		if (abs >= 0x3F10000000000000ull) return static_cast<half>(sign | static_cast<uint32_t>(detail::RoundShift<uint64_t>(abs - 0x3F00000000000000ull, 42u)));
+
+		// Values that round to 0
+		if (abs <= 0x3E60000000000000ull) return static_cast<half>(sign);
+
+		// Subnormal values
+		const uint32_t exponent = static_cast<uint32_t>(abs >> 52u);
+		const uint64_t mantissa = (abs & 0x000FFFFFFFFFFFFFull) | 0x0010000000000000ull;
+		return static_cast<half>(sign | static_cast<uint32_t>(detail::RoundShift<uint64_t>(mantissa, 1051u - exponent)));
+	}
+
+	void HalfToFloat(const half* src, float* dst, const size_t count) {
+		size_t i = 0u;
+#if ANVIL_BYTEPIPE_F16C
+		for (; i + 8u <= count; i += 8u) {
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+		}
+#endif
+		for (; i < count; ++i) dst[i] = HalfToFloat(src[i]);
+	}
+
+	void FloatToHalf(const float* src, half* dst, const size_t count) {
+		size_t i = 0u;
+#if ANVIL_BYTEPIPE_F16C
+		for (; i + 8u <= count; i += 8u) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+#endif
+		for (; i < count; ++i) dst[i] = FloatToHalf(src[i]);
+	}
+
 	// PrimativeValue
 
 	bool PrimativeValue::operator==(const PrimativeValue& other) const {
@@ -215,15 +367,18 @@ namespace anvil { namespace BytePipe {
 	PrimativeValue::operator half() const {
 		if (type == TYPE_F16) {
 			return f16;
+		} else if (type == TYPE_F32) {
+			return FloatToHalf(f32);
 		} else {
-			//! \bug f16 conversion is not implented
-			throw std::runtime_error("PrimativeValue::operator half : 16-bit floating point is not implemented");
+			return DoubleToHalf(operator double());
 		}
 	}
 
 	PrimativeValue::operator float() const {
 		if (type == TYPE_F32) {
 			return f32;
+		} else if (type == TYPE_F16) {
+			return HalfToFloat(f16);
 		} else {
 			return static_cast<float>(operator double());
 		}
@@ -253,7 +408,7 @@ namespace anvil { namespace BytePipe {
 		case TYPE_S64:
 			return static_cast<double>(s64);
 		case TYPE_F16:
-			return static_cast<double>(f16);
+			return static_cast<double>(HalfToFloat(f16));
 		case TYPE_F32:
 			return static_cast<double>(f32);
 		case TYPE_F64:
@@ -340,6 +495,180 @@ FLOATING_POINT:
 
 #define IS_PRIMATIVE_TYPE(type) (type < TYPE_STRING || type == TYPE_BOOL)
 
+	// Sizes of the binary format, these must match ValueHeader in BinaryPipe.cpp
+	enum : size_t {
+		ENCODED_ID_BYTES = 1u,
+		ENCODED_LENGTH_BYTES = 4u,
+		ENCODED_COMPONENT_ID_BYTES = sizeof(ComponentID)
+	};
+
+	namespace detail {
+		/*!
+			\brief Reference counted storage for strings, arrays and objects.
+			\details Uses the same layout as lutils::detail::FastSharedPtrData, but is owned through the
+			pointer in PrimativeValue so that Value does not grow in size.
+		*/
+		template<class T>
+		struct SharedValueData {
+			T object;
+			std::atomic_uint32_t reference_counter;
+
+			//! Cached encoded size in the upper 56 bits and array element type in the lower 8 bits, 0 if not calculated
+			std::atomic_uint64_t encoded_cache;
+
+			//! Set when a mutable reference to a child has been returned, the child can then change without the cache being updated
+			std::atomic_bool children_exposed;
+
+			SharedValueData(std::pmr::memory_resource* resource) :
+				object(resource),
+				reference_counter(1u),
+				encoded_cache(0u),
+				children_exposed(false)
+			{}
+
+			SharedValueData(const SharedValueData<T>& other) :
+				object(other.object, other.object.get_allocator()),
+				reference_counter(1u),
+				encoded_cache(other.children_exposed ? 0u : other.encoded_cache.load(std::memory_order_relaxed)),
+				children_exposed(false)
+			{}
+		};
+
+		static inline std::pmr::memory_resource* GetResource(std::pmr::memory_resource* resource) {
+			return resource == nullptr ? std::pmr::get_default_resource() : resource;
+		}
+
+		template<class T>
+		static inline SharedValueData<T>& GetSharedData(void* ptr) {
+			return *static_cast<SharedValueData<T>*>(ptr);
+		}
+
+		static inline uint64_t PackEncodedCache(const size_t bytes, const Type element_type) {
+			return (static_cast<uint64_t>(bytes) << 8ull) | static_cast<uint64_t>(element_type);
+		}
+
+		static inline size_t UnpackEncodedSize(const uint64_t cache) {
+			return static_cast<size_t>(cache >> 8ull);
+		}
+
+		static inline Type UnpackElementType(const uint64_t cache) {
+			return static_cast<Type>(cache & 255ull);
+		}
+
+		//! Check if all of the values in an array have the same primative type, only the direct children are read
+		template<class T>
+		static Type FindElementType(const T& myArray) {
+			Type element_type = myArray.empty() ? TYPE_NULL : myArray[0u].GetType();
+			if (! IS_PRIMATIVE_TYPE(element_type)) return TYPE_NULL;
+			for (const auto& i : myArray) {
+				if (i.GetType() != element_type) return TYPE_NULL;
+			}
+			return element_type;
+		}
+
+		template<class T>
+		static uint64_t GetArrayCache(SharedValueData<T>& data) {
+			uint64_t cache = data.encoded_cache;
+			if (cache == 0u) {
+				const T& myArray = data.object;
+				size_t bytes = ENCODED_ID_BYTES + ENCODED_LENGTH_BYTES;
+				const Type element_type = FindElementType(myArray);
+
+				if (element_type == TYPE_NULL) {
+					for (const auto& i : myArray) bytes += i.EncodedSize();
+				} else {
+					bytes += myArray.size() * g_type_sizes[element_type];
+				}
+
+				// Multiple threads may calculate the cache at the same time, but they will agree on the result
+				cache = PackEncodedCache(bytes, element_type);
+				if (! data.children_exposed) data.encoded_cache = cache;
+			}
+			return cache;
+		}
+
+		template<class T>
+		static uint64_t GetObjectCache(SharedValueData<T>& data) {
+			uint64_t cache = data.encoded_cache;
+			if (cache == 0u) {
+				size_t bytes = ENCODED_ID_BYTES + ENCODED_LENGTH_BYTES;
+				for (const auto& i : data.object) bytes += ENCODED_COMPONENT_ID_BYTES + i.second.EncodedSize();
+				cache = PackEncodedCache(bytes, TYPE_NULL);
+				if (! data.children_exposed) data.encoded_cache = cache;
+			}
+			return cache;
+		}
+
+		template<class T>
+		static inline T& GetShared(void* ptr) {
+			return static_cast<SharedValueData<T>*>(ptr)->object;
+		}
+
+		template<class T, class ARG>
+		static inline SharedValueData<T>* NewShared(std::pmr::memory_resource* resource, ARG&& arg) {
+			// The data is allocated from the same resource as the object it contains
+			void* const mem = resource->allocate(sizeof(SharedValueData<T>), alignof(SharedValueData<T>));
+			try {
+				return new(mem) SharedValueData<T>(std::forward<ARG>(arg));
+			} catch (...) {
+				resource->deallocate(mem, sizeof(SharedValueData<T>), alignof(SharedValueData<T>));
+				throw;
+			}
+		}
+
+		template<class T>
+		static inline void* CreateShared(std::pmr::memory_resource* resource) {
+			resource = GetResource(resource);
+			return NewShared<T>(resource, resource);
+		}
+
+		template<class T>
+		static inline bool UsesResource(const void* ptr, std::pmr::memory_resource* resource) {
+			return *static_cast<const SharedValueData<T>*>(ptr)->object.get_allocator().resource() == *GetResource(resource);
+		}
+
+		template<class T>
+		static inline void RetainShared(void* ptr) {
+			++static_cast<SharedValueData<T>*>(ptr)->reference_counter;
+		}
+
+		template<class T>
+		static inline void ReleaseShared(void* ptr) {
+			SharedValueData<T>* data = static_cast<SharedValueData<T>*>(ptr);
+			if (--data->reference_counter == 0u) {
+				std::pmr::memory_resource* const resource = data->object.get_allocator().resource();
+				data->~SharedValueData<T>();
+				resource->deallocate(data, sizeof(SharedValueData<T>), alignof(SharedValueData<T>));
+			}
+		}
+
+		template<class T>
+		static inline bool IsShared(const void* ptr) {
+			return static_cast<const SharedValueData<T>*>(ptr)->reference_counter > 1u;
+		}
+
+		template<class T>
+		static inline void* MakeUnique(void* ptr) {
+			if (! IsShared<T>(ptr)) return ptr;
+
+			// Copy the data, child values will be shared with the original
+			const SharedValueData<T>& original = GetSharedData<T>(ptr);
+			SharedValueData<T>* copy = NewShared<T>(original.object.get_allocator().resource(), original);
+			ReleaseShared<T>(ptr);
+			return copy;
+		}
+
+		template<class T>
+		static inline void* ShareData(void* ptr) {
+			// References to the children may have escaped, writes through them must not be seen by the copy
+			const SharedValueData<T>& original = GetSharedData<T>(ptr);
+			if (original.children_exposed) return NewShared<T>(original.object.get_allocator().resource(), original);
+
+			RetainShared<T>(ptr);
+			return ptr;
+		}
+	}
+
 	// Value
 
 	Value::Value() {
@@ -370,32 +699,27 @@ FLOATING_POINT:
 	}
 
 	Value& Value::operator=(const Value& other) {
-		switch (other._primative.type) {
+		if (&other == this) return *this;
+
+		// Share the data of strings, arrays and objects
+		PrimativeValue primative = other._primative;
+		switch (primative.type) {
 		case TYPE_STRING:
-			SetString(static_cast<std::string*>(other._primative.ptr)->c_str());
+			detail::RetainShared<String>(primative.ptr);
 			break;
 		case TYPE_ARRAY:
-			{
-				SetArray();
-				Array& myArray = *static_cast<Array*>(_primative.ptr);
-				const Array& otherArray = *static_cast<Array*>(other._primative.ptr);
-				myArray = otherArray;
-			}
+			primative.ptr = detail::ShareData<Array>(primative.ptr);
 			break;
 		case TYPE_OBJECT:
-			{
-				SetObject();
-				Object& myObject = *static_cast<Object*>(_primative.ptr);
-				const Object& otherObject = *static_cast<Object*>(other._primative.ptr);
-				myObject = otherObject;
-			}
-		break;
+			primative.ptr = detail::ShareData<Object>(primative.ptr);
+			break;
 		default:
-			SetNull();
-			_primative = other._primative;
 			break;
 		}
 
+		SetNull();
+		_primative = primative;
+
 		return *this;
 	}
 
@@ -407,16 +731,45 @@ FLOATING_POINT:
 		return _primative.type;
 	}
 
+	bool Value::IsShared() const {
+		switch (_primative.type) {
+		case TYPE_STRING:
+			return detail::IsShared<String>(_primative.ptr);
+		case TYPE_ARRAY:
+			return detail::IsShared<Array>(_primative.ptr);
+		case TYPE_OBJECT:
+			return detail::IsShared<Object>(_primative.ptr);
+		default:
+			return false;
+		}
+	}
+
+	void Value::MakeUnique() {
+		switch (_primative.type) {
+		case TYPE_STRING:
+			_primative.ptr = detail::MakeUnique<String>(_primative.ptr);
+			break;
+		case TYPE_ARRAY:
+			_primative.ptr = detail::MakeUnique<Array>(_primative.ptr);
+			break;
+		case TYPE_OBJECT:
+			_primative.ptr = detail::MakeUnique<Object>(_primative.ptr);
+			break;
+		default:
+			break;
+		}
+	}
+
 	void Value::SetNull() {
 		switch (_primative.type) {
 		case TYPE_STRING:
-			delete static_cast<std::string*>(_primative.ptr);
+			detail::ReleaseShared<String>(_primative.ptr);
 			break;
 		case TYPE_ARRAY:
-			delete static_cast<Array*>(_primative.ptr);
+			detail::ReleaseShared<Array>(_primative.ptr);
 			break;
 		case TYPE_OBJECT:
-			delete static_cast<Object*>(_primative.ptr);
+			detail::ReleaseShared<Object>(_primative.ptr);
 			break;
 		}
 		_primative.u64 = 0u;
@@ -501,52 +854,103 @@ FLOATING_POINT:
 		_primative.type = TYPE_F64;
 	}
 
-	void Value::SetString(const char* value) {
-		if (_primative.type == TYPE_STRING) {
-			if (value == nullptr) {
-				static_cast<std::string*>(_primative.ptr)->clear();
-			} else {
-				*static_cast<std::string*>(_primative.ptr) = value;
-			}
+	void Value::SetString(const char* value, std::pmr::memory_resource* resource) {
+		SetString(value, value == nullptr ? 0u : strlen(value), resource);
+	}
+
+	void Value::SetString(const char* value, const size_t length, std::pmr::memory_resource* resource) {
+		if (_primative.type == TYPE_STRING && ! IsShared() && detail::UsesResource<String>(_primative.ptr, resource)) {
+			String& str = detail::GetShared<String>(_primative.ptr);
+			if (length == 0u) str.clear();
+			else str.assign(value, length);
 		} else {
-			SetNull();
-			if (value == nullptr) {
-				_primative.ptr = new std::string();
-			} else{
-				_primative.ptr = new std::string(value);
+			void* str = detail::CreateShared<String>(resource);
+			try {
+				if (length > 0u) detail::GetShared<String>(str).assign(value, length);
+			} catch (...) {
+				detail::ReleaseShared<String>(str);
+				throw;
 			}
+			SetNull();
+			_primative.ptr = str;
 			_primative.type = TYPE_STRING;
 		}
 	}
 
-	void Value::SetArray() {
-		if (_primative.type == TYPE_ARRAY) {
-			static_cast<Array*>(_primative.ptr)->clear();
+	void Value::SetArray(std::pmr::memory_resource* resource) {
+		if (_primative.type == TYPE_ARRAY && ! IsShared() && detail::UsesResource<Array>(_primative.ptr, resource)) {
+			detail::GetShared<Array>(_primative.ptr).clear();
 		} else {
 			SetNull();
-			_primative.ptr = new Array();
+			_primative.ptr = detail::CreateShared<Array>(resource);
 			_primative.type = TYPE_ARRAY;
 		}
+		// The old children have been removed, so the size can be cached again
+		detail::SharedValueData<Array>& data = detail::GetSharedData<Array>(_primative.ptr);
+		data.children_exposed = false;
+		data.encoded_cache = detail::PackEncodedCache(ENCODED_ID_BYTES + ENCODED_LENGTH_BYTES, TYPE_NULL);
 	}
 
 	void Value::AddValue(Value&& value) {
 		if (_primative.type != TYPE_ARRAY) throw std::runtime_error("Value::AddValue : Value is not an array");
-		static_cast<Array*>(_primative.ptr)->push_back(std::move(value));
+		MakeUnique();
+		detail::SharedValueData<Array>& data = detail::GetSharedData<Array>(_primative.ptr);
+
+		// Update the cached size
+		const uint64_t cache = data.encoded_cache;
+		if (cache != 0u) {
+			const size_t size = data.object.size();
+			const Type type = value.GetType();
+			Type element_type = detail::UnpackElementType(cache);
+			size_t bytes = detail::UnpackEncodedSize(cache);
+
+			if (size == 0u && type != TYPE_NULL && IS_PRIMATIVE_TYPE(type)) {
+				// Start a primative array, the values are written without headers
+				element_type = type;
+				bytes += g_type_sizes[type];
+			} else if (element_type != TYPE_NULL && element_type == type) {
+				bytes += g_type_sizes[type];
+			} else {
+				if (element_type != TYPE_NULL) {
+					// No longer a primative array, the previous values will need headers
+					bytes += size * ENCODED_ID_BYTES;
+					element_type = TYPE_NULL;
+				}
+				bytes += value.EncodedSize();
+			}
+
+			data.encoded_cache = detail::PackEncodedCache(bytes, element_type);
+		}
+
+		data.object.push_back(std::move(value));
 	}
 
-	void Value::SetObject() {
-		if (_primative.type == TYPE_OBJECT) {
-			static_cast<Object*>(_primative.ptr)->clear();
+	void Value::SetObject(std::pmr::memory_resource* resource) {
+		if (_primative.type == TYPE_OBJECT && ! IsShared() && detail::UsesResource<Object>(_primative.ptr, resource)) {
+			detail::GetShared<Object>(_primative.ptr).clear();
 		} else {
 			SetNull();
-			_primative.ptr = new Object();
+			_primative.ptr = detail::CreateShared<Object>(resource);
 			_primative.type = TYPE_OBJECT;
 		}
+		// The old children have been removed, so the size can be cached again
+		detail::SharedValueData<Object>& data = detail::GetSharedData<Object>(_primative.ptr);
+		data.children_exposed = false;
+		data.encoded_cache = detail::PackEncodedCache(ENCODED_ID_BYTES + ENCODED_LENGTH_BYTES, TYPE_NULL);
 	}
 
 	void Value::AddValue(const ComponentID id, Value&& value) {
 		if (_primative.type != TYPE_OBJECT) throw std::runtime_error("Value::AddValue : Value is not an object");
-		static_cast<Object*>(_primative.ptr)->emplace(id, std::move(value));
+		MakeUnique();
+		detail::SharedValueData<Object>& data = detail::GetSharedData<Object>(_primative.ptr);
+
+		const uint64_t cache = data.encoded_cache;
+		const size_t bytes = cache == 0u ? 0u : value.EncodedSize();
+
+		if (data.object.emplace(id, std::move(value)).second && cache != 0u) {
+			// Update the cached size
+			data.encoded_cache = detail::PackEncodedCache(detail::UnpackEncodedSize(cache) + ENCODED_COMPONENT_ID_BYTES + bytes, TYPE_NULL);
+		}
 	}
 
 	bool Value::GetBool() const {
@@ -626,20 +1030,40 @@ FLOATING_POINT:
 			}
 			SetString(buffer);
 		}
-		return static_cast<std::string*>(_primative.ptr)->c_str();
+		return detail::GetShared<String>(_primative.ptr).c_str();
+	}
+
+	const char* Value::GetString() const {
+		if (_primative.type != TYPE_STRING) throw std::runtime_error("Value::GetString : Value is not a string");
+		return detail::GetShared<String>(_primative.ptr).c_str();
 	}
 
 	Value& Value::GetValue(const uint32_t index) {
+		// The caller may modify the child at any time, so this value must own its data and can no longer cache its size
+		MakeUnique();
+		if (_primative.type == TYPE_ARRAY) {
+			detail::SharedValueData<Array>& data = detail::GetSharedData<Array>(_primative.ptr);
+			data.children_exposed = true;
+			data.encoded_cache = 0u;
+		} else if (_primative.type == TYPE_OBJECT) {
+			detail::SharedValueData<Object>& data = detail::GetSharedData<Object>(_primative.ptr);
+			data.children_exposed = true;
+			data.encoded_cache = 0u;
+		}
+		return const_cast<Value&>(static_cast<const Value*>(this)->GetValue(index));
+	}
+
+	const Value& Value::GetValue(const uint32_t index) const {
 		switch (_primative.type) {
 		case TYPE_ARRAY:
 			{
-				Array& myArray = *static_cast<Array*>(_primative.ptr);
+				const Array& myArray = detail::GetShared<Array>(_primative.ptr);
 				if (index >= myArray.size()) throw std::runtime_error("Value::GetValue : Index out of bounds");
 				return myArray[index];
 			}
 		case TYPE_OBJECT:
 			{
-				Object& myObject = *static_cast<Object*>(_primative.ptr);
+				const Object& myObject = detail::GetShared<Object>(_primative.ptr);
 				auto i = myObject.find(index);
 				if (i == myObject.end()) throw std::runtime_error("Value::GetValue : No member object with component ID");
 				return i->second;
@@ -654,13 +1078,10 @@ FLOATING_POINT:
 		switch (_primative.type) {
 		case TYPE_OBJECT:
 			{
-				Object& myObject = *static_cast<Object*>(_primative.ptr);
+				const Object& myObject = detail::GetShared<Object>(_primative.ptr);
 				if (index >= myObject.size()) throw std::runtime_error("Value::GetValue : Index out of bounds");
 				auto i = myObject.begin();
-				uint32_t j = index;
-				while (j != 0u) {
-					++i;
-				}
+				std::advance(i, index);
 				return i->first;
 			}
 			break;
@@ -669,6 +1090,16 @@ FLOATING_POINT:
 		}
 	}
 
+	Value::ComponentIterator Value::GetComponentsBegin() const {
+		if (_primative.type != TYPE_OBJECT) throw std::runtime_error("Value::GetComponentsBegin : Value is not an object");
+		return detail::GetShared<Object>(_primative.ptr).begin();
+	}
+
+	Value::ComponentIterator Value::GetComponentsEnd() const {
+		if (_primative.type != TYPE_OBJECT) throw std::runtime_error("Value::GetComponentsEnd : Value is not an object");
+		return detail::GetShared<Object>(_primative.ptr).end();
+	}
+
 	PrimativeValue Value::GetPrimativeValue() const {
 		switch (_primative.type) {
 		case TYPE_STRING:
@@ -682,16 +1113,41 @@ FLOATING_POINT:
 	}
 
 	size_t Value::GetSize() const {
-		return _primative.type == TYPE_ARRAY ? static_cast<Array*>(_primative.ptr)->size() :
-			_primative.type == TYPE_OBJECT ? static_cast<Object*>(_primative.ptr)->size() :
+		return _primative.type == TYPE_ARRAY ? detail::GetShared<Array>(_primative.ptr).size() :
+			_primative.type == TYPE_OBJECT ? detail::GetShared<Object>(_primative.ptr).size() :
+			_primative.type == TYPE_STRING ? detail::GetShared<String>(_primative.ptr).size() :
 			0u;
 	}
 
+	Type Value::GetArrayElementType() const {
+		if (_primative.type != TYPE_ARRAY) return TYPE_NULL;
+
+		// Finding the type doesn't need the size, so avoid calculating the sizes of the children when it isn't cached
+		const detail::SharedValueData<Array>& data = detail::GetSharedData<Array>(_primative.ptr);
+		const uint64_t cache = data.encoded_cache;
+		return cache == 0u ? detail::FindElementType(data.object) : detail::UnpackElementType(cache);
+	}
+
+	size_t Value::EncodedSize() const {
+		switch (_primative.type) {
+		case TYPE_STRING:
+			return ENCODED_ID_BYTES + ENCODED_LENGTH_BYTES + detail::GetShared<String>(_primative.ptr).size();
+		case TYPE_ARRAY:
+			return detail::UnpackEncodedSize(detail::GetArrayCache(detail::GetSharedData<Array>(_primative.ptr)));
+		case TYPE_OBJECT:
+			return detail::UnpackEncodedSize(detail::GetObjectCache(detail::GetSharedData<Object>(_primative.ptr)));
+		default:
+			return ENCODED_ID_BYTES + g_type_sizes[_primative.type];
+		}
+	}
+
 	void Value::Optimise() {
+		MakeUnique();
+
 		switch (_primative.type) {
 		case TYPE_STRING:
 			{
-				std::string& str = *static_cast<std::string*>(_primative.ptr);
+				const String& str = detail::GetShared<String>(_primative.ptr);
 				const size_t size = str.size();
 
 				// If the string is empty then it can be null value
@@ -707,8 +1163,9 @@ FLOATING_POINT:
 		case TYPE_ARRAY:
 			{
 				// Optimise the child values
-				Array& myArray = *static_cast<Array*>(_primative.ptr);
+				Array& myArray = detail::GetShared<Array>(_primative.ptr);
 				for (Value& i : myArray) i.Optimise();
+				detail::GetSharedData<Array>(_primative.ptr).encoded_cache = 0u;
 
 				//! \todo If all of the values are primatives try to make them the same type
 			}
@@ -716,8 +1173,9 @@ FLOATING_POINT:
 		case TYPE_OBJECT:
 			{
 			// Optimise the child values
-				Object& myObject = *static_cast<Object*>(_primative.ptr);
+				Object& myObject = detail::GetShared<Object>(_primative.ptr);
 				for (auto& i : myObject) i.second.Optimise();
+				detail::GetSharedData<Object>(_primative.ptr).encoded_cache = 0u;
 			}
 			break;
 		default: